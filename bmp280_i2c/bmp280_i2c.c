@@ -10,6 +10,7 @@
 #include "pico/binary_info.h"
 #include "pico/stdlib.h"
 #include "bmp280.h"
+#include "bmp280_altitude.h"
 
 int main() {
     stdio_init_all();
@@ -28,23 +29,57 @@ int main() {
     gpio_pull_up(2);
     gpio_pull_up(3);
 
-    // configure BMP280
-    bmp280_init();
+    // configure BMP280, the handle also caches its compensation params;
+    // a second sensor would just be another handle (e.g. ADDR_ALT or i2c1)
+    bmp280_t sensor;
+    if (!bmp280_init(&sensor, i2c_default, ADDR)) {
+        printf("BMP280 não responde no endereço 0x%02X\n", ADDR);
+    }
 
-    // retrieve fixed compensation params
-    struct bmp280_calib_param params;
-    bmp280_get_calib_params(&params);
+    // forced mode with the "handheld dynamic" oversampling: the sensor only
+    // converts when asked and sleeps between the 500ms polls
+    struct bmp280_config cfg;
+    bmp280_get_preset(BMP280_PRESET_HANDHELD_DYNAMIC, &cfg);
+    cfg.mode = BMP280_MODE_FORCED;
+    if (!bmp280_configure(&sensor, &cfg)) {
+        printf("Erro de I2C configurando o BMP280\n");
+    }
 
-    int32_t raw_temperature;
-    int32_t raw_pressao;
+    // altitude relative to standard sea level pressao and climb rate,
+    // updated incrementally with every sample
+    bmp280_altimeter_t altimeter;
+    bmp280_altimeter_init(&altimeter, BMP280_SEA_LEVEL_PA, BMP280_ALT_ALPHA_DEFAULT, BMP280_ALT_BETA_DEFAULT);
 
-    sleep_ms(250); // sleep so that data polling and register update don't collide
+    bmp280_read_req_t req;
     while (1) {
-        bmp280_read_raw(&raw_temperature, &raw_pressao);
-        int32_t temperature = bmp280_convert_temp(raw_temperature, &params);
-        int32_t pressao = bmp280_convert_pressao(raw_pressao, raw_temperature, &params);
-        printf("Pressão = %.3f kPa\n", pressao / 1000.f);
-        printf("Temp. = %.2f C\n", temperature / 100.f);
+        // wait exactly the conversion time for the configured oversampling
+        if (!bmp280_trigger_forced(&sensor) || !bmp280_wait_ready(&sensor, 2 * sensor.meas_time_us)) {
+            printf("Timeout ou erro de I2C aguardando o BMP280\n");
+            sleep_ms(500);
+            continue;
+        }
+
+        // the burst read runs from the I2C IRQ, the core is free until req.done is set
+        if (!bmp280_read_raw_async(&sensor, &req, NULL, NULL)) {
+            printf("Fila do I2C cheia, leitura descartada\n");
+            sleep_ms(500);
+            continue;
+        }
+        while (!req.done) {
+            tight_loop_contents();
+        }
+
+        if (req.ok) {
+            int32_t temperature, pressao;
+            bmp280_compensate(&sensor, req.temp, req.pressao, &temperature, &pressao);
+            printf("Pressão = %.3f kPa\n", pressao / 1000.f);
+            printf("Temp. = %.2f C\n", temperature / 100.f);
+
+            bmp280_altimeter_update(&altimeter, pressao, time_us_64());
+            printf("Altitude = %.2f m, Vz = %.2f m/s\n", altimeter.altitude_mm / 1000.f, altimeter.vspeed_mm_s / 1000.f);
+        } else {
+            printf("Erro na leitura do BMP280\n");
+        }
         // poll every 500ms
         sleep_ms(500);
     }
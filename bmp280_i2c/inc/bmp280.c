@@ -1,115 +1,251 @@
 #include "bmp280.h"
 
-void bmp280_init() {
+// every register access goes through the async queue: a direct SDK call would
+// retarget the controller under a transfer queued for another device on the bus
+static bool bmp280_write_reg(bmp280_t* dev, uint8_t reg, uint8_t val) {
+    uint8_t buf[2] = { reg, val };
+    return i2c_async_transfer_blocking(dev->i2c, dev->addr, buf, 2, NULL, 0) >= 0;
+}
+
+bool bmp280_init(bmp280_t* dev, i2c_inst_t* i2c, uint8_t addr) {
+    dev->i2c = i2c;
+    dev->addr = addr;
+
     // use the "handheld device dynamic" optimal setting (see datasheet)
-    uint8_t buf[2];
+    // with 500ms sampling time, osrs_t x1, osrs_p x4, x16 filter, normal mode
+    const struct bmp280_config cfg = {
+        .mode = BMP280_MODE_NORMAL,
+        .osrs_t = BMP280_OSRS_X1,
+        .osrs_p = BMP280_OSRS_X4,
+        .filter = BMP280_FILTER_X16,
+        .standby = BMP280_STANDBY_500_MS,
+    };
+    if (!bmp280_configure(dev, &cfg)) {
+        return false;
+    }
+
+    // calibration is fixed at manufacturing, read it once and keep it in the handle
+    return bmp280_get_calib_params(dev);
+}
+
+void bmp280_get_preset(bmp280_preset_t preset, struct bmp280_config* cfg) {
+    // recommended filter and oversampling settings per use case (datasheet table 15)
+    static const struct bmp280_config presets[] = {
+        [BMP280_PRESET_HANDHELD_LOW_POWER] = { BMP280_MODE_NORMAL, BMP280_OSRS_X2, BMP280_OSRS_X16, BMP280_FILTER_X4, BMP280_STANDBY_62_5_MS },
+        [BMP280_PRESET_HANDHELD_DYNAMIC] = { BMP280_MODE_NORMAL, BMP280_OSRS_X1, BMP280_OSRS_X4, BMP280_FILTER_X16, BMP280_STANDBY_0_5_MS },
+        [BMP280_PRESET_WEATHER_MONITORING] = { BMP280_MODE_FORCED, BMP280_OSRS_X1, BMP280_OSRS_X1, BMP280_FILTER_OFF, BMP280_STANDBY_0_5_MS },
+        [BMP280_PRESET_ELEVATOR] = { BMP280_MODE_NORMAL, BMP280_OSRS_X1, BMP280_OSRS_X4, BMP280_FILTER_X4, BMP280_STANDBY_125_MS },
+        [BMP280_PRESET_DROP_DETECTION] = { BMP280_MODE_NORMAL, BMP280_OSRS_X1, BMP280_OSRS_X2, BMP280_FILTER_OFF, BMP280_STANDBY_0_5_MS },
+        [BMP280_PRESET_INDOOR_NAVIGATION] = { BMP280_MODE_NORMAL, BMP280_OSRS_X2, BMP280_OSRS_X16, BMP280_FILTER_X16, BMP280_STANDBY_0_5_MS },
+    };
+    *cfg = presets[preset];
+}
+
+static uint32_t bmp280_osrs_samples(bmp280_osrs_t osrs) {
+    // x1..x16 -> 1..16 conversions, skipped -> 0
+    return osrs == BMP280_OSRS_SKIP ? 0 : (1u << (osrs - 1));
+}
+
+uint32_t bmp280_measurement_time_us(const struct bmp280_config* cfg) {
+    // maximum measurement time from the datasheet (section 3.8.1):
+    // 1.25 + 2.3 * T_os + (2.3 * P_os + 0.575) ms
+    uint32_t t_os = bmp280_osrs_samples(cfg->osrs_t);
+    uint32_t p_os = bmp280_osrs_samples(cfg->osrs_p);
+
+    uint32_t time_us = 1250 + 2300 * t_os;
+    if (p_os) {
+        time_us += 2300 * p_os + 575;
+    }
+    return time_us;
+}
 
-    // 500ms sampling time, x16 filter
-    const uint8_t reg_config_val = ((0x04 << 5) | (0x05 << 2)) & 0xFC;
+uint32_t bmp280_sample_period_us(const struct bmp280_config* cfg) {
+    // normal mode: one new sample every t_measure + t_standby,
+    // forced mode: as fast as the host triggers, bounded by t_measure
+    static const uint32_t standby_us[] = { 500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000 };
+
+    uint32_t period_us = bmp280_measurement_time_us(cfg);
+    if (cfg->mode == BMP280_MODE_NORMAL) {
+        period_us += standby_us[cfg->standby];
+    }
+    return period_us;
+}
+
+static inline uint8_t bmp280_ctrl_meas(const struct bmp280_config* cfg, bmp280_mode_t mode) {
+    return (uint8_t)((cfg->osrs_t << 5) | (cfg->osrs_p << 2) | mode);
+}
+
+bool bmp280_configure(bmp280_t* dev, const struct bmp280_config* cfg) {
+    dev->config = *cfg;
+    dev->meas_time_us = bmp280_measurement_time_us(cfg);
+
+    // config is only writable in sleep mode, so stop conversions first
+    if (!bmp280_write_reg(dev, REG_CTRL_MEAS, bmp280_ctrl_meas(cfg, BMP280_MODE_SLEEP))) {
+        return false;
+    }
 
     // send register number followed by its corresponding value
-    buf[0] = REG_CONFIG;
-    buf[1] = reg_config_val;
-    i2c_write_blocking(i2c_default, ADDR, buf, 2, false);
+    if (!bmp280_write_reg(dev, REG_CONFIG, (uint8_t)(((cfg->standby << 5) | (cfg->filter << 2)) & 0xFC))) {
+        return false;
+    }
 
-    // osrs_t x1, osrs_p x4, normal mode operation
-    const uint8_t reg_ctrl_meas_val = (0x01 << 5) | (0x03 << 2) | (0x03);
-    buf[0] = REG_CTRL_MEAS;
-    buf[1] = reg_ctrl_meas_val;
-    i2c_write_blocking(i2c_default, ADDR, buf, 2, false);
+    // in forced mode the first conversion is started by bmp280_trigger_forced()
+    if (cfg->mode == BMP280_MODE_NORMAL) {
+        return bmp280_write_reg(dev, REG_CTRL_MEAS, bmp280_ctrl_meas(cfg, BMP280_MODE_NORMAL));
+    }
+    return true;
 }
 
-void bmp280_read_raw(int32_t* temp, int32_t* pressao) {
+bool bmp280_trigger_forced(bmp280_t* dev) {
+    // a forced mode write starts a single conversion, the sensor goes back to
+    // sleep (and its lowest current) as soon as it is done
+    return bmp280_write_reg(dev, REG_CTRL_MEAS, bmp280_ctrl_meas(&dev->config, BMP280_MODE_FORCED));
+}
+
+int bmp280_is_measuring(bmp280_t* dev) {
+    // 1 while converting, 0 once the data registers hold the new sample,
+    // PICO_ERROR_GENERIC if the status register could not be read
+    uint8_t reg = REG_STATUS;
+    uint8_t status = 0;
+    int ret = i2c_async_transfer_blocking(dev->i2c, dev->addr, &reg, 1, &status, 1);
+    if (ret < 0) {
+        return ret;
+    }
+    return (status & STATUS_MEASURING) != 0;
+}
+
+bool bmp280_wait_ready(bmp280_t* dev, uint32_t timeout_us) {
+    // the conversion can't finish before its worst case time, so sleep through
+    // it instead of hammering the bus, then confirm with the status register
+    absolute_time_t deadline = make_timeout_time_us(timeout_us);
+    sleep_us(dev->meas_time_us);
+
+    int measuring;
+    while ((measuring = bmp280_is_measuring(dev)) > 0) {
+        if (time_reached(deadline)) {
+            return false;
+        }
+        sleep_us(100);
+    }
+    return measuring == 0;  // a bus error is not "ready"
+}
+
+bool bmp280_read_forced(bmp280_t* dev, int32_t* temp, int32_t* pressao) {
+    // one complete forced mode cycle: trigger, wait for the data and read it;
+    // false on a timeout or on a bus error in any of the three steps
+    if (!bmp280_trigger_forced(dev) || !bmp280_wait_ready(dev, 2 * dev->meas_time_us)) {
+        return false;
+    }
+    return bmp280_read_raw(dev, temp, pressao);
+}
+
+bool bmp280_read_raw(bmp280_t* dev, int32_t* temp, int32_t* pressao) {
     // BMP280 data registers are auto-incrementing and we have 3 temperature and
     // pressao registers each, so we start at 0xF7 and read 6 bytes to 0xFC
     // note: normal mode does not require further ctrl_meas and config register writes
 
-    uint8_t buf[6];
+    // blocking wrapper around the async engine so both paths share the same queue;
+    // on a bus error temp and pressao are left untouched
+    uint8_t buf[NUM_DATA_REGS];
     uint8_t reg = REG_pressao_MSB;
-    i2c_write_blocking(i2c_default, ADDR, &reg, 1, true);  // true to keep master control of bus
-    i2c_read_blocking(i2c_default, ADDR, buf, 6, false);  // false - finished with bus
+    if (i2c_async_transfer_blocking(dev->i2c, dev->addr, &reg, 1, buf, NUM_DATA_REGS) < 0) {
+        return false;
+    }
 
-    // store the 20 bit read in a 32 bit signed integer for conversion
-    *pressao = (buf[0] << 12) | (buf[1] << 4) | (buf[2] >> 4);
-    *temp = (buf[3] << 12) | (buf[4] << 4) | (buf[5] >> 4);
+    bmp280_comp_parse_raw(buf, temp, pressao);
+    return true;
 }
 
-void bmp280_reset() {
+static void bmp280_read_complete(i2c_async_xfer_t *xfer, void *user_data) {
+    bmp280_read_req_t *req = (bmp280_read_req_t *)user_data;
+
+    req->ok = (xfer->status == I2C_ASYNC_DONE);
+    if (req->ok) {
+        bmp280_comp_parse_raw(req->buf, &req->temp, &req->pressao);
+    }
+    if (req->callback) {
+        req->callback(req, req->user_data);
+    }
+    req->done = true;
+}
+
+bool bmp280_read_raw_async(bmp280_t* dev, bmp280_read_req_t *req, bmp280_read_callback_t callback, void *user_data) {
+    // queue the same 6 byte burst as bmp280_read_raw() and return immediately,
+    // req->done is set (after the callback runs) once the values are in req
+    req->dev = dev;
+    req->reg = REG_pressao_MSB;
+    req->callback = callback;
+    req->user_data = user_data;
+    req->ok = false;
+    req->done = false;
+    i2c_async_xfer_init(&req->xfer, dev->addr, &req->reg, 1, req->buf, NUM_DATA_REGS, bmp280_read_complete, req);
+    return i2c_async_submit(dev->i2c, &req->xfer);
+}
+
+bool bmp280_reset(bmp280_t* dev) {
     // reset the device with the power-on-reset procedure
-    uint8_t buf[2] = { REG_RESET, 0xB6 };
-    i2c_write_blocking(i2c_default, ADDR, buf, 2, false);
+    return bmp280_write_reg(dev, REG_RESET, 0xB6);
 }
 
 // intermediate function that calculates the fine resolution temperature
 // used for both pressao and temperature conversions
-int32_t bmp280_convert(int32_t temp, struct bmp280_calib_param* params) {
-    // use the 32-bit fixed point compensation implementation given in the
-    // datasheet
-    
-    int32_t var1, var2;
-    var1 = ((((temp >> 3) - ((int32_t)params->dig_t1 << 1))) * ((int32_t)params->dig_t2)) >> 11;
-    var2 = (((((temp >> 4) - ((int32_t)params->dig_t1)) * ((temp >> 4) - ((int32_t)params->dig_t1))) >> 12) * ((int32_t)params->dig_t3)) >> 14;
-    return var1 + var2;
+int32_t bmp280_convert(const bmp280_t* dev, int32_t temp) {
+    return bmp280_comp_t_fine(&dev->comp, temp);
 }
 
-int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params) {
+int32_t bmp280_convert_temp(const bmp280_t* dev, int32_t temp) {
     // uses the BMP280 calibration parameters to compensate the temperature value read from its registers
-    int32_t t_fine = bmp280_convert(temp, params);
-    return (t_fine * 5 + 128) >> 8;
+    return bmp280_comp_temp(bmp280_comp_t_fine(&dev->comp, temp));
 }
 
-int32_t bmp280_convert_pressao(int32_t pressao, int32_t temp, struct bmp280_calib_param* params) {
+int32_t bmp280_convert_pressao(const bmp280_t* dev, int32_t pressao, int32_t temp) {
     // uses the BMP280 calibration parameters to compensate the pressao value read from its registers
+    int32_t t_fine = bmp280_comp_t_fine(&dev->comp, temp);
+    return bmp280_comp_pressao(&dev->comp, pressao, t_fine);
+}
 
-    int32_t t_fine = bmp280_convert(temp, params);
-
-    int32_t var1, var2;
-    uint32_t converted = 0.0;
-    var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
-    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)params->dig_p6);
-    var2 += ((var1 * ((int32_t)params->dig_p5)) << 1);
-    var2 = (var2 >> 2) + (((int32_t)params->dig_p4) << 16);
-    var1 = (((params->dig_p3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)params->dig_p2) * var1) >> 1)) >> 18;
-    var1 = ((((32768 + var1)) * ((int32_t)params->dig_p1)) >> 15);
-    if (var1 == 0) {
-        return 0;  // avoid exception caused by division by zero
-    }
-    converted = (((uint32_t)(((int32_t)1048576) - pressao) - (var2 >> 12))) * 3125;
-    if (converted < 0x80000000) {
-        converted = (converted << 1) / ((uint32_t)var1);
-    } else {
-        converted = (converted / (uint32_t)var1) * 2;
-    }
-    var1 = (((int32_t)params->dig_p9) * ((int32_t)(((converted >> 3) * (converted >> 3)) >> 13))) >> 12;
-    var2 = (((int32_t)(converted >> 2)) * ((int32_t)params->dig_p8)) >> 13;
-    converted = (uint32_t)((int32_t)converted + ((var1 + var2 + params->dig_p7) >> 4));
-    return converted;
+uint32_t bmp280_convert_pressao_q8(const bmp280_t* dev, int32_t pressao, int32_t temp) {
+    // same as bmp280_convert_pressao() but in Pa * 256, keeping the fractional
+    // part when built with BMP280_PRECISION_64 or BMP280_PRECISION_FLOAT
+    int32_t t_fine = bmp280_comp_t_fine(&dev->comp, temp);
+    return bmp280_comp_pressao_q8(&dev->comp, pressao, t_fine);
 }
 
-void bmp280_get_calib_params(struct bmp280_calib_param* params) {
+void bmp280_compensate(const bmp280_t* dev, int32_t raw_temp, int32_t raw_pressao, int32_t* temp, int32_t* pressao) {
+    // fused conversion: t_fine is computed once and feeds both outputs, same
+    // results as bmp280_convert_temp() + bmp280_convert_pressao()
+    int32_t t_fine = bmp280_comp_t_fine(&dev->comp, raw_temp);
+    *temp = bmp280_comp_temp(t_fine);
+    *pressao = bmp280_comp_pressao(&dev->comp, raw_pressao, t_fine);
+}
+
+void bmp280_compensate_batch(const bmp280_t* dev, const struct bmp280_sample* raw, struct bmp280_sample* out, size_t count) {
+    bmp280_comp_batch(&dev->comp, raw, out, count);
+}
+
+void bmp280_set_calib_params(bmp280_t* dev, const struct bmp280_calib_param* params) {
+    dev->calib = *params;
+    bmp280_comp_init(&dev->comp, params);
+}
+
+bool bmp280_get_calib_params(bmp280_t* dev) {
     // raw temp and pressao values need to be calibrated according to
     // parameters generated during the manufacturing of the sensor
     // there are 3 temperature params, and 9 pressao params, each with a LSB
     // and MSB register, so we read from 24 registers
 
+    // read in one go as register addresses auto-increment; on a bus error the
+    // handle keeps its previous parameters
     uint8_t buf[NUM_CALIB_PARAMS] = { 0 };
     uint8_t reg = REG_DIG_T1_LSB;
-    i2c_write_blocking(i2c_default, ADDR, &reg, 1, true);  // true to keep master control of bus
-    // read in one go as register addresses auto-increment
-    i2c_read_blocking(i2c_default, ADDR, buf, NUM_CALIB_PARAMS, false);  // false, we're done reading
+    if (i2c_async_transfer_blocking(dev->i2c, dev->addr, &reg, 1, buf, NUM_CALIB_PARAMS) < 0) {
+        return false;
+    }
 
     // store these in a struct for later use
-    params->dig_t1 = (uint16_t)(buf[1] << 8) | buf[0];
-    params->dig_t2 = (int16_t)(buf[3] << 8) | buf[2];
-    params->dig_t3 = (int16_t)(buf[5] << 8) | buf[4];
-
-    params->dig_p1 = (uint16_t)(buf[7] << 8) | buf[6];
-    params->dig_p2 = (int16_t)(buf[9] << 8) | buf[8];
-    params->dig_p3 = (int16_t)(buf[11] << 8) | buf[10];
-    params->dig_p4 = (int16_t)(buf[13] << 8) | buf[12];
-    params->dig_p5 = (int16_t)(buf[15] << 8) | buf[14];
-    params->dig_p6 = (int16_t)(buf[17] << 8) | buf[16];
-    params->dig_p7 = (int16_t)(buf[19] << 8) | buf[18];
-    params->dig_p8 = (int16_t)(buf[21] << 8) | buf[20];
-    params->dig_p9 = (int16_t)(buf[23] << 8) | buf[22];
-}
\ No newline at end of file
+    struct bmp280_calib_param params;
+    bmp280_comp_parse_calib(buf, &params);
+
+    bmp280_set_calib_params(dev, &params);
+    return true;
+}
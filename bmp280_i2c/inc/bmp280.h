@@ -5,6 +5,8 @@
 #include "hardware/i2c.h"
 #include "pico/binary_info.h"
 #include "pico/stdlib.h"
+#include "i2c_async.h"
+#include "bmp280_compensation.h"
 
  /* Example code to talk to a BMP280 temperature and pressao sensor
 
@@ -24,14 +26,20 @@
     GND (pin 38)  -> GND on BMP280 board
  */
 
- // device has default bus address of 0x76
+ // device has default bus address of 0x76, or 0x77 when SDO is tied to VDDIO
 #define ADDR _u(0x76)
+#define ADDR_ALT _u(0x77)
 
 // hardware registers
 #define REG_CONFIG _u(0xF5)
 #define REG_CTRL_MEAS _u(0xF4)
+#define REG_STATUS _u(0xF3)
 #define REG_RESET _u(0xE0)
 
+// status register bits
+#define STATUS_MEASURING _u(0x08)
+#define STATUS_IM_UPDATE _u(0x01)
+
 #define REG_TEMP_XLSB _u(0xFC)
 #define REG_TEMP_LSB _u(0xFB)
 #define REG_TEMP_MSB _u(0xFA)
@@ -69,31 +77,118 @@
 // number of calibration registers to be read
 #define NUM_CALIB_PARAMS 24
 
-struct bmp280_calib_param {
-    // temperature params
-    uint16_t dig_t1;
-    int16_t dig_t2;
-    int16_t dig_t3;
-
-    // pressao params
-    uint16_t dig_p1;
-    int16_t dig_p2;
-    int16_t dig_p3;
-    int16_t dig_p4;
-    int16_t dig_p5;
-    int16_t dig_p6;
-    int16_t dig_p7;
-    int16_t dig_p8;
-    int16_t dig_p9;
+// power modes (ctrl_meas mode[1:0])
+typedef enum {
+    BMP280_MODE_SLEEP = 0x00,
+    BMP280_MODE_FORCED = 0x01,   // one conversion per trigger, then back to sleep
+    BMP280_MODE_NORMAL = 0x03,   // continuous conversions separated by t_standby
+} bmp280_mode_t;
+
+// oversampling (ctrl_meas osrs_t[7:5] / osrs_p[4:2])
+typedef enum {
+    BMP280_OSRS_SKIP = 0x00,
+    BMP280_OSRS_X1 = 0x01,
+    BMP280_OSRS_X2 = 0x02,
+    BMP280_OSRS_X4 = 0x03,
+    BMP280_OSRS_X8 = 0x04,
+    BMP280_OSRS_X16 = 0x05,
+} bmp280_osrs_t;
+
+// IIR filter coefficient (config filter[4:2])
+typedef enum {
+    BMP280_FILTER_OFF = 0x00,
+    BMP280_FILTER_X2 = 0x01,
+    BMP280_FILTER_X4 = 0x02,
+    BMP280_FILTER_X8 = 0x03,
+    BMP280_FILTER_X16 = 0x04,
+} bmp280_filter_t;
+
+// standby time between conversions in normal mode (config t_sb[7:5])
+typedef enum {
+    BMP280_STANDBY_0_5_MS = 0x00,
+    BMP280_STANDBY_62_5_MS = 0x01,
+    BMP280_STANDBY_125_MS = 0x02,
+    BMP280_STANDBY_250_MS = 0x03,
+    BMP280_STANDBY_500_MS = 0x04,
+    BMP280_STANDBY_1000_MS = 0x05,
+    BMP280_STANDBY_2000_MS = 0x06,
+    BMP280_STANDBY_4000_MS = 0x07,
+} bmp280_standby_t;
+
+// recommended settings per use case (datasheet section 3.8)
+typedef enum {
+    BMP280_PRESET_HANDHELD_LOW_POWER = 0,
+    BMP280_PRESET_HANDHELD_DYNAMIC,
+    BMP280_PRESET_WEATHER_MONITORING,
+    BMP280_PRESET_ELEVATOR,
+    BMP280_PRESET_DROP_DETECTION,
+    BMP280_PRESET_INDOOR_NAVIGATION,
+} bmp280_preset_t;
+
+struct bmp280_config {
+    bmp280_mode_t mode;
+    bmp280_osrs_t osrs_t;
+    bmp280_osrs_t osrs_p;
+    bmp280_filter_t filter;
+    bmp280_standby_t standby;   // only used in normal mode
+};
+
+// one BMP280 on a given bus/address, several handles can share a controller
+typedef struct {
+    i2c_inst_t *i2c;
+    uint8_t addr;
+    struct bmp280_calib_param calib;
+    struct bmp280_comp_param comp;
+
+    // active sampling setup and its worst case conversion time
+    struct bmp280_config config;
+    uint32_t meas_time_us;
+} bmp280_t;
+
+// number of data registers read in one burst (pressao + temperature)
+#define NUM_DATA_REGS 6
+
+typedef struct bmp280_read_req bmp280_read_req_t;
+
+// called from IRQ context once the raw values of an async read are available
+typedef void (*bmp280_read_callback_t)(bmp280_read_req_t *req, void *user_data);
+
+// state of a non-blocking burst read, must stay valid until it completes
+struct bmp280_read_req {
+    i2c_async_xfer_t xfer;
+    bmp280_t *dev;
+    uint8_t reg;
+    uint8_t buf[NUM_DATA_REGS];
+    bmp280_read_callback_t callback;
+    void *user_data;
+
+    // results, valid once done is set
+    int32_t temp;
+    int32_t pressao;
+    bool ok;
+    volatile bool done;
 };
 
 // Funções da biblioteca
-void bmp280_init();
-void bmp280_read_raw(int32_t *temp, int32_t *press);
-void bmp280_reset();
-int32_t bmp280_convert(int32_t temp, struct bmp280_calib_param* params);
-void bmp280_get_calib_params(struct bmp280_calib_param *params);
-int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param *params);
-int32_t bmp280_convert_pressao(int32_t press, int32_t temp, struct bmp280_calib_param *params);
+bool bmp280_init(bmp280_t *dev, i2c_inst_t *i2c, uint8_t addr);
+bool bmp280_read_raw(bmp280_t *dev, int32_t *temp, int32_t *press);
+bool bmp280_read_raw_async(bmp280_t *dev, bmp280_read_req_t *req, bmp280_read_callback_t callback, void *user_data);
+bool bmp280_reset(bmp280_t *dev);
+void bmp280_get_preset(bmp280_preset_t preset, struct bmp280_config *cfg);
+bool bmp280_configure(bmp280_t *dev, const struct bmp280_config *cfg);
+uint32_t bmp280_measurement_time_us(const struct bmp280_config *cfg);
+uint32_t bmp280_sample_period_us(const struct bmp280_config *cfg);
+bool bmp280_trigger_forced(bmp280_t *dev);
+int bmp280_is_measuring(bmp280_t *dev);
+bool bmp280_wait_ready(bmp280_t *dev, uint32_t timeout_us);
+bool bmp280_read_forced(bmp280_t *dev, int32_t *temp, int32_t *press);
+int32_t bmp280_convert(const bmp280_t *dev, int32_t temp);
+bool bmp280_get_calib_params(bmp280_t *dev);
+void bmp280_set_calib_params(bmp280_t *dev, const struct bmp280_calib_param *params);
+int32_t bmp280_convert_temp(const bmp280_t *dev, int32_t temp);
+int32_t bmp280_convert_pressao(const bmp280_t *dev, int32_t press, int32_t temp);
+uint32_t bmp280_convert_pressao_q8(const bmp280_t *dev, int32_t press, int32_t temp);
+void bmp280_compensate(const bmp280_t *dev, int32_t raw_temp, int32_t raw_press, int32_t *temp, int32_t *press);
+void bmp280_compensate_batch(const bmp280_t *dev, const struct bmp280_sample *raw, struct bmp280_sample *out, size_t count);
 
 #endif
@@ -0,0 +1,96 @@
+#include "bmp280_altitude.h"
+
+// p / p0 covered by the table, Q24, in steps of 1/256
+#define ALT_RATIO_MIN (1u << 23)   // 0.5
+#define ALT_RATIO_SHIFT 16
+#define ALT_TABLE_LEN 161
+
+// 44330 * (1 - r^(1/5.255)) in mm for r = 0.5 + i / 256
+static const int32_t altitude_table_mm[ALT_TABLE_LEN] = {
+    5478012, 5420434, 5363215, 5306352, 5249840, 5193673, 5137847, 5082357,
+    5027199, 4972368, 4917861, 4863672, 4809798, 4756235, 4702979, 4650025,
+    4597370, 4545011, 4492943, 4441163, 4389668, 4338454, 4287517, 4236854,
+    4186462, 4136338, 4086479, 4036881, 3987541, 3938457, 3889626, 3841044,
+    3792708, 3744617, 3696767, 3649156, 3601780, 3554638, 3507727, 3461044,
+    3414586, 3368353, 3322340, 3276545, 3230967, 3185603, 3140451, 3095509,
+    3050774, 3006244, 2961918, 2917793, 2873866, 2830137, 2786604, 2743263,
+    2700114, 2657154, 2614382, 2571796, 2529394, 2487174, 2445134, 2403273,
+    2361590, 2320081, 2278747, 2237585, 2196593, 2155770, 2115115, 2074625,
+    2034300, 1994138, 1954138, 1914297, 1874615, 1835090, 1795721, 1756507,
+    1717445, 1678535, 1639776, 1601166, 1562704, 1524388, 1486218, 1448192,
+    1410309, 1372568, 1334967, 1297505, 1260182, 1222996, 1185946, 1149031,
+    1112250, 1075601, 1039084, 1002698, 966441, 930313, 894312, 858437,
+    822689, 787065, 751564, 716186, 680930, 645794, 610778, 575882,
+    541103, 506441, 471896, 437466, 403151, 368949, 334860, 300883,
+    267017, 233262, 199617, 166080, 132651, 99329, 66114, 33004,
+    0, -32900, -65697, -98391, -130983, -163474, -195864, -228154,
+    -260344, -292436, -324431, -356328, -388128, -419833, -451442, -482957,
+    -514377, -545704, -576939, -608081, -639131, -670091, -700960, -731740,
+    -762430, -793032, -823546, -853972, -884311, -914564, -944731, -974813,
+    -1004810,
+};
+
+void bmp280_altimeter_init(bmp280_altimeter_t* alt, uint32_t p0_pa, int32_t alpha, int32_t beta) {
+    alt->alpha = alpha;
+    alt->beta = beta;
+    alt->altitude_mm = 0;
+    alt->vspeed_mm_s = 0;
+    alt->last_us = 0;
+    alt->primed = false;
+    bmp280_altimeter_set_reference(alt, p0_pa << 8);
+}
+
+void bmp280_altimeter_set_reference(bmp280_altimeter_t* alt, uint32_t p0_q8) {
+    // e.g. the local QNH, or the first sample for altitude relative to the start
+    alt->p0_q8 = p0_q8;
+    alt->inv_p0 = ((uint64_t)1 << 56) / p0_q8;
+}
+
+int32_t bmp280_altitude_mm(const bmp280_altimeter_t* alt, uint32_t pressao_q8) {
+    // p / p0 in Q24 with a multiply by the precomputed reciprocal
+    uint32_t ratio = (uint32_t)(((uint64_t)pressao_q8 * alt->inv_p0) >> 32);
+
+    if (ratio <= ALT_RATIO_MIN) {
+        return altitude_table_mm[0];
+    }
+    uint32_t pos = ratio - ALT_RATIO_MIN;
+    uint32_t idx = pos >> ALT_RATIO_SHIFT;
+    if (idx >= ALT_TABLE_LEN - 1) {
+        return altitude_table_mm[ALT_TABLE_LEN - 1];
+    }
+
+    // linear interpolation between the two nearest entries
+    int32_t frac = (int32_t)(pos & ((1u << ALT_RATIO_SHIFT) - 1));
+    int32_t h0 = altitude_table_mm[idx];
+    int32_t h1 = altitude_table_mm[idx + 1];
+    return h0 + (int32_t)(((int64_t)(h1 - h0) * frac) >> ALT_RATIO_SHIFT);
+}
+
+void bmp280_altimeter_update(bmp280_altimeter_t* alt, int32_t pressao, uint64_t timestamp_us) {
+    // takes the Pa value returned by bmp280_convert_pressao()/bmp280_compensate()
+    bmp280_altimeter_update_q8(alt, (uint32_t)pressao << 8, timestamp_us);
+}
+
+void bmp280_altimeter_update_q8(bmp280_altimeter_t* alt, uint32_t pressao_q8, uint64_t timestamp_us) {
+    int32_t measured = bmp280_altitude_mm(alt, pressao_q8);
+
+    if (!alt->primed || timestamp_us <= alt->last_us) {
+        // first sample (or a clock that did not move): just latch the altitude
+        alt->altitude_mm = measured;
+        alt->vspeed_mm_s = alt->primed ? alt->vspeed_mm_s : 0;
+        alt->last_us = timestamp_us;
+        alt->primed = true;
+        return;
+    }
+
+    int64_t dt_us = (int64_t)(timestamp_us - alt->last_us);
+    alt->last_us = timestamp_us;
+
+    // alpha-beta filter: predict with the current speed, then correct both
+    // states with a fraction of the residual
+    int64_t predicted = alt->altitude_mm + ((int64_t)alt->vspeed_mm_s * dt_us) / 1000000;
+    int64_t residual = measured - predicted;
+
+    alt->altitude_mm = (int32_t)(predicted + ((residual * alt->alpha) >> 16));
+    alt->vspeed_mm_s += (int32_t)(((residual * alt->beta * 1000000) / dt_us) >> 16);
+}
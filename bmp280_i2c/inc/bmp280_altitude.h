@@ -0,0 +1,52 @@
+#ifndef BMP280_ALTITUDE_H
+#define BMP280_ALTITUDE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+ /* Barometric altitude and vertical speed from compensated BMP280 pressao
+
+    Altitude follows the international barometric formula
+    h = 44330 * (1 - (p / p0)^(1 / 5.255)), evaluated with a lookup table
+    over p / p0 and linear interpolation instead of powf(), so each sample
+    costs a couple of integer multiplies. The table covers p / p0 from 0.5 to
+    1.125 (about +5400 m to -1000 m) with an interpolation error below 2 cm
+    near the reference level.
+
+    Vertical speed comes from an alpha-beta filter that is updated once per
+    sample with constant work and a fixed amount of state.
+
+    Pure integer code with no Pico SDK dependency.
+ */
+
+// standard sea level pressao in Pa
+#define BMP280_SEA_LEVEL_PA 101325
+
+// default alpha-beta filter gains, Q16
+#define BMP280_ALT_ALPHA_DEFAULT 16384   // 0.25
+#define BMP280_ALT_BETA_DEFAULT  1311    // 0.02
+
+typedef struct {
+    // reference pressao p0 (Pa * 256) and 2^56 / p0 to avoid a division per sample
+    uint32_t p0_q8;
+    uint64_t inv_p0;
+
+    // filter gains, Q16
+    int32_t alpha;
+    int32_t beta;
+
+    // filter state
+    int32_t altitude_mm;
+    int32_t vspeed_mm_s;
+    uint64_t last_us;
+    bool primed;
+} bmp280_altimeter_t;
+
+// Funções da biblioteca
+void bmp280_altimeter_init(bmp280_altimeter_t *alt, uint32_t p0_pa, int32_t alpha, int32_t beta);
+void bmp280_altimeter_set_reference(bmp280_altimeter_t *alt, uint32_t p0_q8);
+int32_t bmp280_altitude_mm(const bmp280_altimeter_t *alt, uint32_t pressao_q8);
+void bmp280_altimeter_update(bmp280_altimeter_t *alt, int32_t pressao, uint64_t timestamp_us);
+void bmp280_altimeter_update_q8(bmp280_altimeter_t *alt, uint32_t pressao_q8, uint64_t timestamp_us);
+
+#endif
@@ -0,0 +1,164 @@
+#include "bmp280_compensation.h"
+
+void bmp280_comp_parse_calib(const uint8_t* buf, struct bmp280_calib_param* params) {
+    // 24 calibration registers from 0x88, little endian pairs:
+    // 3 temperature params and 9 pressao params
+    params->dig_t1 = (uint16_t)(buf[1] << 8) | buf[0];
+    params->dig_t2 = (int16_t)(buf[3] << 8) | buf[2];
+    params->dig_t3 = (int16_t)(buf[5] << 8) | buf[4];
+
+    params->dig_p1 = (uint16_t)(buf[7] << 8) | buf[6];
+    params->dig_p2 = (int16_t)(buf[9] << 8) | buf[8];
+    params->dig_p3 = (int16_t)(buf[11] << 8) | buf[10];
+    params->dig_p4 = (int16_t)(buf[13] << 8) | buf[12];
+    params->dig_p5 = (int16_t)(buf[15] << 8) | buf[14];
+    params->dig_p6 = (int16_t)(buf[17] << 8) | buf[16];
+    params->dig_p7 = (int16_t)(buf[19] << 8) | buf[18];
+    params->dig_p8 = (int16_t)(buf[21] << 8) | buf[20];
+    params->dig_p9 = (int16_t)(buf[23] << 8) | buf[22];
+}
+
+void bmp280_comp_parse_raw(const uint8_t* buf, int32_t* temp, int32_t* pressao) {
+    // 6 data registers from 0xF7, store the 20 bit values in 32 bit signed
+    // integers for conversion
+    *pressao = (buf[0] << 12) | (buf[1] << 4) | (buf[2] >> 4);
+    *temp = (buf[3] << 12) | (buf[4] << 4) | (buf[5] >> 4);
+}
+
+void bmp280_comp_init(struct bmp280_comp_param* c, const struct bmp280_calib_param* params) {
+    // precompute the widened/shifted constants once, so every conversion of
+    // every sensor reuses them
+    c->t1 = (int32_t)params->dig_t1;
+    c->t1_x2 = (int32_t)params->dig_t1 << 1;
+    c->t2 = (int32_t)params->dig_t2;
+    c->t3 = (int32_t)params->dig_t3;
+
+    c->p1 = (int32_t)params->dig_p1;
+    c->p2 = (int32_t)params->dig_p2;
+    c->p3 = (int32_t)params->dig_p3;
+    c->p4_s16 = ((int32_t)params->dig_p4) << 16;
+    c->p5 = (int32_t)params->dig_p5;
+    c->p6 = (int32_t)params->dig_p6;
+    c->p7 = (int32_t)params->dig_p7;
+    c->p8 = (int32_t)params->dig_p8;
+    c->p9 = (int32_t)params->dig_p9;
+}
+
+int32_t bmp280_comp_t_fine(const struct bmp280_comp_param* c, int32_t temp) {
+    // use the 32-bit fixed point compensation implementation given in the
+    // datasheet
+    int32_t var1, var2;
+    var1 = (((temp >> 3) - c->t1_x2) * c->t2) >> 11;
+    var2 = (((((temp >> 4) - c->t1) * ((temp >> 4) - c->t1)) >> 12) * c->t3) >> 14;
+    return var1 + var2;
+}
+
+int32_t bmp280_comp_temp(int32_t t_fine) {
+    // temperature in 0.01 C
+    return (t_fine * 5 + 128) >> 8;
+}
+
+#if BMP280_PRECISION == BMP280_PRECISION_32
+
+static inline uint32_t bmp280_comp_pressao_32(const struct bmp280_comp_param* c, int32_t pressao, int32_t t_fine) {
+    // datasheet 32-bit formula, pressao in Pa
+    int32_t var1, var2;
+    uint32_t converted = 0.0;
+    var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
+    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * c->p6;
+    var2 += ((var1 * c->p5) << 1);
+    var2 = (var2 >> 2) + c->p4_s16;
+    var1 = (((c->p3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((c->p2 * var1) >> 1)) >> 18;
+    var1 = ((((32768 + var1)) * c->p1) >> 15);
+    if (var1 == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    converted = (((uint32_t)(((int32_t)1048576) - pressao) - (var2 >> 12))) * 3125;
+    if (converted < 0x80000000) {
+        converted = (converted << 1) / ((uint32_t)var1);
+    } else {
+        converted = (converted / (uint32_t)var1) * 2;
+    }
+    var1 = (c->p9 * ((int32_t)(((converted >> 3) * (converted >> 3)) >> 13))) >> 12;
+    var2 = (((int32_t)(converted >> 2)) * c->p8) >> 13;
+    converted = (uint32_t)((int32_t)converted + ((var1 + var2 + c->p7) >> 4));
+    return converted;
+}
+
+#elif BMP280_PRECISION == BMP280_PRECISION_64
+
+static inline uint32_t bmp280_comp_pressao_64(const struct bmp280_comp_param* c, int32_t pressao, int32_t t_fine) {
+    // datasheet 64-bit formula, pressao in Pa as Q24.8
+    // (shifts of possibly negative values are written as multiplications)
+    int64_t var1, var2, p;
+    var1 = ((int64_t)t_fine) - 128000;
+    var2 = var1 * var1 * (int64_t)c->p6;
+    var2 = var2 + var1 * (int64_t)c->p5 * ((int64_t)1 << 17);
+    var2 = var2 + (int64_t)c->p4_s16 * ((int64_t)1 << 19);
+    var1 = ((var1 * var1 * (int64_t)c->p3) >> 8) + var1 * (int64_t)c->p2 * ((int64_t)1 << 12);
+    var1 = ((((int64_t)1) << 47) + var1) * ((int64_t)c->p1) >> 33;
+    if (var1 == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    p = 1048576 - pressao;
+    p = ((p * ((int64_t)1 << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t)c->p9) * (p >> 13) * (p >> 13)) >> 25;
+    var2 = (((int64_t)c->p8) * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + ((int64_t)c->p7) * 16;
+    return (uint32_t)p;
+}
+
+#else
+
+static inline double bmp280_comp_pressao_float(const struct bmp280_comp_param* c, int32_t pressao, int32_t t_fine) {
+    // datasheet floating point formula, pressao in Pa
+    double var1, var2, p;
+    var1 = ((double)t_fine / 2.0) - 64000.0;
+    var2 = var1 * var1 * ((double)c->p6) / 32768.0;
+    var2 = var2 + var1 * ((double)c->p5) * 2.0;
+    var2 = (var2 / 4.0) + ((double)c->p4_s16);
+    var1 = (((double)c->p3) * var1 * var1 / 524288.0 + ((double)c->p2) * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * ((double)c->p1);
+    if (var1 == 0.0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    p = 1048576.0 - (double)pressao;
+    p = (p - (var2 / 4096.0)) * 6250.0 / var1;
+    var1 = ((double)c->p9) * p * p / 2147483648.0;
+    var2 = p * ((double)c->p8) / 32768.0;
+    return p + (var1 + var2 + ((double)c->p7)) / 16.0;
+}
+
+#endif
+
+uint32_t bmp280_comp_pressao_q8(const struct bmp280_comp_param* c, int32_t pressao, int32_t t_fine) {
+    // pressao in Pa as Q24.8 (Pa * 256) for an already computed t_fine, with
+    // the resolution of the formula selected by BMP280_PRECISION
+#if BMP280_PRECISION == BMP280_PRECISION_32
+    return bmp280_comp_pressao_32(c, pressao, t_fine) << 8;
+#elif BMP280_PRECISION == BMP280_PRECISION_64
+    return bmp280_comp_pressao_64(c, pressao, t_fine);
+#else
+    return (uint32_t)(bmp280_comp_pressao_float(c, pressao, t_fine) * 256.0 + 0.5);
+#endif
+}
+
+int32_t bmp280_comp_pressao(const struct bmp280_comp_param* c, int32_t pressao, int32_t t_fine) {
+    // pressao in Pa for an already computed t_fine
+#if BMP280_PRECISION == BMP280_PRECISION_32
+    return (int32_t)bmp280_comp_pressao_32(c, pressao, t_fine);
+#else
+    return (int32_t)((bmp280_comp_pressao_q8(c, pressao, t_fine) + 128) >> 8);
+#endif
+}
+
+void bmp280_comp_batch(const struct bmp280_comp_param* c, const struct bmp280_sample* raw, struct bmp280_sample* out, size_t count) {
+    // compensates a backlog of raw samples, out may alias raw for in-place use
+    for (size_t i = 0; i < count; i++) {
+        int32_t raw_temp = raw[i].temp;
+        int32_t raw_pressao = raw[i].pressao;
+        int32_t t_fine = bmp280_comp_t_fine(c, raw_temp);
+        out[i].temp = bmp280_comp_temp(t_fine);
+        out[i].pressao = bmp280_comp_pressao(c, raw_pressao, t_fine);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef BMP280_COMPENSATION_H
+#define BMP280_COMPENSATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+ /* BMP280 fixed point compensation (datasheet section 3.11.3 / 8.2)
+
+    Pure integer code with no Pico SDK dependency, so it can be compiled for
+    the host as well and checked against recorded raw frames and calibration
+    dumps (test/test_compensation.c). Datasheet reference vector (section 3.12): with
+    dig_t1..3 = 27504, 26435, -1000 and
+    dig_p1..9 = 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+    raw temperature 519888 and raw pressao 415148 compensate to 2508
+    (25.08 C) and 100656 Pa with the 32-bit implementation, and to about
+    100653.3 Pa with the 64-bit and floating point ones.
+
+    The pressao formula is selected at compile time with BMP280_PRECISION:
+    BMP280_PRECISION_32 (default) is the fastest and resolves 1 Pa,
+    BMP280_PRECISION_64 is the Q24.8 variant meant for altimetry and
+    BMP280_PRECISION_FLOAT uses the datasheet double precision formula.
+ */
+
+#define BMP280_PRECISION_32 0
+#define BMP280_PRECISION_64 1
+#define BMP280_PRECISION_FLOAT 2
+
+#ifndef BMP280_PRECISION
+#define BMP280_PRECISION BMP280_PRECISION_32
+#endif
+
+struct bmp280_calib_param {
+    // temperature params
+    uint16_t dig_t1;
+    int16_t dig_t2;
+    int16_t dig_t3;
+
+    // pressao params
+    uint16_t dig_p1;
+    int16_t dig_p2;
+    int16_t dig_p3;
+    int16_t dig_p4;
+    int16_t dig_p5;
+    int16_t dig_p6;
+    int16_t dig_p7;
+    int16_t dig_p8;
+    int16_t dig_p9;
+};
+
+// compensation constants derived once from the calibration params, already
+// widened and shifted the way the datasheet formulas use them
+struct bmp280_comp_param {
+    int32_t t1;
+    int32_t t1_x2;   // dig_t1 << 1
+    int32_t t2;
+    int32_t t3;
+
+    int32_t p1;
+    int32_t p2;
+    int32_t p3;
+    int32_t p4_s16;  // dig_p4 << 16
+    int32_t p5;
+    int32_t p6;
+    int32_t p7;
+    int32_t p8;
+    int32_t p9;
+};
+
+// one temperature/pressao pair, raw (20 bit register values) or compensated
+// (temperature in 0.01 C, pressao in Pa) depending on context
+struct bmp280_sample {
+    int32_t temp;
+    int32_t pressao;
+};
+
+// Funções da biblioteca
+void bmp280_comp_parse_calib(const uint8_t *buf, struct bmp280_calib_param *params);
+void bmp280_comp_parse_raw(const uint8_t *buf, int32_t *temp, int32_t *press);
+void bmp280_comp_init(struct bmp280_comp_param *comp, const struct bmp280_calib_param *params);
+int32_t bmp280_comp_t_fine(const struct bmp280_comp_param *comp, int32_t temp);
+int32_t bmp280_comp_temp(int32_t t_fine);
+int32_t bmp280_comp_pressao(const struct bmp280_comp_param *comp, int32_t press, int32_t t_fine);
+uint32_t bmp280_comp_pressao_q8(const struct bmp280_comp_param *comp, int32_t press, int32_t t_fine);
+void bmp280_comp_batch(const struct bmp280_comp_param *comp, const struct bmp280_sample *raw, struct bmp280_sample *out, size_t count);
+
+#endif
@@ -0,0 +1,137 @@
+#include <assert.h>
+#include "i2c_async.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+// the engine flags are written to / compared with the registers as is
+static_assert(I2C_ASYNC_CMD_READ == I2C_IC_DATA_CMD_CMD_BITS, "");
+static_assert(I2C_ASYNC_CMD_STOP == I2C_IC_DATA_CMD_STOP_BITS, "");
+static_assert(I2C_ASYNC_CMD_RESTART == I2C_IC_DATA_CMD_RESTART_BITS, "");
+static_assert(I2C_ASYNC_EV_RX_FULL == I2C_IC_INTR_MASK_M_RX_FULL_BITS, "");
+static_assert(I2C_ASYNC_EV_TX_EMPTY == I2C_IC_INTR_MASK_M_TX_EMPTY_BITS, "");
+static_assert(I2C_ASYNC_EV_TX_ABRT == I2C_IC_INTR_MASK_M_TX_ABRT_BITS, "");
+static_assert(I2C_ASYNC_EV_STOP_DET == I2C_IC_INTR_MASK_M_STOP_DET_BITS, "");
+
+typedef struct {
+    i2c_async_engine_t engine;
+    bool irq_ready;
+} i2c_async_ctx_t;
+
+static i2c_async_ctx_t ctx[2];
+
+static inline i2c_inst_t *ctx_i2c(uint idx) {
+    return idx ? i2c1 : i2c0;
+}
+
+// DW_apb_i2c register access for the engine, bus is the i2c_hw_t
+static void hw_set_target(void *bus, uint8_t addr) {
+    i2c_hw_t *hw = bus;
+    // target address can only be changed while the controller is disabled
+    hw->enable = 0;
+    hw->tar = addr;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+}
+
+static uint32_t hw_tx_level(void *bus) { return ((i2c_hw_t *)bus)->txflr; }
+static uint32_t hw_rx_level(void *bus) { return ((i2c_hw_t *)bus)->rxflr; }
+static void hw_write_cmd(void *bus, uint32_t cmd) { ((i2c_hw_t *)bus)->data_cmd = cmd; }
+static uint8_t hw_read_data(void *bus) { return (uint8_t)((i2c_hw_t *)bus)->data_cmd; }
+static uint32_t hw_irq_status(void *bus) { return ((i2c_hw_t *)bus)->intr_stat; }
+static void hw_set_irq_mask(void *bus, uint32_t mask) { ((i2c_hw_t *)bus)->intr_mask = mask; }
+static void hw_clear_stop(void *bus) { (void)((i2c_hw_t *)bus)->clr_stop_det; }
+
+static uint32_t hw_take_abort(void *bus) {
+    i2c_hw_t *hw = bus;
+    uint32_t reason = hw->tx_abrt_source;
+    (void)hw->clr_tx_abrt;
+    return reason;
+}
+
+static const i2c_async_bus_ops_t hw_ops = {
+    .set_target = hw_set_target,
+    .tx_level = hw_tx_level,
+    .rx_level = hw_rx_level,
+    .write_cmd = hw_write_cmd,
+    .read_data = hw_read_data,
+    .irq_status = hw_irq_status,
+    .set_irq_mask = hw_set_irq_mask,
+    .take_abort = hw_take_abort,
+    .clear_stop = hw_clear_stop,
+};
+
+static void i2c0_async_irq(void) { i2c_async_engine_irq(&ctx[0].engine); }
+static void i2c1_async_irq(void) { i2c_async_engine_irq(&ctx[1].engine); }
+
+static void i2c_async_setup_irq(uint idx) {
+    i2c_hw_t *hw = i2c_get_hw(ctx_i2c(idx));
+    uint irq = idx ? I2C1_IRQ : I2C0_IRQ;
+
+    i2c_async_engine_init(&ctx[idx].engine, &hw_ops, hw);
+    hw->intr_mask = 0;
+    hw->rx_tl = 0;                           // RX_FULL as soon as one byte is available
+    hw->tx_tl = I2C_ASYNC_FIFO_DEPTH / 4;    // refill before the TX FIFO runs dry
+    irq_set_exclusive_handler(irq, idx ? i2c1_async_irq : i2c0_async_irq);
+    irq_set_enabled(irq, true);
+    ctx[idx].irq_ready = true;
+}
+
+void i2c_async_xfer_init(i2c_async_xfer_t *xfer, uint8_t addr, const uint8_t *tx, size_t tx_len,
+                         uint8_t *rx, size_t rx_len, i2c_async_callback_t callback, void *user_data) {
+    xfer->addr = addr;
+    xfer->tx = tx;
+    xfer->tx_len = tx_len;
+    xfer->rx = rx;
+    xfer->rx_len = rx_len;
+    xfer->callback = callback;
+    xfer->user_data = user_data;
+    xfer->status = I2C_ASYNC_IDLE;
+    xfer->abort_reason = 0;
+}
+
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_xfer_t *xfer) {
+    uint idx = i2c_get_index(i2c);
+    i2c_async_ctx_t *c = &ctx[idx];
+
+    uint32_t save = save_and_disable_interrupts();
+    if (!c->irq_ready) {
+        i2c_async_setup_irq(idx);
+    }
+    bool ok = i2c_async_engine_submit(&c->engine, xfer);
+    restore_interrupts(save);
+    return ok;
+}
+
+bool i2c_async_is_done(const i2c_async_xfer_t *xfer) {
+    i2c_async_status_t status = xfer->status;
+    return status == I2C_ASYNC_DONE || status == I2C_ASYNC_ERROR;
+}
+
+bool i2c_async_busy(i2c_inst_t *i2c) {
+    i2c_async_ctx_t *c = &ctx[i2c_get_index(i2c)];
+    return c->irq_ready && i2c_async_engine_busy(&c->engine);
+}
+
+int i2c_async_wait(i2c_async_xfer_t *xfer) {
+    while (!i2c_async_is_done(xfer)) {
+        tight_loop_contents();
+    }
+    if (xfer->status == I2C_ASYNC_ERROR) {
+        return PICO_ERROR_GENERIC;
+    }
+    return (int)(xfer->tx_len + xfer->rx_len);
+}
+
+int i2c_async_transfer_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *tx, size_t tx_len,
+                                uint8_t *rx, size_t rx_len) {
+    // same semantics as i2c_write_blocking(nostop=true) + i2c_read_blocking(),
+    // returns the number of bytes transferred or PICO_ERROR_GENERIC
+    i2c_async_xfer_t xfer;
+    i2c_async_xfer_init(&xfer, addr, tx, tx_len, rx, rx_len, NULL, NULL);
+    if (!i2c_async_submit(i2c, &xfer)) {
+        return PICO_ERROR_GENERIC;
+    }
+    return i2c_async_wait(&xfer);
+}
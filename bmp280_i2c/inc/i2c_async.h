@@ -0,0 +1,38 @@
+#ifndef I2C_ASYNC_H
+#define I2C_ASYNC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+#include "i2c_async_engine.h"
+
+ /* Interrupt-driven I2C transaction engine
+
+    Transfers are queued per controller and executed by the I2C IRQ, which
+    keeps the TX FIFO fed with write/read commands and drains the RX FIFO as
+    bytes arrive. The CPU is only involved for a few cycles per FIFO event, so
+    a register burst read completes while the main loop does other work.
+
+    A transfer is an optional write phase (typically the register address)
+    followed by an optional read phase issued with a repeated start, which is
+    exactly the i2c_write_blocking(nostop=true) + i2c_read_blocking() pattern.
+
+    Transfer structs are owned by the caller and must stay valid until the
+    transfer completes (status is I2C_ASYNC_DONE or I2C_ASYNC_ERROR).
+
+    The queue itself lives in i2c_async_engine.c; i2c_async.c only binds it to
+    the i2c0/i2c1 registers and their IRQs.
+ */
+
+// Funções da biblioteca
+void i2c_async_xfer_init(i2c_async_xfer_t *xfer, uint8_t addr, const uint8_t *tx, size_t tx_len,
+                         uint8_t *rx, size_t rx_len, i2c_async_callback_t callback, void *user_data);
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_xfer_t *xfer);
+bool i2c_async_is_done(const i2c_async_xfer_t *xfer);
+bool i2c_async_busy(i2c_inst_t *i2c);
+int i2c_async_wait(i2c_async_xfer_t *xfer);
+int i2c_async_transfer_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *tx, size_t tx_len,
+                                uint8_t *rx, size_t rx_len);
+
+#endif
@@ -0,0 +1,147 @@
+#include "i2c_async_engine.h"
+
+#define I2C_ASYNC_BASE_MASK (I2C_ASYNC_EV_RX_FULL | I2C_ASYNC_EV_TX_ABRT | I2C_ASYNC_EV_STOP_DET)
+
+// pushes as many write/read commands as the FIFOs allow; returns true if
+// there are still commands left that are waiting for TX FIFO space
+static bool i2c_async_feed(i2c_async_engine_t *e) {
+    i2c_async_xfer_t *xfer = e->active;
+    size_t total = xfer->tx_len + xfer->rx_len;
+
+    while (e->cmd_idx < total && e->ops->tx_level(e->bus) < I2C_ASYNC_FIFO_DEPTH) {
+        uint32_t cmd;
+        if (e->cmd_idx < xfer->tx_len) {
+            cmd = xfer->tx[e->cmd_idx];
+        } else {
+            // never have more reads in flight than the RX FIFO can hold,
+            // the RX_FULL interrupt resumes feeding once bytes are drained
+            if (e->cmd_idx - xfer->tx_len - e->rx_idx >= I2C_ASYNC_FIFO_DEPTH) {
+                return false;
+            }
+            cmd = I2C_ASYNC_CMD_READ;
+            if (e->cmd_idx == xfer->tx_len && xfer->tx_len > 0) {
+                cmd |= I2C_ASYNC_CMD_RESTART;  // repeated start between write and read phases
+            }
+        }
+        if (e->cmd_idx == total - 1) {
+            cmd |= I2C_ASYNC_CMD_STOP;  // last command releases the bus
+        }
+        e->ops->write_cmd(e->bus, cmd);
+        e->cmd_idx++;
+    }
+    return e->cmd_idx < total;
+}
+
+static void i2c_async_drain(i2c_async_engine_t *e) {
+    i2c_async_xfer_t *xfer = e->active;
+    while (e->ops->rx_level(e->bus) && e->rx_idx < xfer->rx_len) {
+        xfer->rx[e->rx_idx++] = e->ops->read_data(e->bus);
+    }
+}
+
+static void i2c_async_start_next(i2c_async_engine_t *e) {
+    if (e->count == 0) {
+        e->active = NULL;
+        e->ops->set_irq_mask(e->bus, 0);
+        return;
+    }
+
+    i2c_async_xfer_t *xfer = e->queue[e->head];
+    e->head = (uint8_t)((e->head + 1) % I2C_ASYNC_QUEUE_LEN);
+    e->count--;
+
+    e->active = xfer;
+    e->cmd_idx = 0;
+    e->rx_idx = 0;
+    xfer->status = I2C_ASYNC_BUSY;
+
+    e->ops->set_target(e->bus, xfer->addr);
+
+    bool more = i2c_async_feed(e);
+    e->ops->set_irq_mask(e->bus, I2C_ASYNC_BASE_MASK | (more ? I2C_ASYNC_EV_TX_EMPTY : 0));
+}
+
+static void i2c_async_finish(i2c_async_engine_t *e, i2c_async_status_t status) {
+    i2c_async_xfer_t *xfer = e->active;
+
+    // the owner may release the struct as soon as status changes, so grab
+    // everything needed for the callback first
+    i2c_async_callback_t callback = xfer->callback;
+    void *user_data = xfer->user_data;
+
+    e->active = NULL;
+    xfer->status = status;
+    if (callback) {
+        callback(xfer, user_data);
+    }
+    if (!e->active) {
+        i2c_async_start_next(e);
+    }
+}
+
+void i2c_async_engine_init(i2c_async_engine_t *e, const i2c_async_bus_ops_t *ops, void *bus) {
+    e->ops = ops;
+    e->bus = bus;
+    e->head = 0;
+    e->count = 0;
+    e->active = NULL;
+    e->cmd_idx = 0;
+    e->rx_idx = 0;
+}
+
+bool i2c_async_engine_submit(i2c_async_engine_t *e, i2c_async_xfer_t *xfer) {
+    if (xfer->tx_len + xfer->rx_len == 0) {
+        return false;
+    }
+    if (e->count == I2C_ASYNC_QUEUE_LEN) {
+        return false;  // queue full
+    }
+
+    xfer->status = I2C_ASYNC_PENDING;
+    xfer->abort_reason = 0;
+    e->queue[(e->head + e->count) % I2C_ASYNC_QUEUE_LEN] = xfer;
+    e->count++;
+
+    if (!e->active) {
+        i2c_async_start_next(e);
+    }
+    return true;
+}
+
+void i2c_async_engine_irq(i2c_async_engine_t *e) {
+    uint32_t stat = e->ops->irq_status(e->bus);
+
+    i2c_async_xfer_t *xfer = e->active;
+    if (!xfer) {
+        e->ops->set_irq_mask(e->bus, 0);
+        return;
+    }
+
+    if (stat & I2C_ASYNC_EV_TX_ABRT) {
+        xfer->abort_reason = e->ops->take_abort(e->bus);
+        while (e->ops->rx_level(e->bus)) {
+            (void)e->ops->read_data(e->bus);
+        }
+        i2c_async_finish(e, I2C_ASYNC_ERROR);
+        return;
+    }
+
+    i2c_async_drain(e);
+    if (e->cmd_idx < xfer->tx_len + xfer->rx_len) {
+        bool more = i2c_async_feed(e);
+        e->ops->set_irq_mask(e->bus, I2C_ASYNC_BASE_MASK | (more ? I2C_ASYNC_EV_TX_EMPTY : 0));
+    } else {
+        e->ops->set_irq_mask(e->bus, I2C_ASYNC_BASE_MASK);
+    }
+
+    if (stat & I2C_ASYNC_EV_STOP_DET) {
+        e->ops->clear_stop(e->bus);
+        if (e->rx_idx == xfer->rx_len) {
+            i2c_async_finish(e, I2C_ASYNC_DONE);
+        }
+    }
+}
+
+bool i2c_async_engine_busy(const i2c_async_engine_t *e) {
+    return e->active != NULL || e->count > 0;
+}
@@ -0,0 +1,96 @@
+#ifndef I2C_ASYNC_ENGINE_H
+#define I2C_ASYNC_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+ /* Queue state machine of the I2C transaction engine
+
+    This part has no dependency on the Pico SDK: the controller is reached
+    only through i2c_async_bus_ops_t, so the same code runs against the
+    DW_apb_i2c registers (i2c_async.c) and against a fake bus on the host
+    (test/test_i2c_async.c).
+
+    Locking is up to the caller: i2c_async_engine_submit() must not race
+    with i2c_async_engine_irq() for the same engine.
+ */
+
+// maximum number of transfers queued per I2C controller
+#define I2C_ASYNC_QUEUE_LEN 8
+
+// depth of the controller TX and RX FIFOs (16 on the RP2040/RP2350)
+#define I2C_ASYNC_FIFO_DEPTH 16
+
+// command word pushed to the TX FIFO: data byte plus these flags
+// (same layout as IC_DATA_CMD so the hardware backend writes it as is)
+#define I2C_ASYNC_CMD_READ      (1u << 8)
+#define I2C_ASYNC_CMD_STOP      (1u << 9)
+#define I2C_ASYNC_CMD_RESTART   (1u << 10)
+
+// controller events (same layout as IC_INTR_STAT / IC_INTR_MASK)
+#define I2C_ASYNC_EV_RX_FULL    (1u << 2)
+#define I2C_ASYNC_EV_TX_EMPTY   (1u << 4)
+#define I2C_ASYNC_EV_TX_ABRT    (1u << 6)
+#define I2C_ASYNC_EV_STOP_DET   (1u << 9)
+
+typedef enum {
+    I2C_ASYNC_IDLE = 0,
+    I2C_ASYNC_PENDING,   // queued, waiting for the bus
+    I2C_ASYNC_BUSY,      // being executed by the IRQ
+    I2C_ASYNC_DONE,      // finished successfully
+    I2C_ASYNC_ERROR,     // aborted (NACK, arbitration lost...)
+} i2c_async_status_t;
+
+typedef struct i2c_async_xfer i2c_async_xfer_t;
+
+// called from IRQ context once the transfer has finished (successfully or not)
+typedef void (*i2c_async_callback_t)(i2c_async_xfer_t *xfer, void *user_data);
+
+struct i2c_async_xfer {
+    uint8_t addr;
+    const uint8_t *tx;
+    size_t tx_len;
+    uint8_t *rx;
+    size_t rx_len;
+    i2c_async_callback_t callback;
+    void *user_data;
+
+    // filled in by the engine
+    volatile i2c_async_status_t status;
+    uint32_t abort_reason;   // copy of IC_TX_ABRT_SOURCE when status is I2C_ASYNC_ERROR
+};
+
+// register access of one controller
+typedef struct {
+    void (*set_target)(void *bus, uint8_t addr);     // also clears stale abort/stop flags
+    uint32_t (*tx_level)(void *bus);                 // commands waiting in the TX FIFO
+    uint32_t (*rx_level)(void *bus);                 // bytes waiting in the RX FIFO
+    void (*write_cmd)(void *bus, uint32_t cmd);
+    uint8_t (*read_data)(void *bus);
+    uint32_t (*irq_status)(void *bus);               // I2C_ASYNC_EV_* pending
+    void (*set_irq_mask)(void *bus, uint32_t mask);  // I2C_ASYNC_EV_* enabled
+    uint32_t (*take_abort)(void *bus);               // abort source, clears TX_ABRT
+    void (*clear_stop)(void *bus);
+} i2c_async_bus_ops_t;
+
+// per-controller queue and progress of the active transfer
+typedef struct {
+    const i2c_async_bus_ops_t *ops;
+    void *bus;
+
+    i2c_async_xfer_t *queue[I2C_ASYNC_QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+    i2c_async_xfer_t *volatile active;
+    size_t cmd_idx;   // commands already pushed into the TX FIFO
+    size_t rx_idx;    // bytes already taken from the RX FIFO
+} i2c_async_engine_t;
+
+// Funções da biblioteca
+void i2c_async_engine_init(i2c_async_engine_t *e, const i2c_async_bus_ops_t *ops, void *bus);
+bool i2c_async_engine_submit(i2c_async_engine_t *e, i2c_async_xfer_t *xfer);
+void i2c_async_engine_irq(i2c_async_engine_t *e);
+bool i2c_async_engine_busy(const i2c_async_engine_t *e);
+
+#endif
@@ -0,0 +1,94 @@
+/* Host benchmark of the BMP280 compensation paths: separate temperature and
+   pressao conversions (t_fine computed twice, as bmp280_convert_temp() +
+   bmp280_convert_pressao() do), the fused bmp280_compensate() path and the
+   bmp280_comp_batch() loop. Prints time, cycles and throughput per sample,
+   plus the pressao error against the double precision datasheet formula;
+   built once per BMP280_PRECISION to pick the formula per deployment. */
+
+#include <stdio.h>
+#include "bmp280_compensation.h"
+#include "bench_timer.h"
+#include "bmp280_reference.h"
+
+#define N_SAMPLES 4096
+#define ROUNDS 200
+
+static struct bmp280_sample raw[N_SAMPLES];
+static struct bmp280_sample out[N_SAMPLES];
+static struct bmp280_calib_param calib;
+static struct bmp280_comp_param comp;
+
+static void run_separate(void) {
+    for (int i = 0; i < N_SAMPLES; i++) {
+        out[i].temp = bmp280_comp_temp(bmp280_comp_t_fine(&comp, raw[i].temp));
+        out[i].pressao = bmp280_comp_pressao(&comp, raw[i].pressao, bmp280_comp_t_fine(&comp, raw[i].temp));
+    }
+}
+
+static void run_fused(void) {
+    for (int i = 0; i < N_SAMPLES; i++) {
+        int32_t t_fine = bmp280_comp_t_fine(&comp, raw[i].temp);
+        out[i].temp = bmp280_comp_temp(t_fine);
+        out[i].pressao = bmp280_comp_pressao(&comp, raw[i].pressao, t_fine);
+    }
+}
+
+static void run_batch(void) {
+    bmp280_comp_batch(&comp, raw, out, N_SAMPLES);
+}
+
+static void measure(const char *name, void (*run)(void)) {
+    // best of ROUNDS, so scheduler noise does not inflate the result
+    uint64_t best_ns = UINT64_MAX, best_cyc = UINT64_MAX;
+    for (int r = 0; r < ROUNDS; r++) {
+        uint64_t c0 = bench_cycles(), t0 = bench_ns();
+        run();
+        uint64_t t1 = bench_ns(), c1 = bench_cycles();
+        if (t1 - t0 < best_ns) best_ns = t1 - t0;
+        if (c1 - c0 < best_cyc) best_cyc = c1 - c0;
+        bench_sink += (uint32_t)out[r % N_SAMPLES].pressao;
+    }
+    printf("%-10s %8.2f ns/amostra %8.1f ciclos/amostra %8.1f Mamostras/s\n", name,
+           (double)best_ns / N_SAMPLES, (double)best_cyc / N_SAMPLES, 1000.0 * N_SAMPLES / (double)best_ns);
+}
+
+static void accuracy(void) {
+    // error of the Pa * 256 output, which keeps the fraction of the 64-bit
+    // and float formulas
+    double worst = 0, sum = 0;
+    for (int i = 0; i < N_SAMPLES; i++) {
+        int32_t t_fine = bmp280_comp_t_fine(&comp, raw[i].temp);
+        double ref = bmp280_reference_pressao(&calib, t_fine, raw[i].pressao);
+        double got = bmp280_comp_pressao_q8(&comp, raw[i].pressao, t_fine) / 256.0;
+        double err = got > ref ? got - ref : ref - got;
+        sum += err;
+        if (err > worst) {
+            worst = err;
+        }
+    }
+    printf("erro de pressao: medio %.4f Pa, maximo %.4f Pa\n", sum / N_SAMPLES, worst);
+}
+
+int main(void) {
+    // datasheet calibration (section 3.12)
+    calib = (struct bmp280_calib_param){
+        27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+    };
+    bmp280_comp_init(&comp, &calib);
+
+    // raw values spread over roughly -20..60 C and 300..1100 hPa
+    uint32_t seed = 12345;
+    for (int i = 0; i < N_SAMPLES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        raw[i].temp = 440000 + (int32_t)(seed >> 8) % 160000;
+        seed = seed * 1664525u + 1013904223u;
+        raw[i].pressao = 250000 + (int32_t)(seed >> 8) % 300000;
+    }
+
+    printf("BMP280_PRECISION=%d, %d amostras, melhor de %d rodadas\n", BMP280_PRECISION, N_SAMPLES, ROUNDS);
+    measure("separado", run_separate);
+    measure("fundido", run_fused);
+    measure("lote", run_batch);
+    accuracy();
+    return 0;
+}
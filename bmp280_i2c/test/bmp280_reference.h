@@ -0,0 +1,26 @@
+#ifndef BMP280_REFERENCE_H
+#define BMP280_REFERENCE_H
+
+#include "bmp280_compensation.h"
+
+ /* Datasheet floating point pressao formula evaluated in double straight
+    from the register values, the accuracy reference for the host test and
+    benchmark. Takes the same integer t_fine every implementation receives,
+    so only the pressao formula is compared.
+ */
+static inline double bmp280_reference_pressao(const struct bmp280_calib_param *calib, int32_t t_fine, int32_t raw_press) {
+    double var1, var2;
+    var1 = t_fine / 2.0 - 64000.0;
+    var2 = var1 * var1 * calib->dig_p6 / 32768.0;
+    var2 = var2 + var1 * calib->dig_p5 * 2.0;
+    var2 = var2 / 4.0 + calib->dig_p4 * 65536.0;
+    var1 = (calib->dig_p3 * var1 * var1 / 524288.0 + calib->dig_p2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * calib->dig_p1;
+    double p = 1048576.0 - raw_press;
+    p = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = calib->dig_p9 * p * p / 2147483648.0;
+    var2 = p * calib->dig_p8 / 32768.0;
+    return p + (var1 + var2 + calib->dig_p7) / 16.0;
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include <string.h>
+#include "fake_i2c_bus.h"
+
+// TX_EMPTY fires at or below this level, same value i2c_async.c programs into IC_TX_TL
+#define FAKE_TX_TL (I2C_ASYNC_FIFO_DEPTH / 4)
+
+static void fake_set_target(void *b, uint8_t addr) {
+    fake_i2c_bus_t *bus = b;
+    if (bus->tx_count || bus->in_transfer) {
+        bus->target_changed_busy++;
+    }
+    bus->target = addr;
+    bus->abort_pending = false;
+    bus->stop_pending = false;
+}
+
+static uint32_t fake_tx_level(void *b) { return ((fake_i2c_bus_t *)b)->tx_count; }
+static uint32_t fake_rx_level(void *b) { return ((fake_i2c_bus_t *)b)->rx_count; }
+
+static void fake_write_cmd(void *b, uint32_t cmd) {
+    fake_i2c_bus_t *bus = b;
+    if (bus->tx_count == I2C_ASYNC_FIFO_DEPTH) {
+        bus->tx_overflow++;
+        return;
+    }
+    bus->tx_fifo[bus->tx_count++] = cmd;
+    fake_i2c_step(bus, bus->cmds_per_write);
+}
+
+static uint8_t fake_read_data(void *b) {
+    fake_i2c_bus_t *bus = b;
+    if (!bus->rx_count) {
+        return 0;
+    }
+    uint8_t v = bus->rx_fifo[bus->rx_head];
+    bus->rx_head = (bus->rx_head + 1) % I2C_ASYNC_FIFO_DEPTH;
+    bus->rx_count--;
+    return v;
+}
+
+static uint32_t fake_raw_status(fake_i2c_bus_t *bus) {
+    uint32_t stat = 0;
+    if (bus->rx_count) stat |= I2C_ASYNC_EV_RX_FULL;
+    if (bus->tx_count <= FAKE_TX_TL) stat |= I2C_ASYNC_EV_TX_EMPTY;
+    if (bus->abort_pending) stat |= I2C_ASYNC_EV_TX_ABRT;
+    if (bus->stop_pending) stat |= I2C_ASYNC_EV_STOP_DET;
+    return stat;
+}
+
+static uint32_t fake_irq_status(void *b) {
+    fake_i2c_bus_t *bus = b;
+    return fake_raw_status(bus) & bus->irq_mask;
+}
+
+static void fake_set_irq_mask(void *b, uint32_t mask) { ((fake_i2c_bus_t *)b)->irq_mask = mask; }
+
+static uint32_t fake_take_abort(void *b) {
+    fake_i2c_bus_t *bus = b;
+    bus->abort_pending = false;
+    return 1;   // ABRT_7B_ADDR_NOACK
+}
+
+static void fake_clear_stop(void *b) { ((fake_i2c_bus_t *)b)->stop_pending = false; }
+
+const i2c_async_bus_ops_t fake_i2c_ops = {
+    .set_target = fake_set_target,
+    .tx_level = fake_tx_level,
+    .rx_level = fake_rx_level,
+    .write_cmd = fake_write_cmd,
+    .read_data = fake_read_data,
+    .irq_status = fake_irq_status,
+    .set_irq_mask = fake_set_irq_mask,
+    .take_abort = fake_take_abort,
+    .clear_stop = fake_clear_stop,
+};
+
+void fake_i2c_init(fake_i2c_bus_t *bus, uint8_t dev_addr) {
+    memset(bus, 0, sizeof(*bus));
+    bus->dev_addr = dev_addr;
+    for (int i = 0; i < 256; i++) {
+        bus->mem[i] = (uint8_t)(i ^ 0x5A);
+    }
+}
+
+void fake_i2c_step(fake_i2c_bus_t *bus, uint32_t n) {
+    while (n-- && bus->tx_count) {
+        uint32_t cmd = bus->tx_fifo[0];
+        memmove(bus->tx_fifo, bus->tx_fifo + 1, --bus->tx_count * sizeof(bus->tx_fifo[0]));
+
+        if (!bus->in_transfer || (cmd & I2C_ASYNC_CMD_RESTART)) {
+            if (bus->in_transfer) {
+                bus->restarts++;
+            } else {
+                bus->starts++;
+            }
+            bus->in_transfer = true;
+            bus->first_write = true;
+
+            // address phase: nobody answers, the controller aborts and flushes
+            if (bus->target != bus->dev_addr) {
+                bus->tx_count = 0;
+                bus->in_transfer = false;
+                bus->abort_pending = true;
+                bus->stop_pending = true;
+                bus->stops++;
+                return;
+            }
+        }
+
+        if (cmd & I2C_ASYNC_CMD_READ) {
+            if (bus->rx_count == I2C_ASYNC_FIFO_DEPTH) {
+                bus->rx_overflow++;
+            } else {
+                bus->rx_fifo[(bus->rx_head + bus->rx_count) % I2C_ASYNC_FIFO_DEPTH] = bus->mem[bus->reg_ptr++];
+                bus->rx_count++;
+            }
+        } else if (bus->first_write) {
+            bus->reg_ptr = (uint8_t)cmd;
+            bus->first_write = false;
+        } else {
+            bus->mem[bus->reg_ptr++] = (uint8_t)cmd;
+        }
+
+        if (cmd & I2C_ASYNC_CMD_STOP) {
+            bus->in_transfer = false;
+            bus->stop_pending = true;
+            bus->stops++;
+        }
+    }
+}
+
+bool fake_i2c_irq_pending(fake_i2c_bus_t *bus) {
+    return (fake_raw_status(bus) & bus->irq_mask) != 0;
+}
+
+void fake_i2c_run(fake_i2c_bus_t *bus, i2c_async_engine_t *e, uint32_t cmds_per_irq) {
+    // alternate "wire time" and IRQ entries until the queue is empty
+    for (int guard = 0; guard < 100000 && i2c_async_engine_busy(e); guard++) {
+        fake_i2c_step(bus, cmds_per_irq);
+        if (fake_i2c_irq_pending(bus)) {
+            i2c_async_engine_irq(e);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef FAKE_I2C_BUS_H
+#define FAKE_I2C_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "i2c_async_engine.h"
+
+ /* Host-side model of one DW_apb_i2c controller with a single register
+    mapped device behind it (auto-incrementing register pointer, like the
+    BMP280), driven through i2c_async_bus_ops_t.
+
+    fake_i2c_step() executes up to n queued commands on the "wire", so a test
+    can make the bus as slow as it likes relative to the IRQ handler. With
+    cmds_per_write the wire also keeps running while the handler is pushing
+    commands, as it does on the real controller.
+ */
+
+typedef struct {
+    // device on the bus
+    uint8_t dev_addr;
+    uint8_t mem[256];
+    uint8_t reg_ptr;
+    bool first_write;   // next written byte after a (re)start is the register
+
+    // controller
+    uint8_t target;
+    uint32_t tx_fifo[I2C_ASYNC_FIFO_DEPTH];
+    uint32_t tx_count;
+    uint8_t rx_fifo[I2C_ASYNC_FIFO_DEPTH];
+    uint32_t rx_head, rx_count;
+    uint32_t irq_mask;
+    bool abort_pending, stop_pending;
+    bool in_transfer;
+    uint32_t cmds_per_write;   // commands executed while the IRQ is still feeding the FIFO
+
+    // protocol violations seen by the model, must stay 0
+    uint32_t tx_overflow;
+    uint32_t rx_overflow;
+    uint32_t target_changed_busy;
+
+    // statistics
+    uint32_t starts, restarts, stops;
+} fake_i2c_bus_t;
+
+extern const i2c_async_bus_ops_t fake_i2c_ops;
+
+void fake_i2c_init(fake_i2c_bus_t *bus, uint8_t dev_addr);
+void fake_i2c_step(fake_i2c_bus_t *bus, uint32_t n);
+bool fake_i2c_irq_pending(fake_i2c_bus_t *bus);
+void fake_i2c_run(fake_i2c_bus_t *bus, i2c_async_engine_t *e, uint32_t cmds_per_irq);
+
+#endif
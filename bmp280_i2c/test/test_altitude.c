@@ -0,0 +1,126 @@
+/* Host test of the altitude/vertical speed estimator (bmp280_altitude.c):
+   the lookup table against the barometric formula, then a replay of a
+   pressao trace of a climb, hover and descent sampled like the example
+   (integer Pa with sensor noise) through the alpha-beta filter. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bmp280_altitude.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+    } while (0)
+
+static double formula_altitude_m(double p, double p0) {
+    return 44330.0 * (1.0 - pow(p / p0, 1.0 / 5.255));
+}
+
+static double formula_pressao_pa(double h, double p0) {
+    return p0 * pow(1.0 - h / 44330.0, 5.255);
+}
+
+static void test_table(void) {
+    bmp280_altimeter_t alt;
+    bmp280_altimeter_init(&alt, BMP280_SEA_LEVEL_PA, BMP280_ALT_ALPHA_DEFAULT, BMP280_ALT_BETA_DEFAULT);
+
+    // whole table range, in 1 Pa / 4 steps
+    double worst = 0, worst_near = 0;
+    for (uint32_t q8 = 51000u << 8; q8 <= 113000u << 8; q8 += 64) {
+        double exact = formula_altitude_m(q8 / 256.0, BMP280_SEA_LEVEL_PA) * 1000.0;
+        double err = fabs(bmp280_altitude_mm(&alt, q8) - exact);
+        if (err > worst) worst = err;
+        if (fabs(exact) < 1000000.0 && err > worst_near) worst_near = err;
+    }
+    printf("tabela: erro maximo %.1f mm (%.1f mm abaixo de 1000 m)\n", worst, worst_near);
+    CHECK(worst_near < 20.0);   // 2 cm near the reference level, as documented
+    CHECK(worst < 100.0);
+
+    // outside the table the result saturates instead of wrapping
+    CHECK(bmp280_altitude_mm(&alt, 20000u << 8) == bmp280_altitude_mm(&alt, 50000u << 8));
+    CHECK(bmp280_altitude_mm(&alt, 130000u << 8) == bmp280_altitude_mm(&alt, 115000u << 8));
+    CHECK(bmp280_altitude_mm(&alt, 101325u << 8) == 0);
+
+    // a different reference pressao moves the zero
+    bmp280_altimeter_set_reference(&alt, 95000u << 8);
+    CHECK(abs(bmp280_altitude_mm(&alt, 95000u << 8)) <= 1);
+}
+
+// altitude profile: 5 s on the ground, climb at 3 m/s for 20 s, hover for
+// 10 s, descend at 2 m/s for 15 s
+static double profile_m(double t, double *vz) {
+    if (t < 5.0) { *vz = 0; return 100.0; }
+    if (t < 25.0) { *vz = 3.0; return 100.0 + 3.0 * (t - 5.0); }
+    if (t < 35.0) { *vz = 0; return 160.0; }
+    if (t < 50.0) { *vz = -2.0; return 160.0 - 2.0 * (t - 35.0); }
+    *vz = 0;
+    return 130.0;
+}
+
+static void test_replay(void) {
+    bmp280_altimeter_t alt;
+    bmp280_altimeter_init(&alt, BMP280_SEA_LEVEL_PA, BMP280_ALT_ALPHA_DEFAULT, BMP280_ALT_BETA_DEFAULT);
+
+    // 10 Hz, +-2 Pa of uniform noise (about +-17 cm), rounded to whole Pa
+    // as bmp280_compensate() returns it
+    srand(7);
+    double worst_alt_climb = 0, worst_vz_climb = 0, worst_alt_hover = 0;
+    uint64_t t_us = 1000000;
+    for (int i = 0; i <= 600; i++, t_us += 100000) {
+        double t = i / 10.0, vz;
+        double h = profile_m(t, &vz);
+        double noise = ((rand() % 4001) - 2000) / 1000.0;
+        int32_t pressao = (int32_t)lround(formula_pressao_pa(h, BMP280_SEA_LEVEL_PA) + noise);
+
+        bmp280_altimeter_update(&alt, pressao, t_us);
+
+        double alt_err = fabs(alt.altitude_mm / 1000.0 - h);
+        double vz_err = fabs(alt.vspeed_mm_s / 1000.0 - vz);
+        if (t > 12.0 && t < 25.0) {
+            // settled into the climb
+            if (alt_err > worst_alt_climb) worst_alt_climb = alt_err;
+            if (vz_err > worst_vz_climb) worst_vz_climb = vz_err;
+        }
+        if (t > 31.0 && t < 35.0 && alt_err > worst_alt_hover) {
+            worst_alt_hover = alt_err;
+        }
+    }
+    printf("replay: subida erro %.2f m / %.2f m/s, pairando erro %.2f m\n",
+           worst_alt_climb, worst_vz_climb, worst_alt_hover);
+    CHECK(worst_alt_climb < 0.3);
+    CHECK(worst_vz_climb < 0.3);
+    CHECK(worst_alt_hover < 0.3);
+    CHECK(fabs(alt.altitude_mm / 1000.0 - 130.0) < 0.5);
+    CHECK(abs(alt.vspeed_mm_s) < 300);
+}
+
+static void test_clock(void) {
+    // first sample latches, a timestamp that does not move keeps the speed
+    bmp280_altimeter_t alt;
+    bmp280_altimeter_init(&alt, BMP280_SEA_LEVEL_PA, BMP280_ALT_ALPHA_DEFAULT, BMP280_ALT_BETA_DEFAULT);
+    bmp280_altimeter_update(&alt, 100000, 5000000);
+    CHECK(alt.primed && alt.vspeed_mm_s == 0);
+    int32_t first = alt.altitude_mm;
+    CHECK(abs(first - (int32_t)lround(formula_altitude_m(100000, BMP280_SEA_LEVEL_PA) * 1000.0)) < 20);
+
+    bmp280_altimeter_update(&alt, 99990, 5100000);
+    int32_t vz = alt.vspeed_mm_s;
+    CHECK(vz > 0);   // lower pressao, going up
+    bmp280_altimeter_update(&alt, 99980, 5100000);
+    CHECK(alt.vspeed_mm_s == vz);
+}
+
+int main(void) {
+    test_table();
+    test_replay();
+    test_clock();
+
+    if (failures) {
+        printf("test_altitude: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_altitude: ok\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+/* Host golden-vector test of the BMP280 compensation (bmp280_compensation.c),
+   built once per BMP280_PRECISION.
+
+   The calibration dump and the data frame below are the datasheet example
+   (section 3.12) laid out exactly as they come out of registers 0x88..0x9F
+   and 0xF7..0xFC, so the parse helpers used by the driver are covered too.
+   A sweep over the raw range then checks the selected formula against a
+   double precision evaluation of the datasheet floating point formula. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bmp280_compensation.h"
+#include "bmp280_reference.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+    } while (0)
+
+static const uint8_t calib_dump[24] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC,   // dig_t1..3 = 27504, 26435, -1000
+    0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,   // dig_p1..3 = 36477, -10685, 3024
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF,   // dig_p4..6 = 2855, 140, -7
+    0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17,   // dig_p7..9 = 15500, -14600, 6000
+};
+
+// raw pressao 415148, raw temperature 519888
+static const uint8_t data_frame[6] = { 0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00 };
+
+// expected results per implementation (pressao as Pa * 256). t_fine,
+// temperature and the 32-bit pressao are the datasheet values. The
+// datasheet quotes 100653.27 Pa for the other two, worked out with the
+// fractional t_fine; fed the integer t_fine, as in the driver, both give
+// 100653.26 Pa, and the 64-bit value is pinned bit exact against regressions
+#define GOLDEN_T_FINE 128422
+#define GOLDEN_TEMP 2508
+#if BMP280_PRECISION == BMP280_PRECISION_32
+#define GOLDEN_PRESSAO_Q8 (100656u << 8)
+#define GOLDEN_Q8_TOL 0
+#define SWEEP_TOL_PA 8.0      // ~5.7 Pa worst case at the range corners
+#elif BMP280_PRECISION == BMP280_PRECISION_64
+#define GOLDEN_PRESSAO_Q8 25767233u
+#define GOLDEN_Q8_TOL 0
+#define SWEEP_TOL_PA 0.02
+#else
+#define GOLDEN_PRESSAO_Q8 25767233u
+#define GOLDEN_Q8_TOL 1
+#define SWEEP_TOL_PA 0.004    // rounding to Pa * 256
+#endif
+
+static struct bmp280_calib_param calib;
+static struct bmp280_comp_param comp;
+
+static void test_parse(void) {
+    bmp280_comp_parse_calib(calib_dump, &calib);
+    CHECK(calib.dig_t1 == 27504 && calib.dig_t2 == 26435 && calib.dig_t3 == -1000);
+    CHECK(calib.dig_p1 == 36477 && calib.dig_p2 == -10685 && calib.dig_p3 == 3024);
+    CHECK(calib.dig_p4 == 2855 && calib.dig_p5 == 140 && calib.dig_p6 == -7);
+    CHECK(calib.dig_p7 == 15500 && calib.dig_p8 == -14600 && calib.dig_p9 == 6000);
+
+    int32_t raw_temp, raw_press;
+    bmp280_comp_parse_raw(data_frame, &raw_temp, &raw_press);
+    CHECK(raw_temp == 519888);
+    CHECK(raw_press == 415148);
+}
+
+static void test_golden(void) {
+    bmp280_comp_init(&comp, &calib);
+
+    int32_t t_fine = bmp280_comp_t_fine(&comp, 519888);
+    CHECK(t_fine == GOLDEN_T_FINE);
+    CHECK(bmp280_comp_temp(t_fine) == GOLDEN_TEMP);
+
+    uint32_t q8 = bmp280_comp_pressao_q8(&comp, 415148, t_fine);
+    CHECK(labs((long)q8 - (long)GOLDEN_PRESSAO_Q8) <= GOLDEN_Q8_TOL);
+    CHECK(bmp280_comp_pressao(&comp, 415148, t_fine) == (int32_t)((GOLDEN_PRESSAO_Q8 + 128) >> 8));
+}
+
+static void test_sweep(void) {
+    // -40..85 C and 300..1100 hPa for the datasheet calibration
+    double worst = 0;
+    for (int32_t raw_temp = 315000; raw_temp <= 705000; raw_temp += 7500) {
+        int32_t t_fine = bmp280_comp_t_fine(&comp, raw_temp);
+        for (int32_t raw_press = 150000; raw_press <= 560000; raw_press += 2050) {
+            double ref = bmp280_reference_pressao(&calib, t_fine, raw_press);
+            if (ref < 30000.0 || ref > 110000.0) {
+                continue;
+            }
+            double got = bmp280_comp_pressao_q8(&comp, raw_press, t_fine) / 256.0;
+            double err = got > ref ? got - ref : ref - got;
+            if (err > worst) {
+                worst = err;
+            }
+        }
+    }
+    printf("BMP280_PRECISION=%d: maior erro na varredura %.4f Pa\n", BMP280_PRECISION, worst);
+    CHECK(worst <= SWEEP_TOL_PA);
+}
+
+static void test_fused_and_batch(void) {
+    // fused and batch results must match the separate conversions bit for bit
+    struct bmp280_sample raw[64], out[64], in_place[64];
+    for (int i = 0; i < 64; i++) {
+        raw[i].temp = 420000 + i * 3001;
+        raw[i].pressao = 260000 + i * 4507;
+    }
+    bmp280_comp_batch(&comp, raw, out, 64);
+    memcpy(in_place, raw, sizeof(raw));
+    bmp280_comp_batch(&comp, in_place, in_place, 64);
+
+    for (int i = 0; i < 64; i++) {
+        int32_t temp = bmp280_comp_temp(bmp280_comp_t_fine(&comp, raw[i].temp));
+        int32_t press = bmp280_comp_pressao(&comp, raw[i].pressao, bmp280_comp_t_fine(&comp, raw[i].temp));
+        CHECK(out[i].temp == temp && out[i].pressao == press);
+        CHECK(in_place[i].temp == temp && in_place[i].pressao == press);
+    }
+}
+
+int main(void) {
+    test_parse();
+    test_golden();
+    test_sweep();
+    test_fused_and_batch();
+
+    if (failures) {
+        printf("test_compensation: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_compensation: ok\n");
+    return 0;
+}
@@ -0,0 +1,199 @@
+/* Host unit test of the I2C transaction queue (i2c_async_engine.c) against
+   the fake controller in fake_i2c_bus.c */
+
+#include <stdio.h>
+#include <string.h>
+#include "i2c_async_engine.h"
+#include "fake_i2c_bus.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+    } while (0)
+
+#define DEV 0x76
+
+static fake_i2c_bus_t bus;
+static i2c_async_engine_t engine;
+
+static void setup(void) {
+    fake_i2c_init(&bus, DEV);
+    i2c_async_engine_init(&engine, &fake_i2c_ops, &bus);
+}
+
+static void check_bus_clean(void) {
+    CHECK(bus.tx_overflow == 0);
+    CHECK(bus.rx_overflow == 0);
+    CHECK(bus.target_changed_busy == 0);
+    CHECK(!bus.in_transfer);
+    CHECK(bus.irq_mask == 0);   // interrupts off once the queue is empty
+}
+
+// records the completion order
+static i2c_async_xfer_t *completed[16];
+static int n_completed;
+
+static void on_done(i2c_async_xfer_t *xfer, void *user_data) {
+    (void)user_data;
+    completed[n_completed++] = xfer;
+}
+
+static void test_burst_read(uint32_t cmds_per_irq) {
+    // the BMP280 data burst: write 0xF7, repeated start, read 6 bytes
+    setup();
+    n_completed = 0;
+    uint8_t reg = 0xF7, buf[6] = { 0 };
+    i2c_async_xfer_t x;
+    i2c_async_xfer_t *xp = &x;
+    memset(&x, 0, sizeof(x));
+    x.addr = DEV; x.tx = &reg; x.tx_len = 1; x.rx = buf; x.rx_len = 6; x.callback = on_done;
+
+    CHECK(i2c_async_engine_submit(&engine, &x));
+    CHECK(x.status == I2C_ASYNC_BUSY);
+    fake_i2c_run(&bus, &engine, cmds_per_irq);
+
+    CHECK(x.status == I2C_ASYNC_DONE);
+    CHECK(n_completed == 1 && completed[0] == xp);
+    for (int i = 0; i < 6; i++) {
+        CHECK(buf[i] == bus.mem[0xF7 + i]);
+    }
+    CHECK(bus.starts == 1 && bus.restarts == 1 && bus.stops == 1);
+    check_bus_clean();
+}
+
+static void test_long_read(uint32_t cmds_per_irq, uint32_t cmds_per_write) {
+    // longer than both FIFOs: reads must be throttled so the RX FIFO never
+    // overflows, also when bytes keep arriving while the IRQ feeds commands
+    setup();
+    bus.cmds_per_write = cmds_per_write;
+    uint8_t reg = 0x10, buf[100];
+    i2c_async_xfer_t x;
+    memset(&x, 0, sizeof(x));
+    x.addr = DEV; x.tx = &reg; x.tx_len = 1; x.rx = buf; x.rx_len = sizeof(buf);
+
+    CHECK(i2c_async_engine_submit(&engine, &x));
+    fake_i2c_run(&bus, &engine, cmds_per_irq);
+
+    CHECK(x.status == I2C_ASYNC_DONE);
+    CHECK(memcmp(buf, &bus.mem[0x10], sizeof(buf)) == 0);
+    check_bus_clean();
+}
+
+static void test_write_only(void) {
+    setup();
+    uint8_t cmd[3] = { 0xF4, 0x27, 0xA0 };
+    i2c_async_xfer_t x;
+    memset(&x, 0, sizeof(x));
+    x.addr = DEV; x.tx = cmd; x.tx_len = 3;
+
+    CHECK(i2c_async_engine_submit(&engine, &x));
+    fake_i2c_run(&bus, &engine, 1);
+
+    CHECK(x.status == I2C_ASYNC_DONE);
+    CHECK(bus.mem[0xF4] == 0x27 && bus.mem[0xF5] == 0xA0);
+    CHECK(bus.restarts == 0 && bus.stops == 1);
+    check_bus_clean();
+}
+
+static void test_queue_order_and_nack(void) {
+    // three transfers queued back to back, the middle one to an absent device
+    setup();
+    n_completed = 0;
+    uint8_t reg = 0x88, a[4], b[4], c[24];
+    i2c_async_xfer_t x[3];
+    memset(x, 0, sizeof(x));
+    x[0].addr = DEV; x[0].tx = &reg; x[0].tx_len = 1; x[0].rx = a; x[0].rx_len = 4; x[0].callback = on_done;
+    x[1].addr = 0x77; x[1].tx = &reg; x[1].tx_len = 1; x[1].rx = b; x[1].rx_len = 4; x[1].callback = on_done;
+    x[2].addr = DEV; x[2].tx = &reg; x[2].tx_len = 1; x[2].rx = c; x[2].rx_len = 24; x[2].callback = on_done;
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(i2c_async_engine_submit(&engine, &x[i]));
+    }
+    CHECK(x[0].status == I2C_ASYNC_BUSY);
+    CHECK(x[1].status == I2C_ASYNC_PENDING && x[2].status == I2C_ASYNC_PENDING);
+    fake_i2c_run(&bus, &engine, 2);
+
+    CHECK(n_completed == 3);
+    CHECK(completed[0] == &x[0] && completed[1] == &x[1] && completed[2] == &x[2]);
+    CHECK(x[0].status == I2C_ASYNC_DONE);
+    CHECK(x[1].status == I2C_ASYNC_ERROR && x[1].abort_reason != 0);
+    CHECK(x[2].status == I2C_ASYNC_DONE);
+    CHECK(memcmp(c, &bus.mem[0x88], sizeof(c)) == 0);
+    check_bus_clean();
+}
+
+static void test_queue_full(void) {
+    // the bus never moves, so the first transfer stays active and the rest queue up
+    setup();
+    uint8_t reg = 0, buf[1];
+    i2c_async_xfer_t x[I2C_ASYNC_QUEUE_LEN + 2];
+    memset(x, 0, sizeof(x));
+    for (int i = 0; i < I2C_ASYNC_QUEUE_LEN + 2; i++) {
+        x[i].addr = DEV; x[i].tx = &reg; x[i].tx_len = 1; x[i].rx = buf; x[i].rx_len = 1;
+    }
+    for (int i = 0; i < I2C_ASYNC_QUEUE_LEN + 1; i++) {
+        CHECK(i2c_async_engine_submit(&engine, &x[i]));   // 1 active + QUEUE_LEN waiting
+    }
+    CHECK(!i2c_async_engine_submit(&engine, &x[I2C_ASYNC_QUEUE_LEN + 1]));
+    CHECK(x[I2C_ASYNC_QUEUE_LEN + 1].status == I2C_ASYNC_IDLE);
+
+    fake_i2c_run(&bus, &engine, 4);
+    for (int i = 0; i < I2C_ASYNC_QUEUE_LEN + 1; i++) {
+        CHECK(x[i].status == I2C_ASYNC_DONE);
+    }
+    check_bus_clean();
+
+    // empty transfers are rejected up front
+    i2c_async_xfer_t empty;
+    memset(&empty, 0, sizeof(empty));
+    CHECK(!i2c_async_engine_submit(&engine, &empty));
+}
+
+// a callback that queues the next read, like a sampling loop driven from the IRQ
+static i2c_async_xfer_t chain;
+static uint8_t chain_reg = 0xF7, chain_buf[6];
+static int chain_left;
+
+static void on_chain(i2c_async_xfer_t *xfer, void *user_data) {
+    (void)user_data;
+    if (--chain_left > 0) {
+        CHECK(i2c_async_engine_submit(&engine, xfer));
+    }
+}
+
+static void test_resubmit_from_callback(void) {
+    setup();
+    memset(&chain, 0, sizeof(chain));
+    chain.addr = DEV; chain.tx = &chain_reg; chain.tx_len = 1;
+    chain.rx = chain_buf; chain.rx_len = 6; chain.callback = on_chain;
+    chain_left = 5;
+
+    CHECK(i2c_async_engine_submit(&engine, &chain));
+    fake_i2c_run(&bus, &engine, 1);
+
+    CHECK(chain_left == 0);
+    CHECK(chain.status == I2C_ASYNC_DONE);
+    CHECK(bus.starts == 5 && bus.stops == 5);
+    check_bus_clean();
+}
+
+int main(void) {
+    test_burst_read(1);
+    test_burst_read(4);
+    test_burst_read(100);
+    test_long_read(3, 0);
+    test_long_read(64, 0);
+    test_long_read(1, 1);
+    test_write_only();
+    test_queue_order_and_nack();
+    test_queue_full();
+    test_resubmit_from_callback();
+
+    if (failures) {
+        printf("test_i2c_async: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_i2c_async: ok\n");
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hc_sr04.h"
+#include "hc_sr04_filter.h"
 
 // Define os pinos GPIO para o sensor
 #define TRIGGER_PIN 8
@@ -18,27 +19,46 @@ int main() {
     // Cria uma instância do nosso sensor
     hc_sr04_t sensor;
 
-    // Inicializa o sensor com os pinos definidos.
-    hc_sr04_init(&sensor, TRIGGER_PIN, ECHO_PIN);
+    // Inicializa o sensor no modo assíncrono: a PIO gera o TRIG e mede o ECHO,
+    // deixando o núcleo livre durante a medição.
+    if (!hc_sr04_init_async(&sensor, TRIGGER_PIN, ECHO_PIN, pio0, NULL, NULL)) {
+        printf("Erro: nenhuma maquina de estados da PIO disponivel\n");
+        return 1;
+    }
+
+    // Filtro de mediana + Kalman sobre as leituras brutas
+    hc_sr04_filter_t filter;
+    hc_sr04_filter_init(&filter, HC_SR04_FILTER_NOISE_MM_DEFAULT, HC_SR04_FILTER_ACCEL_MM_S_DEFAULT,
+                        HC_SR04_FILTER_MAX_RATE_MM_S_DEFAULT);
 
     while (1) {
-        // Realiza a medição
-        float distance = hc_sr04_get_distance_cm(&sensor);
+        // Dispara a medição e segue sem bloquear
+        hc_sr04_start_measurement(&sensor);
+
+        // Espera um pouco antes da próxima leitura para evitar ecos sobrepostos.
+        // Aqui o programa poderia fazer qualquer outro trabalho.
+        sleep_ms(1000);
 
-        if (distance >= 0) {
-            // A faixa de medição útil do sensor é de 2cm a 400cm[cite: 52].
-            if (distance > 400) {
-                printf("Distancia: Fora de alcance (> 400 cm)\n");
+        hc_sr04_result_t result;
+        while (hc_sr04_get_result(&sensor, &result)) {
+            hc_sr04_filtered_t filtered;
+            hc_sr04_filter_update(&filter, result.status, result.distance_mm, time_us_64(), &filtered);
+
+            if (result.status == HC_SR04_OK) {
+                // A faixa de medição útil do sensor é de 2cm a 400cm[cite: 52].
+                if (result.distance_mm > 4000) {
+                    printf("Distancia: Fora de alcance (> 400 cm)\n");
+                } else {
+                    printf("Distancia: %lu mm (%lu ciclos)\n", (unsigned long)result.distance_mm,
+                           (unsigned long)result.pulse_cycles);
+                }
+                printf("Filtrada: %lu mm (confianca %u%%)\n", (unsigned long)filtered.distance_mm,
+                       filtered.confidence);
             } else {
-                printf("Distancia: %.2f cm\n", distance);
+                // Imprime o erro
+                printf("Erro na leitura do sensor (codigo: %d)\n", (int)result.status);
             }
-        } else {
-            // Imprime o erro
-            printf("Erro na leitura do sensor (codigo: %.0f)\n", distance);
         }
-
-        // Espera um pouco antes da próxima leitura para evitar ecos sobrepostos.
-        sleep_ms(1000);
     }
 
     return 0;
@@ -6,14 +6,48 @@
 #include "hc_sr04.h"
 #include "hardware/gpio.h"
 #include "hardware/timer.h"
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hc_sr04.pio.h"
 
 // Fator de conversão de microssegundos para centímetros[cite: 97].
 // O tempo medido (em µs) dividido por este valor resulta na distância (em cm).
 const float US_TO_CM_DIVISOR = 58.0;
 
+// Timeouts usados pelas duas formas de medição (µs)
+#define ECHO_START_TIMEOUT_US 30000
+#define TRIGGER_PULSE_US      10
+
+// Valores especiais devolvidos pela PIO na RX FIFO
+#define PIO_RESULT_NO_ECHO      0xFFFFFFFFu
+#define PIO_RESULT_ECHO_TOO_LONG 0xFFFFFFFEu
+
+// Tabela da metade da velocidade do som (ida e volta) em mm/µs, Q16, de -40 °C
+// a +85 °C em passos de 5 °C: c = 331,3 * sqrt(1 + T / 273,15) m/s
+#define SOUND_TABLE_MIN_CENTI_C (-4000)
+#define SOUND_TABLE_STEP_CENTI_C 500
+#define SOUND_TABLE_LEN 26
+static const uint16_t half_sound_speed_q16[SOUND_TABLE_LEN] = {
+    10030, 10137, 10243, 10347, 10451, 10554, 10655, 10756, 10856, 10955, 11053, 11150, 11246,
+    11342, 11437, 11531, 11624, 11716, 11808, 11899, 11989, 12079, 12168, 12256, 12344, 12431,
+};
+
+// Temperatura assumida até o usuário informar outra (0,01 °C)
+#define DEFAULT_TEMPERATURE_CENTI_C 2000
+
+// Sensores associados a cada máquina de estados das duas PIOs
+static hc_sr04_t *pio_sensors[2][4];
+static int pio_program_offset[2] = { -1, -1 };
+static bool pio_irq_ready[2];
+
 void hc_sr04_init(hc_sr04_t *sensor, uint trigger_pin, uint echo_pin) {
     sensor->trigger_pin = trigger_pin;
     sensor->echo_pin = echo_pin;
+    sensor->sm = -1;
+    sensor->busy = false;
+    sensor->cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    hc_sr04_set_temperature(sensor, DEFAULT_TEMPERATURE_CENTI_C);
 
     // Inicializa os pinos GPIO
     gpio_init(sensor->trigger_pin);
@@ -24,14 +58,35 @@ void hc_sr04_init(hc_sr04_t *sensor, uint trigger_pin, uint echo_pin) {
     gpio_set_dir(sensor->echo_pin, GPIO_IN);    // ECHO é entrada [cite: 67]
 }
 
-float hc_sr04_get_distance_cm(hc_sr04_t *sensor) {
+void hc_sr04_set_temperature(hc_sr04_t *sensor, int32_t temperature_centi_c) {
+    // Interpolação linear na tabela; feita só quando a temperatura muda, a
+    // conversão de cada leitura é apenas uma multiplicação inteira
+    int32_t pos = temperature_centi_c - SOUND_TABLE_MIN_CENTI_C;
+    int32_t max_pos = (SOUND_TABLE_LEN - 1) * SOUND_TABLE_STEP_CENTI_C;
+    if (pos < 0) {
+        pos = 0;
+    } else if (pos > max_pos) {
+        pos = max_pos;
+    }
+
+    int32_t idx = pos / SOUND_TABLE_STEP_CENTI_C;
+    int32_t frac = pos % SOUND_TABLE_STEP_CENTI_C;
+    int32_t v0 = half_sound_speed_q16[idx];
+    int32_t v1 = half_sound_speed_q16[idx < SOUND_TABLE_LEN - 1 ? idx + 1 : idx];
+
+    sensor->mm_per_us_q16 = (uint32_t)(v0 + ((v1 - v0) * frac) / SOUND_TABLE_STEP_CENTI_C);
+    sensor->mm_per_cycle_q32 = ((uint64_t)sensor->mm_per_us_q16 << 16) / sensor->cycles_per_us;
+}
+
+// Mede a duração do pulso de ECHO por polling (modo síncrono)
+static hc_sr04_status_t hc_sr04_measure_pulse_us(hc_sr04_t *sensor, uint32_t *pulse_us) {
     // Garante que o pino de trigger esteja em nível baixo para começar
     gpio_put(sensor->trigger_pin, 0);
     sleep_us(2);
 
     // Envia o pulso de trigger de 10 microssegundos para iniciar a medição[cite: 55, 65].
     gpio_put(sensor->trigger_pin, 1);
-    sleep_us(10);
+    sleep_us(TRIGGER_PULSE_US);
     gpio_put(sensor->trigger_pin, 0);
 
     // Aguarda o pino de echo ficar em nível alto[cite: 66].
@@ -39,24 +94,175 @@ float hc_sr04_get_distance_cm(hc_sr04_t *sensor) {
     // O pulso pode levar até ~24ms para um objeto a 4m. Usamos 30ms como timeout seguro.
     uint64_t timeout_start = time_us_64();
     while (!gpio_get(sensor->echo_pin)) {
-        if ((time_us_64() - timeout_start) > 30000) {
-            return -1.0; // Erro: Timeout esperando o início do pulso
+        if ((time_us_64() - timeout_start) > ECHO_START_TIMEOUT_US) {
+            return HC_SR04_ERR_NO_ECHO; // Erro: Timeout esperando o início do pulso
         }
     }
 
     // Mede a duração do pulso de echo.
     uint64_t pulse_start_time = time_us_64();
     while (gpio_get(sensor->echo_pin)) {
-        if ((time_us_64() - pulse_start_time) > 30000) {
-            return -2.0; // Erro: Timeout durante o pulso
+        if ((time_us_64() - pulse_start_time) > ECHO_START_TIMEOUT_US) {
+            return HC_SR04_ERR_ECHO_TIMEOUT; // Erro: Timeout durante o pulso
         }
     }
     uint64_t pulse_end_time = time_us_64();
 
-    uint64_t pulse_duration = pulse_end_time - pulse_start_time;
+    *pulse_us = (uint32_t)(pulse_end_time - pulse_start_time);
+    return HC_SR04_OK;
+}
+
+hc_sr04_status_t hc_sr04_get_distance_mm(hc_sr04_t *sensor, uint32_t *distance_mm) {
+    uint32_t pulse_us;
+    hc_sr04_status_t status = hc_sr04_measure_pulse_us(sensor, &pulse_us);
+    if (status != HC_SR04_OK) {
+        return status;
+    }
+
+    // Distância = duração * (velocidade do som / 2), tudo em inteiros
+    *distance_mm = (uint32_t)(((uint64_t)pulse_us * sensor->mm_per_us_q16 + 0x8000) >> 16);
+    return HC_SR04_OK;
+}
+
+float hc_sr04_get_distance_cm(hc_sr04_t *sensor) {
+    uint32_t pulse_us;
+    hc_sr04_status_t status = hc_sr04_measure_pulse_us(sensor, &pulse_us);
+    if (status == HC_SR04_ERR_NO_ECHO) {
+        return -1.0; // Erro: Timeout esperando o início do pulso
+    }
+    if (status == HC_SR04_ERR_ECHO_TIMEOUT) {
+        return -2.0; // Erro: Timeout durante o pulso
+    }
 
     // A distância em cm é a duração do pulso em µs dividida por 58[cite: 97].
-    float distance_cm = (float)pulse_duration / US_TO_CM_DIVISOR;
+    float distance_cm = (float)pulse_us / US_TO_CM_DIVISOR;
 
     return distance_cm;
-}
\ No newline at end of file
+}
+
+// --- Modo assíncrono (PIO) ---
+
+static void hc_sr04_push_result(hc_sr04_t *sensor, uint32_t raw) {
+    hc_sr04_result_t result;
+
+    result.pulse_cycles = 0;
+    result.distance_mm = 0;
+    if (raw == PIO_RESULT_NO_ECHO) {
+        result.status = HC_SR04_ERR_NO_ECHO;
+    } else if (raw == PIO_RESULT_ECHO_TOO_LONG) {
+        result.status = HC_SR04_ERR_ECHO_TIMEOUT;
+    } else {
+        // A PIO devolve o que sobrou do timeout; cada iteração do laço dura 2 ciclos
+        result.status = HC_SR04_OK;
+        result.pulse_cycles = (sensor->timeout_loops - raw) * 2;
+        result.distance_mm = (uint32_t)(((uint64_t)result.pulse_cycles * sensor->mm_per_cycle_q32 + 0x80000000u) >> 32);
+    }
+
+    // Fila cheia: descarta o resultado mais antigo para manter os mais recentes
+    uint8_t next = (uint8_t)((sensor->result_head + 1) % HC_SR04_RESULT_RING_LEN);
+    if (next == sensor->result_tail) {
+        sensor->result_tail = (uint8_t)((sensor->result_tail + 1) % HC_SR04_RESULT_RING_LEN);
+    }
+    sensor->results[sensor->result_head] = result;
+    sensor->result_head = next;
+    sensor->busy = false;
+
+    if (sensor->callback) {
+        sensor->callback(sensor, &result, sensor->user_data);
+    }
+}
+
+static void hc_sr04_pio_irq(uint pio_index) {
+    PIO pio = pio_index ? pio1 : pio0;
+
+    for (uint sm = 0; sm < 4; sm++) {
+        hc_sr04_t *sensor = pio_sensors[pio_index][sm];
+        if (!sensor) {
+            continue;
+        }
+        while (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            hc_sr04_push_result(sensor, pio_sm_get(pio, sm));
+        }
+    }
+}
+
+static void hc_sr04_pio0_irq(void) { hc_sr04_pio_irq(0); }
+static void hc_sr04_pio1_irq(void) { hc_sr04_pio_irq(1); }
+
+bool hc_sr04_init_async(hc_sr04_t *sensor, uint trigger_pin, uint echo_pin, PIO pio,
+                        hc_sr04_callback_t callback, void *user_data) {
+    uint pio_index = pio_get_index(pio);
+
+    sensor->trigger_pin = trigger_pin;
+    sensor->echo_pin = echo_pin;
+    sensor->sm = -1;
+    sensor->cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    hc_sr04_set_temperature(sensor, DEFAULT_TEMPERATURE_CENTI_C);
+
+    // O programa é carregado uma única vez por PIO e compartilhado pelos sensores
+    if (pio_program_offset[pio_index] < 0) {
+        if (!pio_can_add_program(pio, &hc_sr04_program)) {
+            return false;
+        }
+        pio_program_offset[pio_index] = (int)pio_add_program(pio, &hc_sr04_program);
+    }
+
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) {
+        return false;
+    }
+
+    sensor->pio = pio;
+    sensor->sm = sm;
+    sensor->trigger_cycles = TRIGGER_PULSE_US * sensor->cycles_per_us;
+    sensor->timeout_loops = ECHO_START_TIMEOUT_US * sensor->cycles_per_us / 2;
+    sensor->busy = false;
+    sensor->callback = callback;
+    sensor->user_data = user_data;
+    sensor->result_head = 0;
+    sensor->result_tail = 0;
+
+    hc_sr04_program_init(pio, (uint)sm, (uint)pio_program_offset[pio_index], trigger_pin, echo_pin);
+    pio_sensors[pio_index][sm] = sensor;
+
+    // Cada resultado na RX FIFO gera uma interrupção
+    pio_set_irq0_source_enabled(pio, pis_sm0_rx_fifo_not_empty + sm, true);
+    if (!pio_irq_ready[pio_index]) {
+        uint irq = pio_index ? PIO1_IRQ_0 : PIO0_IRQ_0;
+        irq_add_shared_handler(irq, pio_index ? hc_sr04_pio1_irq : hc_sr04_pio0_irq,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(irq, true);
+        pio_irq_ready[pio_index] = true;
+    }
+
+    pio_sm_set_enabled(pio, (uint)sm, true);
+    return true;
+}
+
+bool hc_sr04_start_measurement(hc_sr04_t *sensor) {
+    if (sensor->sm < 0 || sensor->busy) {
+        return false;
+    }
+    sensor->busy = true;
+
+    // Largura do TRIG e timeout; a SM faz o resto sem a CPU
+    pio_sm_put(sensor->pio, (uint)sensor->sm, sensor->trigger_cycles);
+    pio_sm_put(sensor->pio, (uint)sensor->sm, sensor->timeout_loops);
+    return true;
+}
+
+bool hc_sr04_get_result(hc_sr04_t *sensor, hc_sr04_result_t *result) {
+    // A interrupção também move a cauda quando a fila enche
+    uint32_t save = save_and_disable_interrupts();
+    bool available = sensor->result_tail != sensor->result_head;
+    if (available) {
+        *result = sensor->results[sensor->result_tail];
+        sensor->result_tail = (uint8_t)((sensor->result_tail + 1) % HC_SR04_RESULT_RING_LEN);
+    }
+    restore_interrupts(save);
+    return available;
+}
+
+bool hc_sr04_is_busy(const hc_sr04_t *sensor) {
+    return sensor->busy;
+}
@@ -8,12 +8,48 @@
 
 // Inclui o SDK do Pico para tipos de dados como uint
 #include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hc_sr04_status.h"
 
-// Estrutura para manter as informações de pino para um sensor HC-SR04
+// Quantidade de resultados guardados por sensor no modo assíncrono
+#define HC_SR04_RESULT_RING_LEN 8
+
+// Resultado de uma medição assíncrona
 typedef struct {
+    hc_sr04_status_t status;
+    uint32_t pulse_cycles;  // Duração do pulso de ECHO em ciclos do clock do sistema
+    uint32_t distance_mm;   // Distância em mm, válida apenas se status == HC_SR04_OK
+} hc_sr04_result_t;
+
+typedef struct hc_sr04 hc_sr04_t;
+
+// Chamada no contexto da interrupção da PIO ao final de cada medição assíncrona
+typedef void (*hc_sr04_callback_t)(hc_sr04_t *sensor, const hc_sr04_result_t *result, void *user_data);
+
+// Estrutura para manter as informações de pino para um sensor HC-SR04
+struct hc_sr04 {
     uint trigger_pin;
     uint echo_pin;
-} hc_sr04_t;
+
+    // Conversão para distância, ajustada pela temperatura do ar
+    uint32_t cycles_per_us;
+    uint32_t mm_per_us_q16;       // Metade da velocidade do som em mm/µs, Q16
+    uint64_t mm_per_cycle_q32;    // O mesmo por ciclo do clock do sistema, Q32
+
+    // Modo assíncrono (PIO), sm < 0 quando não utilizado
+    PIO pio;
+    int sm;
+    uint32_t trigger_cycles;
+    uint32_t timeout_loops;
+    volatile bool busy;
+    hc_sr04_callback_t callback;
+    void *user_data;
+
+    // Fila circular de resultados preenchida pela interrupção
+    hc_sr04_result_t results[HC_SR04_RESULT_RING_LEN];
+    volatile uint8_t result_head;
+    volatile uint8_t result_tail;
+};
 
 /**
  * [cite_start]@brief Inicializa os pinos para o sensor HC-SR04[cite: 61, 62, 63, 64, 67].
@@ -38,4 +74,68 @@ void hc_sr04_init(hc_sr04_t *sensor, uint trigger_pin, uint echo_pin);
  */
 float hc_sr04_get_distance_cm(hc_sr04_t *sensor);
 
+/**
+ * @brief Realiza uma medição de distância usando apenas aritmética inteira.
+ *
+ * A conversão usa a velocidade do som na temperatura informada por
+ * hc_sr04_set_temperature() (20 °C por padrão).
+ *
+ * @param sensor Ponteiro para a estrutura do sensor hc_sr04_t.
+ * @param distance_mm Onde a distância medida, em milímetros, será escrita.
+ * @return HC_SR04_OK ou o código do erro; distance_mm só é escrita em caso de sucesso.
+ */
+hc_sr04_status_t hc_sr04_get_distance_mm(hc_sr04_t *sensor, uint32_t *distance_mm);
+
+/**
+ * @brief Informa a temperatura do ar para corrigir a velocidade do som.
+ *
+ * A velocidade vem de uma tabela pré-calculada (-40 °C a +85 °C) e o fator de
+ * conversão é recalculado aqui, não a cada leitura. A unidade é a mesma de
+ * bmp280_convert_temp(), cujo resultado pode ser passado diretamente.
+ *
+ * @param sensor Ponteiro para a estrutura do sensor hc_sr04_t.
+ * @param temperature_centi_c Temperatura em centésimos de grau Celsius.
+ */
+void hc_sr04_set_temperature(hc_sr04_t *sensor, int32_t temperature_centi_c);
+
+/**
+ * @brief Inicializa o sensor no modo assíncrono, com a medição feita pela PIO.
+ *
+ * Uma máquina de estados gera o pulso de TRIG e mede o pulso de ECHO com resolução
+ * de 2 ciclos do clock do sistema. O núcleo fica livre durante a medição e o resultado
+ * chega pela interrupção da PIO, que o coloca na fila do sensor e chama o callback.
+ *
+ * @param sensor Ponteiro para a estrutura do sensor hc_sr04_t.
+ * @param trigger_pin O número do pino GPIO conectado ao pino TRIG do sensor.
+ * @param echo_pin O número do pino GPIO conectado ao pino ECHO do sensor.
+ * @param pio A instância da PIO a ser usada (pio0 ou pio1).
+ * @param callback Função chamada ao final de cada medição (pode ser NULL).
+ * @param user_data Ponteiro repassado ao callback.
+ * @return true se havia uma máquina de estados e espaço de programa livres.
+ */
+bool hc_sr04_init_async(hc_sr04_t *sensor, uint trigger_pin, uint echo_pin, PIO pio,
+                        hc_sr04_callback_t callback, void *user_data);
+
+/**
+ * @brief Dispara uma medição assíncrona e retorna imediatamente.
+ *
+ * @param sensor Ponteiro para a estrutura do sensor hc_sr04_t.
+ * @return false se o sensor não está no modo assíncrono ou já há uma medição em andamento.
+ */
+bool hc_sr04_start_measurement(hc_sr04_t *sensor);
+
+/**
+ * @brief Retira o resultado mais antigo da fila do sensor.
+ *
+ * @param sensor Ponteiro para a estrutura do sensor hc_sr04_t.
+ * @param result Onde o resultado será copiado.
+ * @return true se havia um resultado na fila.
+ */
+bool hc_sr04_get_result(hc_sr04_t *sensor, hc_sr04_result_t *result);
+
+/**
+ * @brief Indica se há uma medição assíncrona em andamento.
+ */
+bool hc_sr04_is_busy(const hc_sr04_t *sensor);
+
 #endif // HC_SR04_H
\ No newline at end of file
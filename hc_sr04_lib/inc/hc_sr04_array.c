@@ -0,0 +1,167 @@
+/*
+ * hc_sr04_array.c - Implementação do gerenciador de vários sensores HC-SR04.
+ */
+
+#include "hc_sr04_array.h"
+#include "hardware/sync.h"
+
+// Chamado pela interrupção da PIO a cada medição concluída
+static void hc_sr04_array_on_result(hc_sr04_t *sensor, const hc_sr04_result_t *result, void *user_data) {
+    hc_sr04_array_t *array = (hc_sr04_array_t *)user_data;
+    uint index = (uint)(sensor - array->sensors);
+    uint64_t now = time_us_64();
+
+    volatile hc_sr04_reading_t *reading = &array->latest[index];
+    reading->status = result->status;
+    reading->distance_mm = result->distance_mm;
+    reading->pulse_cycles = result->pulse_cycles;
+    reading->timestamp_us = now;
+    reading->sequence++;
+
+    // O slot termina quando o último sensor dele responde
+    array->pending &= (uint8_t)~(1u << index);
+    if (array->pending == 0) {
+        array->slot_done_us = now;
+    }
+}
+
+void hc_sr04_array_init(hc_sr04_array_t *array, uint32_t guard_us) {
+    array->count = 0;
+    array->slot_count = 0;
+    array->current_slot = 0;
+    array->guard_us = guard_us;
+    array->pending = 0;
+    array->slot_done_us = 0;
+    array->running = false;
+
+    for (uint i = 0; i < HC_SR04_ARRAY_MAX; i++) {
+        array->interferes[i] = 0;
+        array->slot_mask[i] = 0;
+        array->latest[i].sequence = 0;
+    }
+}
+
+int hc_sr04_array_add(hc_sr04_array_t *array, uint trigger_pin, uint echo_pin, PIO pio) {
+    if (array->count >= HC_SR04_ARRAY_MAX) {
+        return -1;
+    }
+
+    uint index = array->count;
+    if (!hc_sr04_init_async(&array->sensors[index], trigger_pin, echo_pin, pio,
+                            hc_sr04_array_on_result, array)) {
+        return -1;
+    }
+    array->count++;
+    return (int)index;
+}
+
+void hc_sr04_array_set_interference(hc_sr04_array_t *array, uint a, uint b) {
+    array->interferes[a] |= (uint8_t)(1u << b);
+    array->interferes[b] |= (uint8_t)(1u << a);
+}
+
+static uint8_t popcount8(uint8_t v) {
+    uint8_t n = 0;
+    while (v) {
+        v &= (uint8_t)(v - 1);
+        n++;
+    }
+    return n;
+}
+
+void hc_sr04_array_build_schedule(hc_sr04_array_t *array) {
+    uint8_t order[HC_SR04_ARRAY_MAX];
+    uint8_t n = array->count;
+
+    // Ordena os sensores pelo número de conflitos, do maior para o menor
+    for (uint8_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    for (uint8_t i = 1; i < n; i++) {
+        uint8_t key = order[i];
+        uint8_t deg = popcount8(array->interferes[key]);
+        int j = i - 1;
+        while (j >= 0 && popcount8(array->interferes[order[j]]) < deg) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = key;
+    }
+
+    // Cada sensor vai para o primeiro slot sem nenhum sensor que interfira com ele
+    uint8_t slot_count = 0;
+    uint8_t slots[HC_SR04_ARRAY_MAX] = { 0 };
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t s = order[i];
+        uint8_t slot = 0;
+        while (slot < slot_count && (slots[slot] & array->interferes[s])) {
+            slot++;
+        }
+        if (slot == slot_count) {
+            slot_count++;
+        }
+        slots[slot] |= (uint8_t)(1u << s);
+    }
+
+    hc_sr04_array_set_schedule(array, slots, slot_count);
+}
+
+void hc_sr04_array_set_schedule(hc_sr04_array_t *array, const uint8_t *slot_masks, uint8_t slot_count) {
+    if (slot_count > HC_SR04_ARRAY_MAX) {
+        slot_count = HC_SR04_ARRAY_MAX;
+    }
+    for (uint8_t i = 0; i < slot_count; i++) {
+        array->slot_mask[i] = slot_masks[i];
+    }
+    array->slot_count = slot_count;
+    array->current_slot = (uint8_t)(slot_count - 1); // o próximo poll começa pelo slot 0
+    array->running = slot_count > 0;
+}
+
+void hc_sr04_array_poll(hc_sr04_array_t *array) {
+    if (!array->running || array->pending) {
+        return; // Sem escalonamento ou slot atual ainda medindo
+    }
+
+    // Espera o tempo de guarda depois do último eco do slot anterior
+    if (time_us_64() - array->slot_done_us < array->guard_us) {
+        return;
+    }
+
+    array->current_slot = (uint8_t)((array->current_slot + 1) % array->slot_count);
+    uint8_t mask = (uint8_t)(array->slot_mask[array->current_slot] & ((1u << array->count) - 1));
+    if (!mask) {
+        return;
+    }
+
+    // pending precisa estar completo antes do primeiro resultado chegar, por
+    // isso os disparos são feitos com as interrupções desabilitadas
+    uint32_t save = save_and_disable_interrupts();
+    array->pending = mask;
+    for (uint i = 0; i < array->count; i++) {
+        if ((mask & (1u << i)) && !hc_sr04_start_measurement(&array->sensors[i])) {
+            array->pending &= (uint8_t)~(1u << i);
+        }
+    }
+    if (array->pending == 0) {
+        array->slot_done_us = time_us_64();
+    }
+    restore_interrupts(save);
+}
+
+bool hc_sr04_array_get(hc_sr04_array_t *array, uint index, hc_sr04_reading_t *reading) {
+    if (index >= array->count) {
+        return false;
+    }
+
+    // A leitura é escrita pela interrupção; copia com ela desabilitada
+    uint32_t save = save_and_disable_interrupts();
+    reading->status = array->latest[index].status;
+    reading->distance_mm = array->latest[index].distance_mm;
+    reading->pulse_cycles = array->latest[index].pulse_cycles;
+    reading->timestamp_us = array->latest[index].timestamp_us;
+    reading->sequence = array->latest[index].sequence;
+    restore_interrupts(save);
+
+    return reading->sequence > 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * hc_sr04_array.h - Gerenciador de vários sensores HC-SR04 com disparo escalonado.
+ *
+ * Os sensores são medidos no modo assíncrono (PIO) e organizados em "slots":
+ * todos os sensores de um slot disparam juntos e os slots se alternam em
+ * rodízio. Dois sensores que interferem entre si (crosstalk acústico) nunca
+ * ficam no mesmo slot. Um slot termina assim que todos os seus ecos chegam,
+ * mais um tempo de guarda para os ecos residuais se dissiparem, de modo que a
+ * taxa de atualização agregada fica limitada apenas pela física.
+ */
+
+#ifndef HC_SR04_ARRAY_H
+#define HC_SR04_ARRAY_H
+
+#include "hc_sr04.h"
+
+// Máximo de sensores por array (duas PIOs com 4 máquinas de estados cada)
+#define HC_SR04_ARRAY_MAX 8
+
+// Tempo de guarda padrão entre slots para os ecos residuais se dissiparem (µs)
+#define HC_SR04_ARRAY_GUARD_US_DEFAULT 10000
+
+// Última leitura de um sensor
+typedef struct {
+    hc_sr04_status_t status;
+    uint32_t distance_mm;   // Distância em mm, válida apenas se status == HC_SR04_OK
+    uint32_t pulse_cycles;  // Duração do pulso de ECHO em ciclos do clock do sistema
+    uint64_t timestamp_us;  // Momento em que a leitura chegou
+    uint32_t sequence;      // Número de leituras recebidas deste sensor
+} hc_sr04_reading_t;
+
+typedef struct {
+    hc_sr04_t sensors[HC_SR04_ARRAY_MAX];
+    uint8_t count;
+
+    // interferes[i] tem o bit j ligado se os sensores i e j não podem disparar juntos
+    uint8_t interferes[HC_SR04_ARRAY_MAX];
+
+    // Escalonamento: sensores disparados em cada slot
+    uint8_t slot_mask[HC_SR04_ARRAY_MAX];
+    uint8_t slot_count;
+    uint8_t current_slot;
+    uint32_t guard_us;
+
+    // Estado do slot atual, atualizado pela interrupção da PIO
+    volatile uint8_t pending;
+    volatile uint64_t slot_done_us;
+    bool running;
+
+    // Tabela com a leitura mais recente de cada sensor
+    volatile hc_sr04_reading_t latest[HC_SR04_ARRAY_MAX];
+} hc_sr04_array_t;
+
+/**
+ * @brief Inicializa um array vazio.
+ *
+ * @param array Ponteiro para a estrutura do array.
+ * @param guard_us Tempo de guarda entre slots, em µs.
+ */
+void hc_sr04_array_init(hc_sr04_array_t *array, uint32_t guard_us);
+
+/**
+ * @brief Adiciona um sensor ao array, no modo assíncrono.
+ *
+ * @param array Ponteiro para a estrutura do array.
+ * @param trigger_pin O número do pino GPIO conectado ao pino TRIG do sensor.
+ * @param echo_pin O número do pino GPIO conectado ao pino ECHO do sensor.
+ * @param pio A instância da PIO a ser usada para este sensor.
+ * @return O índice do sensor no array, ou -1 se não há espaço ou recursos da PIO.
+ */
+int hc_sr04_array_add(hc_sr04_array_t *array, uint trigger_pin, uint echo_pin, PIO pio);
+
+/**
+ * @brief Declara que dois sensores interferem entre si (relação simétrica).
+ */
+void hc_sr04_array_set_interference(hc_sr04_array_t *array, uint a, uint b);
+
+/**
+ * @brief Monta os slots automaticamente a partir das interferências declaradas.
+ *
+ * Coloração gulosa do grafo de interferência, começando pelos sensores com mais
+ * conflitos, para usar o menor número de slots possível.
+ */
+void hc_sr04_array_build_schedule(hc_sr04_array_t *array);
+
+/**
+ * @brief Define os slots manualmente.
+ *
+ * @param array Ponteiro para a estrutura do array.
+ * @param slot_masks Máscara de sensores disparados em cada slot, na ordem de disparo.
+ * @param slot_count Quantidade de slots (no máximo HC_SR04_ARRAY_MAX).
+ */
+void hc_sr04_array_set_schedule(hc_sr04_array_t *array, const uint8_t *slot_masks, uint8_t slot_count);
+
+/**
+ * @brief Avança o escalonamento. Não bloqueante; deve ser chamada com frequência
+ * pelo laço principal (ou por um timer).
+ */
+void hc_sr04_array_poll(hc_sr04_array_t *array);
+
+/**
+ * @brief Copia a leitura mais recente de um sensor.
+ *
+ * @return false se o sensor ainda não tem nenhuma leitura.
+ */
+bool hc_sr04_array_get(hc_sr04_array_t *array, uint index, hc_sr04_reading_t *reading);
+
+#endif // HC_SR04_ARRAY_H
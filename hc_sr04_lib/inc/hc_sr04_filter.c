@@ -0,0 +1,149 @@
+/*
+ * hc_sr04_filter.c - Implementação do filtro de leituras do HC-SR04.
+ */
+
+#include "hc_sr04_filter.h"
+
+// Marca, na janela circular, uma leitura com erro
+#define SAMPLE_INVALID UINT32_MAX
+
+void hc_sr04_filter_init(hc_sr04_filter_t *filter, uint32_t noise_mm, uint32_t accel_mm_s, uint32_t max_rate_mm_s) {
+    filter->noise_mm = noise_mm ? noise_mm : 1;
+    filter->accel_mm_s = accel_mm_s;
+    filter->max_rate_mm_s = max_rate_mm_s;
+    filter->spread_mm = HC_SR04_FILTER_SPREAD_MM_DEFAULT;
+    hc_sr04_filter_reset(filter);
+}
+
+void hc_sr04_filter_reset(hc_sr04_filter_t *filter) {
+    filter->head = 0;
+    filter->filled = 0;
+    filter->sorted_count = 0;
+    filter->estimate_mm = 0;
+    filter->variance = 0;
+    filter->last_us = 0;
+    filter->rejects = 0;
+    filter->primed = false;
+}
+
+// Posição do primeiro elemento >= value no vetor ordenado (busca binária)
+static uint8_t sorted_lower_bound(const hc_sr04_filter_t *filter, uint32_t value) {
+    uint8_t lo = 0;
+    uint8_t hi = filter->sorted_count;
+    while (lo < hi) {
+        uint8_t mid = (uint8_t)((lo + hi) / 2);
+        if (filter->sorted[mid] < value) {
+            lo = (uint8_t)(mid + 1);
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void sorted_insert(hc_sr04_filter_t *filter, uint32_t value) {
+    uint8_t pos = sorted_lower_bound(filter, value);
+    for (uint8_t i = filter->sorted_count; i > pos; i--) {
+        filter->sorted[i] = filter->sorted[i - 1];
+    }
+    filter->sorted[pos] = value;
+    filter->sorted_count++;
+}
+
+static void sorted_remove(hc_sr04_filter_t *filter, uint32_t value) {
+    uint8_t pos = sorted_lower_bound(filter, value);
+    filter->sorted_count--;
+    for (uint8_t i = pos; i < filter->sorted_count; i++) {
+        filter->sorted[i] = filter->sorted[i + 1];
+    }
+}
+
+static uint32_t abs_diff(uint32_t a, uint32_t b) {
+    return a > b ? a - b : b - a;
+}
+
+bool hc_sr04_filter_update(hc_sr04_filter_t *filter, hc_sr04_status_t status, uint32_t distance_mm,
+                           uint64_t timestamp_us, hc_sr04_filtered_t *out) {
+    uint32_t sample = (status == HC_SR04_OK) ? distance_mm : SAMPLE_INVALID;
+
+    // Janela cheia: a amostra mais antiga sai do vetor ordenado
+    if (filter->filled == HC_SR04_FILTER_WINDOW) {
+        uint32_t oldest = filter->window[filter->head];
+        if (oldest != SAMPLE_INVALID) {
+            sorted_remove(filter, oldest);
+        }
+    } else {
+        filter->filled++;
+    }
+    filter->window[filter->head] = sample;
+    filter->head = (uint8_t)((filter->head + 1) % HC_SR04_FILTER_WINDOW);
+    if (sample != SAMPLE_INVALID) {
+        sorted_insert(filter, sample);
+    }
+
+    uint8_t n = filter->sorted_count;
+    if (n == 0) {
+        // Nenhum eco válido na janela: mantém a última estimativa, sem confiança
+        out->distance_mm = filter->primed ? (uint32_t)filter->estimate_mm : 0;
+        out->median_mm = 0;
+        out->confidence = 0;
+        out->valid = false;
+        return false;
+    }
+
+    uint32_t median = (n & 1) ? filter->sorted[n / 2]
+                              : (filter->sorted[n / 2 - 1] + filter->sorted[n / 2]) / 2;
+    uint64_t noise_var = (uint64_t)filter->noise_mm * filter->noise_mm;
+    bool rejected = false;
+
+    if (!filter->primed) {
+        filter->estimate_mm = (int32_t)median;
+        filter->variance = noise_var;
+        filter->primed = true;
+    } else {
+        uint64_t dt_us = timestamp_us - filter->last_us;
+
+        // Predição: a incerteza cresce com o tempo desde a última amostra
+        uint64_t accel = filter->accel_mm_s;
+        filter->variance += (accel * accel * dt_us) / 1000000;
+
+        // Porta de taxa de variação: o alvo não anda mais que max_rate no intervalo
+        int32_t innovation = (int32_t)median - filter->estimate_mm;
+        uint32_t gate = (uint32_t)(((uint64_t)filter->max_rate_mm_s * dt_us) / 1000000) + 3 * filter->noise_mm;
+        if ((uint32_t)(innovation < 0 ? -innovation : innovation) > gate) {
+            if (++filter->rejects >= HC_SR04_FILTER_MAX_REJECTS) {
+                // Saltos consistentes: o alvo mudou de fato, recomeça dele
+                filter->estimate_mm = (int32_t)median;
+                filter->variance = noise_var;
+                filter->rejects = 0;
+            } else {
+                rejected = true;
+            }
+        } else {
+            // Atualização, com o ganho em Q16
+            filter->rejects = 0;
+            uint64_t gain = (filter->variance << 16) / (filter->variance + noise_var);
+            filter->estimate_mm += (int32_t)(((int64_t)innovation * (int64_t)gain) / 65536);
+            filter->variance = (filter->variance * (65536 - gain)) >> 16;
+        }
+    }
+    filter->last_us = timestamp_us;
+
+    // Confiança: fração de ecos válidos na janela, reduzida pela dispersão
+    // (intervalo interquartil) e pela rejeição da amostra atual
+    uint32_t spread = abs_diff(filter->sorted[(3 * (n - 1)) / 4], filter->sorted[(n - 1) / 4]);
+    if (spread > filter->spread_mm) {
+        spread = filter->spread_mm;
+    }
+    uint32_t confidence = (100u * n) / filter->filled;
+    confidence = (confidence * (filter->spread_mm - spread)) / filter->spread_mm;
+    if (rejected) {
+        confidence /= 2;
+    }
+
+    out->distance_mm = filter->estimate_mm > 0 ? (uint32_t)filter->estimate_mm : 0;
+    out->median_mm = median;
+    out->confidence = (uint8_t)confidence;
+    out->valid = true;
+    return true;
+}
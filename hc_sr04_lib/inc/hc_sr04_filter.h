@@ -0,0 +1,93 @@
+/*
+ * hc_sr04_filter.h - Filtro de leituras do HC-SR04 em fluxo contínuo.
+ *
+ * Cada leitura bruta (modo síncrono ou assíncrono) entra em uma janela
+ * circular. A mediana da janela, mantida incrementalmente em um vetor
+ * ordenado, descarta ecos espúrios; em seguida um filtro de Kalman escalar
+ * suaviza a distância, com uma porta que rejeita saltos maiores que a
+ * velocidade máxima esperada do alvo. Nada do histórico é reprocessado a cada
+ * amostra. Toda a aritmética é inteira e não depende do SDK do Pico.
+ */
+
+#ifndef HC_SR04_FILTER_H
+#define HC_SR04_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hc_sr04_status.h"
+
+// Tamanho da janela da mediana (amostras)
+#ifndef HC_SR04_FILTER_WINDOW
+#define HC_SR04_FILTER_WINDOW 7
+#endif
+
+// Rejeições seguidas da porta após as quais o filtro aceita a nova posição
+#define HC_SR04_FILTER_MAX_REJECTS 3
+
+// Valores padrão dos parâmetros
+#define HC_SR04_FILTER_NOISE_MM_DEFAULT 5       // Desvio padrão do ruído de medição
+#define HC_SR04_FILTER_ACCEL_MM_S_DEFAULT 500   // Desvio padrão da variação do alvo por segundo
+#define HC_SR04_FILTER_MAX_RATE_MM_S_DEFAULT 2000
+#define HC_SR04_FILTER_SPREAD_MM_DEFAULT 100    // Dispersão da janela com confiança zero
+
+// Saída do filtro
+typedef struct {
+    uint32_t distance_mm;   // Distância filtrada
+    uint32_t median_mm;     // Mediana da janela
+    uint8_t confidence;     // 0 a 100
+    bool valid;             // false enquanto não há nenhum eco válido na janela
+} hc_sr04_filtered_t;
+
+typedef struct {
+    // Parâmetros
+    uint32_t noise_mm;
+    uint32_t accel_mm_s;
+    uint32_t max_rate_mm_s;
+    uint32_t spread_mm;
+
+    // Janela circular na ordem de chegada, incluindo as leituras com erro
+    uint32_t window[HC_SR04_FILTER_WINDOW];
+    uint8_t head;
+    uint8_t filled;
+
+    // Apenas as leituras válidas da janela, em ordem crescente
+    uint32_t sorted[HC_SR04_FILTER_WINDOW];
+    uint8_t sorted_count;
+
+    // Estado do filtro de Kalman: estimativa (mm) e variância (mm²)
+    int32_t estimate_mm;
+    uint64_t variance;
+    uint64_t last_us;
+    uint8_t rejects;
+    bool primed;
+} hc_sr04_filter_t;
+
+/**
+ * @brief Inicializa o filtro.
+ *
+ * @param filter Ponteiro para a estrutura do filtro.
+ * @param noise_mm Desvio padrão do ruído de uma leitura, em mm.
+ * @param accel_mm_s Quanto a distância real pode variar por segundo (desvio padrão), em mm/s.
+ * @param max_rate_mm_s Velocidade máxima do alvo; saltos maiores são rejeitados.
+ */
+void hc_sr04_filter_init(hc_sr04_filter_t *filter, uint32_t noise_mm, uint32_t accel_mm_s, uint32_t max_rate_mm_s);
+
+/**
+ * @brief Descarta o histórico, mantendo os parâmetros.
+ */
+void hc_sr04_filter_reset(hc_sr04_filter_t *filter);
+
+/**
+ * @brief Adiciona uma leitura e calcula a distância filtrada.
+ *
+ * @param filter Ponteiro para a estrutura do filtro.
+ * @param status Resultado da medição; leituras com erro reduzem a confiança.
+ * @param distance_mm Distância medida, ignorada se status != HC_SR04_OK.
+ * @param timestamp_us Momento da leitura, em µs (ex.: time_us_64()).
+ * @param out Onde o resultado será escrito.
+ * @return out->valid.
+ */
+bool hc_sr04_filter_update(hc_sr04_filter_t *filter, hc_sr04_status_t status, uint32_t distance_mm,
+                           uint64_t timestamp_us, hc_sr04_filtered_t *out);
+
+#endif // HC_SR04_FILTER_H
@@ -0,0 +1,18 @@
+/*
+ * hc_sr04_status.h - Resultado de uma medição do HC-SR04.
+ *
+ * Separado de hc_sr04.h, que depende do SDK do Pico, para que o filtro
+ * (hc_sr04_filter.c) também compile e seja testado no host.
+ */
+
+#ifndef HC_SR04_STATUS_H
+#define HC_SR04_STATUS_H
+
+// Resultado de uma medição
+typedef enum {
+    HC_SR04_OK = 0,
+    HC_SR04_ERR_NO_ECHO,        // Timeout esperando o início do pulso de ECHO
+    HC_SR04_ERR_ECHO_TIMEOUT,   // Timeout durante o pulso de ECHO (sem objeto no alcance)
+} hc_sr04_status_t;
+
+#endif // HC_SR04_STATUS_H
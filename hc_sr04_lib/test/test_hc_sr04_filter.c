@@ -0,0 +1,229 @@
+/*
+ * test_hc_sr04_filter.c - Teste no host do filtro de leituras do HC-SR04.
+ *
+ * Reproduz traços ruidosos gerados de forma determinística (ruído de
+ * medição, ecos espúrios e timeouts, como os observados com o sensor real)
+ * e confere a mediana incremental contra uma ordenação completa da janela,
+ * a precisão do filtro de Kalman e o comportamento da porta de variação.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hc_sr04_filter.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+    } while (0)
+
+// Período de amostragem dos traços: 20 Hz
+#define PERIOD_US 50000
+
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+// Ruído aproximadamente gaussiano (soma de 4 uniformes), desvio padrão ~sigma
+static int32_t noise(int32_t sigma) {
+    int32_t sum = 0;
+    for (int i = 0; i < 4; i++) {
+        sum += (int32_t)(rng() % 2001) - 1000;
+    }
+    return (sum * sigma) / 1155;
+}
+
+// Uma leitura do traço: distância real com ruído, eco espúrio ou timeout
+static hc_sr04_status_t trace_sample(uint32_t true_mm, uint32_t spurious_pct, uint32_t timeout_pct,
+                                     uint32_t *distance_mm) {
+    uint32_t r = rng() % 100;
+    if (r < timeout_pct) {
+        *distance_mm = 0;
+        return HC_SR04_ERR_ECHO_TIMEOUT;
+    }
+    if (r < timeout_pct + spurious_pct) {
+        *distance_mm = 100 + rng() % 4000;   // multipercurso / outro objeto
+        return HC_SR04_OK;
+    }
+    int32_t d = (int32_t)true_mm + noise(5);
+    *distance_mm = d > 0 ? (uint32_t)d : 0;
+    return HC_SR04_OK;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void test_running_median(void) {
+    // Mediana incremental == mediana da janela ordenada do zero, a cada amostra
+    hc_sr04_filter_t f;
+    hc_sr04_filtered_t out;
+    hc_sr04_filter_init(&f, HC_SR04_FILTER_NOISE_MM_DEFAULT, HC_SR04_FILTER_ACCEL_MM_S_DEFAULT,
+                        HC_SR04_FILTER_MAX_RATE_MM_S_DEFAULT);
+
+    uint32_t hist[HC_SR04_FILTER_WINDOW];
+    bool hist_ok[HC_SR04_FILTER_WINDOW];
+    int mismatches = 0;
+    rng_state = 1;
+    for (int i = 0; i < 5000; i++) {
+        uint32_t d;
+        // muitos timeouts e valores repetidos para exercitar remoções de duplicatas
+        hc_sr04_status_t st = trace_sample(800 + (rng() % 3) * 10, 30, 25, &d);
+        hist[i % HC_SR04_FILTER_WINDOW] = d;
+        hist_ok[i % HC_SR04_FILTER_WINDOW] = (st == HC_SR04_OK);
+
+        bool valid = hc_sr04_filter_update(&f, st, d, (uint64_t)i * PERIOD_US, &out);
+
+        uint32_t win[HC_SR04_FILTER_WINDOW];
+        int n = 0;
+        int filled = i + 1 < HC_SR04_FILTER_WINDOW ? i + 1 : HC_SR04_FILTER_WINDOW;
+        for (int k = 0; k < filled; k++) {
+            if (hist_ok[k]) {
+                win[n++] = hist[k];
+            }
+        }
+        if (n == 0) {
+            mismatches += valid || out.confidence != 0;
+            continue;
+        }
+        qsort(win, (size_t)n, sizeof(win[0]), cmp_u32);
+        uint32_t median = (n & 1) ? win[n / 2] : (win[n / 2 - 1] + win[n / 2]) / 2;
+        mismatches += !valid || out.median_mm != median;
+    }
+    CHECK(mismatches == 0);
+}
+
+static void test_static_target(void) {
+    // Alvo parado a 1 m, 10% de ecos espúrios e 5% de timeouts
+    hc_sr04_filter_t f;
+    hc_sr04_filtered_t out;
+    hc_sr04_filter_init(&f, HC_SR04_FILTER_NOISE_MM_DEFAULT, HC_SR04_FILTER_ACCEL_MM_S_DEFAULT,
+                        HC_SR04_FILTER_MAX_RATE_MM_S_DEFAULT);
+
+    rng_state = 2;
+    uint32_t worst_raw = 0, worst = 0, conf_sum = 0;
+    for (int i = 0; i < 2000; i++) {
+        uint32_t d;
+        hc_sr04_status_t st = trace_sample(1000, 10, 5, &d);
+        if (st == HC_SR04_OK && (d > 1000 ? d - 1000 : 1000 - d) > worst_raw) {
+            worst_raw = d > 1000 ? d - 1000 : 1000 - d;
+        }
+        hc_sr04_filter_update(&f, st, d, (uint64_t)i * PERIOD_US, &out);
+        if (i >= HC_SR04_FILTER_WINDOW) {
+            uint32_t err = out.distance_mm > 1000 ? out.distance_mm - 1000 : 1000 - out.distance_mm;
+            if (err > worst) {
+                worst = err;
+            }
+            conf_sum += out.confidence;
+        }
+    }
+    printf("parado: erro bruto maximo %u mm, filtrado %u mm, confianca media %u\n",
+           worst_raw, worst, conf_sum / (2000 - HC_SR04_FILTER_WINDOW));
+    CHECK(worst_raw > 1000);   // o traço tem de fato ecos espúrios grosseiros
+    CHECK(worst <= 15);   // 3 desvios padrão do ruído
+    CHECK(conf_sum / (2000 - HC_SR04_FILTER_WINDOW) >= 70);
+}
+
+static void test_moving_target(void) {
+    // Alvo se afastando a 400 mm/s: a estimativa acompanha com atraso limitado
+    hc_sr04_filter_t f;
+    hc_sr04_filtered_t out;
+    hc_sr04_filter_init(&f, HC_SR04_FILTER_NOISE_MM_DEFAULT, HC_SR04_FILTER_ACCEL_MM_S_DEFAULT,
+                        HC_SR04_FILTER_MAX_RATE_MM_S_DEFAULT);
+
+    rng_state = 3;
+    uint32_t worst = 0;
+    for (int i = 0; i < 100; i++) {
+        uint32_t true_mm = 500 + (uint32_t)(i * 400 * (PERIOD_US / 1000)) / 1000;
+        uint32_t d;
+        hc_sr04_status_t st = trace_sample(true_mm, 5, 5, &d);
+        hc_sr04_filter_update(&f, st, d, (uint64_t)i * PERIOD_US, &out);
+        if (i >= 2 * HC_SR04_FILTER_WINDOW) {
+            uint32_t err = out.distance_mm > true_mm ? out.distance_mm - true_mm : true_mm - out.distance_mm;
+            if (err > worst) {
+                worst = err;
+            }
+        }
+    }
+    printf("em movimento: erro maximo %u mm\n", worst);
+    // a mediana de 7 amostras atrasa ~3 períodos (60 mm a 400 mm/s)
+    CHECK(worst <= 120);
+}
+
+static void test_step_and_reacquire(void) {
+    // O alvo muda de 1 m para 3 m: a porta segura os primeiros saltos e o
+    // filtro recomeça da nova posição após saltos consistentes
+    hc_sr04_filter_t f;
+    hc_sr04_filtered_t out;
+    hc_sr04_filter_init(&f, HC_SR04_FILTER_NOISE_MM_DEFAULT, HC_SR04_FILTER_ACCEL_MM_S_DEFAULT,
+                        HC_SR04_FILTER_MAX_RATE_MM_S_DEFAULT);
+
+    uint64_t t = 0;
+    for (int i = 0; i < 20; i++, t += PERIOD_US) {
+        hc_sr04_filter_update(&f, HC_SR04_OK, 1000, t, &out);
+    }
+    CHECK(out.distance_mm == 1000 && out.confidence == 100);
+
+    int settled_at = -1;
+    bool saw_reject = false;
+    for (int i = 0; i < 20; i++, t += PERIOD_US) {
+        hc_sr04_filter_update(&f, HC_SR04_OK, 3000, t, &out);
+        if (out.median_mm == 3000 && out.distance_mm == 1000 && out.confidence < 50) {
+            saw_reject = true;
+        }
+        if (settled_at < 0 && out.distance_mm == 3000) {
+            settled_at = i;
+        }
+    }
+    // mediana vira na 4ª amostra nova, e mais MAX_REJECTS - 1 rejeições
+    CHECK(saw_reject);
+    CHECK(settled_at == HC_SR04_FILTER_WINDOW / 2 + HC_SR04_FILTER_MAX_REJECTS - 1);
+    CHECK(out.distance_mm == 3000);
+}
+
+static void test_no_echo(void) {
+    // Só timeouts: sem validade nem confiança, e a última estimativa é mantida
+    hc_sr04_filter_t f;
+    hc_sr04_filtered_t out;
+    hc_sr04_filter_init(&f, HC_SR04_FILTER_NOISE_MM_DEFAULT, HC_SR04_FILTER_ACCEL_MM_S_DEFAULT,
+                        HC_SR04_FILTER_MAX_RATE_MM_S_DEFAULT);
+
+    CHECK(!hc_sr04_filter_update(&f, HC_SR04_ERR_NO_ECHO, 0, 0, &out));
+    CHECK(out.distance_mm == 0 && out.confidence == 0);
+
+    uint64_t t = PERIOD_US;
+    for (int i = 0; i < 10; i++, t += PERIOD_US) {
+        hc_sr04_filter_update(&f, HC_SR04_OK, 1500, t, &out);
+    }
+    for (int i = 0; i < HC_SR04_FILTER_WINDOW - 1; i++, t += PERIOD_US) {
+        CHECK(hc_sr04_filter_update(&f, HC_SR04_ERR_ECHO_TIMEOUT, 0, t, &out));
+        CHECK(out.distance_mm == 1500);
+    }
+    CHECK(out.confidence <= 100 / HC_SR04_FILTER_WINDOW + 1);
+    CHECK(!hc_sr04_filter_update(&f, HC_SR04_ERR_ECHO_TIMEOUT, 0, t, &out));
+    CHECK(out.distance_mm == 1500 && out.confidence == 0);
+
+    hc_sr04_filter_reset(&f);
+    CHECK(!hc_sr04_filter_update(&f, HC_SR04_ERR_ECHO_TIMEOUT, 0, t, &out));
+    CHECK(out.distance_mm == 0);
+}
+
+int main(void) {
+    test_running_median();
+    test_static_target();
+    test_moving_target();
+    test_step_and_reacquire();
+    test_no_echo();
+
+    if (failures) {
+        printf("test_hc_sr04_filter: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_hc_sr04_filter: ok\n");
+    return 0;
+}
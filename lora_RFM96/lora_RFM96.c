@@ -3,7 +3,9 @@
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
+#include "hardware/dma.h"
 #include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "lora_RFM95.h"
 
 // ============================
@@ -27,12 +29,16 @@
 #define REG_IRQ_FLAGS_MASK       0x11 // Permite mascarar (desativar) interrupções específicas. Se um bit está em 1, a IRQ correspondente é ignorada. [cite: 2177, 2427]
 #define REG_IRQ_FLAGS            0x12 // Contém as flags de status das interrupções (TxDone, RxDone, CrcError, etc.). A escrita de '1' em um bit limpa a flag correspondente. [cite: 2177, 2431]
 #define REG_RX_NB_BYTES          0x13 // Indica o número de bytes de payload recebidos no último pacote. [cite: 2177, 2431]
+#define REG_PKT_SNR_VALUE        0x19 // SNR do último pacote recebido, em complemento de 2 e quartos de dB.
+#define REG_PKT_RSSI_VALUE       0x1A // RSSI do último pacote recebido.
 #define REG_MODEM_CONFIG_1       0x1D // Configura parâmetros do modem: Largura de Banda (BW), Taxa de Codificação (CR) e Modo de Cabeçalho (Explícito/Implícito). [cite: 2182, 2444]
 #define REG_MODEM_CONFIG_2       0x1E // Configura parâmetros do modem: Spreading Factor (SF) e ativa o CRC no payload. [cite: 2182, 2450]
+#define REG_SYMB_TIMEOUT_LSB     0x1F // Timeout do RX_SINGLE, em símbolos (os 2 bits altos ficam em RegModemConfig2).
 #define REG_PREAMBLE_MSB         0x20 // Byte mais significativo (MSB) do comprimento do preâmbulo. [cite: 2182, 2452]
 #define REG_PREAMBLE_LSB         0x21 // Byte menos significativo (LSB) do comprimento do preâmbulo. [cite: 2182, 2452]
 #define REG_PAYLOAD_LENGTH       0x22 // Define o comprimento do payload. Usado em modo de cabeçalho implícito e para o pacote a ser transmitido. [cite: 2182, 2453]
 #define REG_MODEM_CONFIG_3       0x26 // Configurações adicionais: Otimização para Baixa Taxa de Dados (LDO) e Controle de Ganho Automático (AGC). [cite: 2182, 2458]
+#define REG_SYNC_WORD            0x39 // Palavra de sincronismo LoRa (0x34 é reservada para LoRaWAN).
 #define REG_DIO_MAPPING_1        0x40 // Mapeia as funções dos pinos de interrupção digital DIO0 a DIO3 (ex: TxDone, RxDone). [cite: 2182, 871]
 #define REG_VERSION              0x42 // Contém a versão do chip de silício. Útil para verificar a comunicação e identificar o hardware. [cite: 2182, 2313]
 #define REG_PA_DAC               0x4D // Configurações do DAC do amplificador de potência, incluindo a ativação do modo de alta potência de +20dBm. [cite: 2187, 1930]
@@ -41,34 +47,128 @@
 #define MODE_STDBY               0x01
 #define MODE_TX                  0x03
 #define MODE_RX_CONTINUOUS       0x05
+#define MODE_RX_SINGLE           0x06
+#define MODE_CAD                 0x07
 
 // IRQ FLAGS
+#define IRQ_CAD_DETECTED_MASK    0x01
+#define IRQ_CAD_DONE_MASK        0x04
 #define IRQ_TX_DONE_MASK         0x08
 #define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
 #define IRQ_RX_DONE_MASK         0x40
+#define IRQ_RX_TIMEOUT_MASK      0x80
+
+// RegDioMapping1: DIO0 nos bits 7-6, DIO1 nos bits 5-4
+#define DIO_MAP_RX               0x00 // DIO0 -> RxDone, DIO1 -> RxTimeout
+#define DIO_MAP_TX               0x40 // DIO0 -> TxDone
+#define DIO_MAP_CAD              0xA0 // DIO0 -> CadDone, DIO1 -> CadDetected
 
 
 // ============================
 // VARIÁVEIS PRIVADAS (STATIC)
 // ============================
 static lora_config_t lora;
-volatile static bool tx_done = false;
-volatile static bool rx_done = false;
-volatile static bool dio0_event = false;
+volatile static bool crc_error = false;
+static lora_profile_t profile;     // perfil do modem em uso
+static int8_t tx_power = LORA_TX_POWER_DEFAULT;
+static lora_radio_stats_t radio_stats;
+static int32_t rssi_avg_x16 = 0;   // médias exponenciais em 1/16, para não perder resolução
+static int32_t snr_avg_x16 = 0;
+volatile static uint32_t spi_transactions = 0;
+
+// Modo de recepção escolhido pela aplicação, retomado depois de cada transmissão
+typedef enum {
+    RX_OFF = 0,
+    RX_CONTINUOUS,
+    RX_DUTY_CYCLE,
+} rx_mode_t;
+static rx_mode_t rx_mode = RX_OFF;
+
+// O que o rádio está fazendo agora; diz o que fazer com o CadDone e com o fim de uma recepção
+typedef enum {
+    RADIO_IDLE = 0,     // standby ou sleep
+    RADIO_RX,           // recepção contínua
+    RADIO_CAD_RX,       // escuta periódica da recepção intermitente
+    RADIO_RX_SINGLE,    // recebendo depois de um CAD positivo
+    RADIO_CAD_TX,       // listen-before-talk
+    RADIO_TX,
+} radio_state_t;
+static radio_state_t radio_state = RADIO_IDLE;
+
+static uint32_t duty_period_us = 0;
+static alarm_id_t wake_alarm = 0;
+static int dio1_pin = -1;          // -1 até a primeira recepção intermitente
+static bool lbt_enabled = false;
+static uint8_t lbt_tries = 0;
+static uint32_t rand_state = 1;
+
+// Contabilidade de tempo por modo (índice = valor do modo em RegOpMode)
+static uint8_t radio_mode = MODE_SLEEP;
+static uint64_t mode_since_us = 0;
+static uint64_t mode_time_us[8];
+static uint64_t last_cad_us = 0;
+static lora_power_stats_t power;
+
+// Transferências do FIFO por DMA: um canal envia (dados ou bytes de
+// preenchimento) e outro recebe (dados ou descarte). CS fica ativo do byte de
+// endereço até o fim do canal de recepção, que é sempre o último a terminar.
+#define LORA_FIFO_DMA_MIN 16  // abaixo disso o SPI direto é mais rápido que configurar o DMA
+static int dma_tx_chan = -1;
+static int dma_rx_chan = -1;
+static bool dma_irq_ready = false;
+volatile static bool fifo_busy = false;
+static void (*fifo_done)(void) = NULL;
+static bool dio_pending = false;   // DIO0/DIO1 chegou com o SPI ocupado pelo DMA
+static lora_packet_t *rx_dma_pkt = NULL;
+
+// Fila de transmissão; o pacote em queue[tx_head] é o que está no ar
+typedef struct {
+    uint8_t data[LORA_MAX_PAYLOAD];
+    uint8_t len;
+    lora_tx_callback_t callback;
+    void *user_data;
+} lora_tx_packet_t;
+
+static lora_tx_packet_t tx_queue[LORA_TX_QUEUE_LEN];
+static uint8_t tx_head = 0;
+volatile static uint8_t tx_count = 0;
+static alarm_id_t tx_alarm = 0;
+
+// Pool de buffers de recepção: rx_free tem um bit por buffer livre e
+// rx_ready guarda, em ordem de chegada, os pacotes ainda não entregues
+static lora_packet_t rx_pool[LORA_RX_POOL_LEN];
+volatile static uint32_t rx_free = (1u << LORA_RX_POOL_LEN) - 1;
+static lora_packet_t *rx_ready[LORA_RX_POOL_LEN];
+static uint8_t rx_ready_head = 0;
+volatile static uint8_t rx_ready_count = 0;
+volatile static uint32_t rx_dropped = 0;
 
 // ============================
 // PROTÓTIPOS DE FUNÇÕES PRIVADAS
 // ============================
 static void lora_reset();
 static void lora_write_reg(uint8_t reg, uint8_t value);
+static void lora_write_burst(uint8_t reg, const uint8_t *data, size_t len);
+static void lora_read_burst(uint8_t reg, uint8_t *data, size_t len);
 static uint8_t lora_read_reg(uint8_t reg);
 static void lora_write_fifo(const uint8_t *data, uint8_t len);
 static void lora_read_fifo(uint8_t *data, uint8_t len);
 static void lora_set_mode(uint8_t mode);
+static void lora_rx_continuous_enter(void);
+static void lora_rx_idle_enter(void);
+static void lora_rx_complete(void);
+static void lora_cad_start(radio_state_t purpose);
+static void lora_apply_profile(void);
+static void lora_apply_tx_power(void);
 static void cs_select();
 static void cs_deselect();
-static void dio0_irq_handler(uint gpio, uint32_t events);
-static void handle_dio0_events();
+static void lora_dio_irq_handler(uint gpio, uint32_t events);
+static void lora_dio_process(void);
+static void lora_fifo_dma_init(void);
+static void lora_fifo_transfer(bool write, uint8_t *data, uint8_t len, void (*done)(void));
+static void lora_tx_start(void);
+static void lora_tx_load(void);
+static void lora_tx_finish(lora_tx_status_t status);
 
 // ============================
 // IMPLEMENTAÇÃO DAS FUNÇÕES
@@ -78,6 +178,8 @@ static void handle_dio0_events();
 
 bool lora_init(lora_config_t config) {
     lora = config; // Copia a configuração para a variável estática
+    rand_state = time_us_32() | 1;
+    mode_since_us = time_us_64();
 
     // --- Inicialização do Hardware ---
     spi_init(lora.spi_instance, 5E6);
@@ -89,7 +191,7 @@ bool lora_init(lora_config_t config) {
     
     gpio_init(lora.pin_dio0); gpio_set_dir(lora.pin_dio0, GPIO_IN);
     gpio_pull_down(lora.pin_dio0);
-    gpio_set_irq_enabled_with_callback(lora.pin_dio0, GPIO_IRQ_EDGE_RISE, true, &dio0_irq_handler);
+    gpio_set_irq_enabled_with_callback(lora.pin_dio0, GPIO_IRQ_EDGE_RISE, true, &lora_dio_irq_handler);
 
     lora_reset();
     
@@ -98,94 +200,326 @@ bool lora_init(lora_config_t config) {
 
     lora_write_reg(REG_IRQ_FLAGS, 0xFF); // Limpa todas as flags de IRQ
     
+    // Os três registradores da frequência em uma única transação (o endereço
+    // é incrementado automaticamente pelo rádio)
     uint64_t frf = ((uint64_t)lora.frequency << 19) / 32000000;
-    lora_write_reg(REG_FRF_MSB, (uint8_t)(frf >> 16));
-    lora_write_reg(REG_FRF_MID, (uint8_t)(frf >> 8));
-    lora_write_reg(REG_FRF_LSB, (uint8_t)(frf >> 0));
+    uint8_t frf_regs[3] = { (uint8_t)(frf >> 16), (uint8_t)(frf >> 8), (uint8_t)(frf >> 0) };
+    lora_write_burst(REG_FRF_MSB, frf_regs, sizeof(frf_regs));
 
     // Configurações para longo alcance e robustez
-    lora_write_reg(REG_PA_CONFIG, 0xFF); // PaConfig: Max Power (+17dBm on PA_BOOST)
-    lora_write_reg(REG_PA_DAC, 0x87); // PaDac: Ativa +20dBm
-    lora_write_reg(REG_MODEM_CONFIG_1, 0x78); // ModemConfig1: BW 62.5kHz, CR 4/8
-    lora_write_reg(REG_MODEM_CONFIG_2, 0xC4); // ModemConfig2: SF12, CRC on
-    lora_write_reg(REG_MODEM_CONFIG_3, 0x0C); // ModemConfig3: LDO on, AGC on
-    lora_write_reg(REG_PREAMBLE_MSB, 0x00);
-    lora_write_reg(REG_PREAMBLE_LSB, 0x0C);
+    if (lora.tx_power_dbm != 0) {
+        tx_power = lora.tx_power_dbm;
+    }
+    lora_apply_tx_power();
+    // Modem: BW, CR, SF, preâmbulo, LDRO e sync word vêm do perfil
+    if (lora.profile.sf == 0) {
+        lora_profile_t def = LORA_PROFILE_DEFAULT;
+        lora.profile = def;
+    }
+    profile = lora.profile;
+    lora_apply_profile();
 
     lora_write_reg(0x0B, 0x37); // OCP default
-    lora_write_reg(0x39, 0x12);
 
     // Outras configurações
-    lora_write_reg(REG_FIFO_TX_BASE_ADDR, 0x00);
-    lora_write_reg(REG_FIFO_RX_BASE_ADDR, 0x00);
+    static const uint8_t fifo_base[2] = { 0x00, 0x00 }; // TX e RX começam no início do FIFO
+    lora_write_burst(REG_FIFO_TX_BASE_ADDR, fifo_base, sizeof(fifo_base));
     lora_write_reg(REG_LNA, 0x23); // LNA boost para RX
     lora_write_reg(REG_IRQ_FLAGS_MASK, 0x00); // Libera todas as IRQs
     lora_write_reg(REG_IRQ_FLAGS, 0xFF); // Limpa IRQs
     
     //lora_set_mode(MODE_STDBY);
+
+    lora_fifo_dma_init();
     
     uint8_t version = lora_read_reg(REG_VERSION);
     return (version == 0x12);
 }
 
-bool lora_send(const char *msg) {
-    if (strlen(msg) > 255) return false;
+// Desabilita as interrupções com o SPI livre: uma transferência do FIFO por
+// DMA em andamento termina antes, já que sua conclusão depende da interrupção
+static uint32_t lora_spi_claim(void) {
+    while (true) {
+        uint32_t save = save_and_disable_interrupts();
+        if (!fifo_busy) {
+            return save;
+        }
+        restore_interrupts(save);
+        tight_loop_contents();
+    }
+}
 
-    lora_set_mode(MODE_STDBY); 
-    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
-    lora_write_fifo((const uint8_t*)msg, strlen(msg));
-    lora_write_reg(REG_PAYLOAD_LENGTH, strlen(msg));
+uint32_t lora_spi_transactions(void) {
+    return spi_transactions;
+}
 
-    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
-    lora_write_reg(REG_DIO_MAPPING_1, 0x40); // DIO0 -> TxDone
+bool lora_send_buf_async(const uint8_t *data, size_t len, lora_tx_callback_t callback, void *user_data) {
+    if (len > LORA_MAX_PAYLOAD) return false;
 
-    tx_done = false;
-    lora_set_mode(MODE_TX);
+    uint32_t save = lora_spi_claim();
+    if (tx_count == LORA_TX_QUEUE_LEN) {
+        restore_interrupts(save);
+        return false; // Fila cheia
+    }
 
-    absolute_time_t start_time = get_absolute_time();
-    while (!tx_done) {
-        handle_dio0_events();
-        if (absolute_time_diff_us(start_time, get_absolute_time()) > (TX_TIMEOUT_MS * 1000)) {
-            lora_set_mode(MODE_STDBY); // Aborta TX
-            return false; // Timeout
-        }
+    lora_tx_packet_t *pkt = &tx_queue[(tx_head + tx_count) % LORA_TX_QUEUE_LEN];
+    memcpy(pkt->data, data, len);
+    pkt->len = (uint8_t)len;
+    pkt->callback = callback;
+    pkt->user_data = user_data;
+
+    // Rádio ocioso: transmite já; senão a interrupção do TxDone inicia este pacote
+    if (tx_count++ == 0) {
+        lora_tx_start();
+    }
+    restore_interrupts(save);
+    return true;
+}
+
+bool lora_send_async(const char *msg, lora_tx_callback_t callback, void *user_data) {
+    return lora_send_buf_async((const uint8_t*)msg, strlen(msg), callback, user_data);
+}
+
+bool lora_tx_busy(void) {
+    return tx_count > 0;
+}
+
+static void lora_send_done(lora_tx_status_t status, void *user_data) {
+    *(volatile int *)user_data = (int)status;
+}
+
+bool lora_send_buf(const uint8_t *data, size_t len) {
+    volatile int status = -1;
+    if (len > LORA_MAX_PAYLOAD) return false;
+
+    // Fila cheia: espera uma vaga
+    while (!lora_send_buf_async(data, len, lora_send_done, (void *)&status)) {
         tight_loop_contents();
     }
 
-    lora_set_mode(MODE_STDBY);
-    return true;
+    // Espera o pacote (e os que estavam antes dele na fila) sair
+    while (status < 0) {
+        tight_loop_contents();
+    }
+    return status == LORA_TX_OK;
+}
+
+bool lora_send(const char *msg) {
+    return lora_send_buf((const uint8_t*)msg, strlen(msg));
+}
+
+lora_packet_t *lora_receive_packet(void) {
+    if (crc_error) {
+        crc_error = false;
+        printf("[LORA_LIB] Erro de CRC no pacote!\n");
+    }
+
+    lora_packet_t *pkt = NULL;
+    uint32_t save = save_and_disable_interrupts();
+    if (rx_ready_count > 0) {
+        pkt = rx_ready[rx_ready_head];
+        rx_ready_head = (uint8_t)((rx_ready_head + 1) % LORA_RX_POOL_LEN);
+        rx_ready_count--;
+    }
+    restore_interrupts(save);
+    return pkt;
+}
+
+void lora_packet_release(lora_packet_t *pkt) {
+    uint32_t save = save_and_disable_interrupts();
+    rx_free |= 1u << (pkt - rx_pool);
+    restore_interrupts(save);
+}
+
+uint32_t lora_rx_dropped(void) {
+    return rx_dropped;
+}
+
+void lora_get_radio_stats(lora_radio_stats_t *stats) {
+    uint32_t save = save_and_disable_interrupts();
+    *stats = radio_stats;
+    restore_interrupts(save);
+    stats->rssi_avg_dbm = (int16_t)(rssi_avg_x16 / 16);
+    stats->snr_avg_x4 = (int16_t)(snr_avg_x16 / 16);
 }
 
 int lora_receive(char *buf, size_t maxlen) {
-    handle_dio0_events();
-    if (!rx_done) return 0;
-    rx_done = false;
+    lora_packet_t *pkt = lora_receive_packet();
+    if (!pkt) return 0;
 
-    uint8_t len = lora_read_reg(REG_RX_NB_BYTES);
+    uint8_t len = pkt->len;
     if (len > maxlen - 1) {
         printf("[AVISO] Pacote de %u bytes truncado para %u.\n", len, (unsigned)(maxlen - 1));
         len = (uint8_t)(maxlen - 1);
     }
-
-    uint8_t fifo_addr = lora_read_reg(REG_FIFO_RX_CURRENT_ADDR);
-    lora_write_reg(REG_FIFO_ADDR_PTR, fifo_addr);
-
-    lora_read_fifo((uint8_t*)buf, len);
+    memcpy(buf, pkt->data, len);
     buf[len] = '\0';
+    lora_packet_release(pkt);
 
     return len;
 }
 
-void lora_start_rx_continuous(void) {
+// Chamada com as interrupções desabilitadas ou de dentro delas
+static void lora_rx_continuous_enter(void) {
     lora_write_reg(REG_IRQ_FLAGS, 0xFF);
-    lora_write_reg(REG_DIO_MAPPING_1, 0x00); // DIO0 -> RxDone
+    lora_write_reg(REG_DIO_MAPPING_1, DIO_MAP_RX);
     lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    radio_state = RADIO_RX;
     lora_set_mode(MODE_RX_CONTINUOUS);
 }
 
+// Escreve o perfil atual nos registradores; o rádio deve estar em standby ou sleep
+static void lora_apply_profile(void) {
+    uint8_t modem[3] = {
+        (uint8_t)((profile.bw << 4) | (profile.cr << 1)),   // ModemConfig1: cabeçalho explícito
+        (uint8_t)((profile.sf << 4) | 0x04 | (LORA_RX_SINGLE_SYMB_TIMEOUT >> 8)), // ModemConfig2: CRC on
+        (uint8_t)LORA_RX_SINGLE_SYMB_TIMEOUT,               // SymbTimeoutLsb
+    };
+    uint8_t preamble[2] = { (uint8_t)(profile.preamble_len >> 8), (uint8_t)profile.preamble_len };
+    lora_write_burst(REG_MODEM_CONFIG_1, modem, sizeof(modem));
+    lora_write_burst(REG_PREAMBLE_MSB, preamble, sizeof(preamble));
+    lora_write_reg(REG_MODEM_CONFIG_3, (uint8_t)((lora_profile_ldro(&profile) ? 0x08 : 0x00) | 0x04)); // AGC on
+    lora_write_reg(REG_SYNC_WORD, profile.sync_word);
+}
+
+// PA_BOOST: Pout = 17 - (15 - OutputPower) dBm; com o PaDac em alta potência
+// a mesma escala vai até +20 dBm (Pout = 20 - (15 - OutputPower))
+static void lora_apply_tx_power(void) {
+    if (tx_power > 17) {
+        lora_write_reg(REG_PA_DAC, 0x87);
+        lora_write_reg(REG_PA_CONFIG, (uint8_t)(0xF0 | (tx_power - 5)));
+    } else {
+        lora_write_reg(REG_PA_DAC, 0x84);
+        lora_write_reg(REG_PA_CONFIG, (uint8_t)(0xF0 | (tx_power - 2)));
+    }
+}
+
+bool lora_set_tx_power(int8_t dbm) {
+    if (dbm < LORA_TX_POWER_MIN || dbm > LORA_TX_POWER_MAX) return false;
+
+    uint32_t save = lora_spi_claim();
+    if (tx_count > 0) {
+        restore_interrupts(save);
+        return false;
+    }
+    tx_power = dbm;
+    lora_apply_tx_power();
+    restore_interrupts(save);
+    return true;
+}
+
+int8_t lora_get_tx_power(void) {
+    return tx_power;
+}
+
+void lora_get_profile(lora_profile_t *p) {
+    *p = profile;
+}
+
+bool lora_set_profile(const lora_profile_t *p) {
+    if (!lora_profile_valid(p)) return false;
+
+    uint32_t save = lora_spi_claim();
+    if (tx_count > 0) {
+        restore_interrupts(save);
+        return false;
+    }
+    profile = *p;
+    lora_set_mode(MODE_STDBY);
+    lora_apply_profile();
+    lora_rx_idle_enter();
+    restore_interrupts(save);
+    return true;
+}
+
+uint32_t lora_time_on_air_us(size_t payload_len) {
+    return lora_profile_time_on_air_us(&profile, payload_len);
+}
+
+void lora_start_rx_continuous(void) {
+    uint32_t save = lora_spi_claim();
+    rx_mode = RX_CONTINUOUS;
+    // Se houver transmissão em andamento, a recepção começa quando a fila esvaziar
+    if (tx_count == 0) {
+        lora_rx_idle_enter();
+    }
+    restore_interrupts(save);
+}
+
+bool lora_start_rx_duty_cycle(uint32_t period_ms, uint pin_dio1) {
+    if (period_ms == 0) return false;
+    if (dio1_pin >= 0 && (uint)dio1_pin != pin_dio1) return false;
+
+    // O DIO1 só é configurado aqui, já que nem toda placa o tem ligado
+    if (dio1_pin < 0) {
+        gpio_init(pin_dio1); gpio_set_dir(pin_dio1, GPIO_IN);
+        gpio_pull_down(pin_dio1);
+        gpio_set_irq_enabled(pin_dio1, GPIO_IRQ_EDGE_RISE, true); // mesma callback do DIO0
+        dio1_pin = (int)pin_dio1;
+    }
+
+    uint32_t save = lora_spi_claim();
+    rx_mode = RX_DUTY_CYCLE;
+    duty_period_us = period_ms * 1000;
+    if (tx_count == 0) {
+        lora_rx_idle_enter();
+    }
+    restore_interrupts(save);
+    return true;
+}
+
+uint16_t lora_duty_cycle_preamble_len(uint32_t period_ms) {
+    // O preâmbulo precisa cobrir o período inteiro mais o próprio CAD (~2 símbolos)
+    uint64_t tsym_us = lora_profile_symbol_us(&profile);
+    uint64_t symbols = ((uint64_t)period_ms * 1000 + tsym_us - 1) / tsym_us + 4;
+    return symbols > 0xFFFF ? 0xFFFF : (uint16_t)symbols;
+}
+
+void lora_stop_rx(void) {
+    uint32_t save = lora_spi_claim();
+    rx_mode = RX_OFF;
+    if (tx_count == 0) {
+        lora_rx_idle_enter();
+    }
+    restore_interrupts(save);
+}
+
+void lora_set_listen_before_talk(bool enabled) {
+    lbt_enabled = enabled;
+}
+
+void lora_get_power_stats(lora_power_stats_t *stats) {
+    // Correntes típicas do SX1276 (µA), com LNA boost e PA_BOOST em +20 dBm
+    static const uint32_t mode_current_ua[8] = {
+        [MODE_SLEEP] = 1, [MODE_STDBY] = 1600, [0x02] = 5800, [MODE_TX] = 120000,
+        [0x04] = 5800, [MODE_RX_CONTINUOUS] = 11500, [MODE_RX_SINGLE] = 11500, [MODE_CAD] = 11500,
+    };
+
+    uint32_t save = save_and_disable_interrupts();
+    uint64_t t[8];
+    memcpy(t, mode_time_us, sizeof(t));
+    t[radio_mode] += time_us_64() - mode_since_us; // modo atual, até agora
+    *stats = power;
+    restore_interrupts(save);
+
+    stats->sleep_us = t[MODE_SLEEP];
+    stats->standby_us = t[MODE_STDBY];
+    stats->rx_us = t[MODE_RX_CONTINUOUS] + t[MODE_RX_SINGLE];
+    stats->cad_us = t[MODE_CAD];
+    stats->tx_us = t[MODE_TX];
+
+    uint64_t total_us = 0;
+    uint64_t charge = 0; // µA·µs
+    for (uint i = 0; i < 8; i++) {
+        total_us += t[i];
+        charge += t[i] * mode_current_ua[i];
+    }
+    stats->avg_current_ua = total_us ? (uint32_t)(charge / total_us) : 0;
+}
+
 // --- Funções Privadas ---
 
-static void cs_select() { gpio_put(lora.pin_cs, 0); }
+static void cs_select() { gpio_put(lora.pin_cs, 0); spi_transactions++; }
 static void cs_deselect() { gpio_put(lora.pin_cs, 1); }
 
 static void lora_reset() {
@@ -209,6 +543,22 @@ static uint8_t lora_read_reg(uint8_t reg) {
     return rx[1];
 }
 
+static void lora_write_burst(uint8_t reg, const uint8_t *data, size_t len) {
+    uint8_t addr = (uint8_t)(reg | 0x80);
+    cs_select();
+    spi_write_blocking(lora.spi_instance, &addr, 1);
+    spi_write_blocking(lora.spi_instance, data, len);
+    cs_deselect();
+}
+
+static void lora_read_burst(uint8_t reg, uint8_t *data, size_t len) {
+    uint8_t addr = reg & 0x7F;
+    cs_select();
+    spi_write_blocking(lora.spi_instance, &addr, 1);
+    spi_read_blocking(lora.spi_instance, 0x00, data, len);
+    cs_deselect();
+}
+
 static void lora_write_fifo(const uint8_t *data, uint8_t len) {
     cs_select();
     uint8_t addr = REG_FIFO | 0x80;
@@ -225,27 +575,395 @@ static void lora_read_fifo(uint8_t *data, uint8_t len) {
     cs_deselect();
 }
 
+// Também soma o tempo passado no modo anterior. TX, RX_SINGLE e CAD voltam
+// sozinhos para standby ao terminar; esse trecho é contado no modo anterior,
+// mas dura só até o tratamento da interrupção.
 static void lora_set_mode(uint8_t mode) {
+    uint64_t now = time_us_64();
+    mode_time_us[radio_mode] += now - mode_since_us;
+    mode_since_us = now;
+    radio_mode = mode;
     lora_write_reg(REG_OP_MODE, (0x80 | mode)); // Bit 7 (LongRangeMode) sempre deve ser 1
 }
 
-static void dio0_irq_handler(uint gpio, uint32_t events) {
-    (void)gpio; (void)events;
-    dio0_event = true;
+// --- Transferências do FIFO por DMA ---
+
+static void lora_fifo_dma_irq_handler(void) {
+    if (dma_rx_chan < 0 || !dma_channel_get_irq0_status((uint)dma_rx_chan)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0((uint)dma_rx_chan);
+
+    cs_deselect();
+    fifo_busy = false;
+    void (*done)(void) = fifo_done;
+    fifo_done = NULL;
+    if (done) {
+        done();
+    }
+
+    // Um DIO0/DIO1 que chegou durante a transferência é tratado agora
+    if (dio_pending && !fifo_busy) {
+        dio_pending = false;
+        lora_dio_process();
+    }
+}
+
+static void lora_fifo_dma_init(void) {
+    if (dma_tx_chan < 0) {
+        dma_tx_chan = dma_claim_unused_channel(false);
+    }
+    if (dma_rx_chan < 0) {
+        dma_rx_chan = dma_claim_unused_channel(false);
+    }
+    if (dma_tx_chan < 0 || dma_rx_chan < 0) {
+        return; // Sem canais livres: o FIFO continua sendo lido pela CPU
+    }
+
+    // DMA_IRQ_0 pode ser usada por outras bibliotecas, por isso o handler é compartilhado
+    if (!dma_irq_ready) {
+        irq_add_shared_handler(DMA_IRQ_0, lora_fifo_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        dma_irq_ready = true;
+    }
+    dma_channel_set_irq0_enabled((uint)dma_rx_chan, true);
+}
+
+// Lê ou escreve len bytes do FIFO e chama done ao terminar. Com DMA, done é
+// chamada depois, de dentro da interrupção do DMA; pacotes pequenos (ou sem
+// canais de DMA) são transferidos na hora pela CPU.
+static void lora_fifo_transfer(bool write, uint8_t *data, uint8_t len, void (*done)(void)) {
+    if (dma_rx_chan < 0 || len < LORA_FIFO_DMA_MIN) {
+        if (write) {
+            lora_write_fifo(data, len);
+        } else {
+            lora_read_fifo(data, len);
+        }
+        done();
+        return;
+    }
+
+    static uint8_t dummy_tx = 0x00;
+    static uint8_t dummy_rx;
+    spi_inst_t *spi = lora.spi_instance;
+
+    fifo_busy = true;
+    fifo_done = done;
+
+    uint8_t addr = write ? (REG_FIFO | 0x80) : (REG_FIFO & 0x7F);
+    cs_select();
+    spi_write_blocking(spi, &addr, 1);
+
+    dma_channel_config tx_cfg = dma_channel_get_default_config((uint)dma_tx_chan);
+    channel_config_set_transfer_data_size(&tx_cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&tx_cfg, write);
+    channel_config_set_write_increment(&tx_cfg, false);
+    channel_config_set_dreq(&tx_cfg, spi_get_dreq(spi, true));
+
+    dma_channel_config rx_cfg = dma_channel_get_default_config((uint)dma_rx_chan);
+    channel_config_set_transfer_data_size(&rx_cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx_cfg, false);
+    channel_config_set_write_increment(&rx_cfg, !write);
+    channel_config_set_dreq(&rx_cfg, spi_get_dreq(spi, false));
+
+    dma_channel_configure((uint)dma_rx_chan, &rx_cfg, write ? &dummy_rx : data, &spi_get_hw(spi)->dr, len, false);
+    dma_channel_configure((uint)dma_tx_chan, &tx_cfg, &spi_get_hw(spi)->dr, write ? data : &dummy_tx, len, false);
+
+    // Os dois canais partem juntos para o RX nunca perder um byte
+    dma_start_channel_mask((1u << dma_tx_chan) | (1u << dma_rx_chan));
+}
+
+// --- Máquina de estados de transmissão ---
+// Executada com as interrupções desabilitadas (quando chamada do laço principal)
+// ou dentro das interrupções do DIO0/DIO1 e dos alarmes.
+
+static uint32_t lora_rand(void) {
+    uint32_t x = rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rand_state = x;
+    return x;
+}
+
+static int64_t lora_tx_timeout(alarm_id_t id, void *user_data) {
+    (void)id; (void)user_data;
+    tx_alarm = 0;
+    lora_set_mode(MODE_STDBY); // Aborta TX
+    lora_tx_finish(LORA_TX_TIMEOUT);
+    return 0;
+}
+
+// Segunda metade de lora_tx_load(), com o payload já no FIFO
+static void lora_tx_fifo_loaded(void) {
+    lora_tx_packet_t *pkt = &tx_queue[tx_head];
+
+    lora_write_reg(REG_PAYLOAD_LENGTH, pkt->len);
+
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+    lora_write_reg(REG_DIO_MAPPING_1, DIO_MAP_TX);
+
+    lora_set_mode(MODE_TX);
+    uint32_t toa_us = lora_time_on_air_us(pkt->len);
+    tx_alarm = add_alarm_in_us(toa_us + toa_us / 4 + TX_TIMEOUT_MARGIN_MS * 1000, lora_tx_timeout, NULL, true);
+}
+
+// Carrega o pacote do início da fila no FIFO e entra em TX
+static void lora_tx_load(void) {
+    lora_tx_packet_t *pkt = &tx_queue[tx_head];
+
+    radio_state = RADIO_TX;
+    lora_set_mode(MODE_STDBY);
+    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    lora_fifo_transfer(true, pkt->data, pkt->len, lora_tx_fifo_loaded);
+}
+
+// Inicia o pacote do início da fila, escutando o canal antes se o LBT estiver ligado
+static void lora_tx_start(void) {
+    if (lbt_enabled) {
+        lora_cad_start(RADIO_CAD_TX);
+    } else {
+        lora_tx_load();
+    }
+}
+
+static int64_t lora_lbt_retry(alarm_id_t id, void *user_data) {
+    (void)id; (void)user_data;
+    if (fifo_busy) {
+        return 1000; // SPI ocupado pelo DMA: tenta de novo em 1 ms
+    }
+    tx_alarm = 0;
+    lora_tx_start();
+    return 0;
+}
+
+// Resultado do CAD do listen-before-talk
+static void lora_lbt_cad_done(bool detected) {
+    if (!detected) {
+        lora_tx_load();
+        return;
+    }
+
+    power.lbt_busy++;
+    if (++lbt_tries >= LORA_LBT_MAX_TRIES) {
+        lora_set_mode(MODE_STDBY);
+        lora_tx_finish(LORA_TX_CHANNEL_BUSY);
+        return;
+    }
+
+    // Enquanto espera, o rádio volta ao modo de recepção (o pacote no ar pode ser para nós).
+    // A espera é sorteada entre meio e um e meio tempo no ar do próprio pacote.
+    lora_rx_idle_enter();
+    uint32_t toa_us = lora_time_on_air_us(tx_queue[tx_head].len);
+    tx_alarm = add_alarm_in_us(toa_us / 2 + lora_rand() % toa_us, lora_lbt_retry, NULL, true);
+}
+
+// Encerra o pacote atual, avisa o dono e passa para o próximo
+static void lora_tx_finish(lora_tx_status_t status) {
+    lora_tx_packet_t *pkt = &tx_queue[tx_head];
+    lora_tx_callback_t callback = pkt->callback;
+    void *user_data = pkt->user_data;
+
+    tx_head = (uint8_t)((tx_head + 1) % LORA_TX_QUEUE_LEN);
+    tx_count--;
+    lbt_tries = 0;
+
+    if (status == LORA_TX_OK) {
+        radio_stats.tx_packets++;
+    } else if (status == LORA_TX_TIMEOUT) {
+        radio_stats.tx_timeouts++;
+    } else {
+        radio_stats.tx_channel_busy++;
+    }
+
+    if (tx_count > 0) {
+        lora_tx_start();
+    } else {
+        lora_rx_idle_enter();
+    }
+
+    if (callback) {
+        callback(status, user_data);
+    }
+}
+
+// --- Recepção contínua e intermitente ---
+
+static int64_t lora_duty_wake(alarm_id_t id, void *user_data) {
+    (void)id; (void)user_data;
+    if (fifo_busy) {
+        return 1000; // SPI ocupado pelo DMA: tenta de novo em 1 ms
+    }
+    wake_alarm = 0;
+    // Transmitindo ou já recebendo: quem terminar reagenda a escuta
+    if (rx_mode == RX_DUTY_CYCLE && radio_state == RADIO_IDLE && tx_count == 0) {
+        lora_cad_start(RADIO_CAD_RX);
+    }
+    return 0;
+}
+
+// Coloca o rádio no modo de recepção escolhido pela aplicação
+static void lora_rx_idle_enter(void) {
+    if (wake_alarm > 0) {
+        cancel_alarm(wake_alarm);
+        wake_alarm = 0;
+    }
+
+    switch (rx_mode) {
+    case RX_CONTINUOUS:
+        lora_rx_continuous_enter();
+        break;
+    case RX_DUTY_CYCLE:
+        radio_state = RADIO_IDLE;
+        lora_set_mode(MODE_SLEEP);
+        wake_alarm = add_alarm_in_us(duty_period_us, lora_duty_wake, NULL, true);
+        break;
+    default:
+        radio_state = RADIO_IDLE;
+        lora_set_mode(MODE_STDBY);
+        break;
+    }
+}
+
+// Detecção de atividade no canal; termina com CadDone (DIO0) e, se havia preâmbulo, CadDetected (DIO1)
+static void lora_cad_start(radio_state_t purpose) {
+    uint64_t now = time_us_64();
+    if (purpose == RADIO_CAD_RX) {
+        if (last_cad_us > 0 && now - last_cad_us > power.max_listen_gap_us) {
+            power.max_listen_gap_us = (uint32_t)(now - last_cad_us);
+        }
+        last_cad_us = now;
+    }
+    power.cad_count++;
+
+    radio_state = purpose;
+    lora_set_mode(MODE_STDBY);
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+    lora_write_reg(REG_DIO_MAPPING_1, DIO_MAP_CAD);
+    lora_set_mode(MODE_CAD);
 }
 
-static void handle_dio0_events() {
-    if (!dio0_event) return;
-    dio0_event = false;
+// Depois de um CAD positivo: recebe um pacote, com timeout de LORA_RX_SINGLE_SYMB_TIMEOUT símbolos
+static void lora_rx_single_enter(void) {
+    lora_write_reg(REG_IRQ_FLAGS, 0xFF);
+    lora_write_reg(REG_DIO_MAPPING_1, DIO_MAP_RX);
+    lora_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    radio_state = RADIO_RX_SINGLE;
+    lora_set_mode(MODE_RX_SINGLE);
+}
+
+static void lora_cad_done(bool detected) {
+    if (detected) {
+        power.cad_detected++;
+    }
+    if (radio_state == RADIO_CAD_TX) {
+        lora_lbt_cad_done(detected);
+    } else if (radio_state == RADIO_CAD_RX) {
+        if (detected) {
+            lora_rx_single_enter();
+        } else {
+            lora_rx_idle_enter();
+        }
+    }
+}
+
+// Fim de uma recepção (pacote guardado, descartado, com erro ou timeout): na
+// recepção intermitente o rádio volta a dormir; na contínua ele segue recebendo
+static void lora_rx_complete(void) {
+    if (radio_state == RADIO_RX_SINGLE) {
+        lora_rx_idle_enter();
+    }
+}
+
+// Segunda metade de lora_rx_store(), com o payload já no buffer
+static void lora_rx_stored(void) {
+    rx_ready[(rx_ready_head + rx_ready_count) % LORA_RX_POOL_LEN] = rx_dma_pkt;
+    rx_ready_count++;
+    rx_dma_pkt = NULL;
+    lora_rx_complete();
+}
 
+// Copia o pacote recebido do FIFO para um buffer livre do pool
+static void lora_rx_store(void) {
+    if (rx_free == 0) {
+        rx_dropped++;
+        lora_rx_complete();
+        return;
+    }
+    uint idx = (uint)__builtin_ctz(rx_free);
+    rx_free &= ~(1u << idx);
+    lora_packet_t *pkt = &rx_pool[idx];
+
+    // RegFifoRxCurrentAddr (0x10) a RegRxNbBytes (0x13) e RegPktSnrValue (0x19)
+    // a RegPktRssiValue (0x1A), cada grupo em uma transação
+    uint8_t regs[4];
+    uint8_t quality[2];
+    lora_read_burst(REG_FIFO_RX_CURRENT_ADDR, regs, sizeof(regs));
+    lora_read_burst(REG_PKT_SNR_VALUE, quality, sizeof(quality));
+
+    // RSSI do pacote (datasheet 5.5.5): a constante depende da porta de RF
+    // usada; abaixo de 0 dB de SNR o ruído entra na conta
+    int8_t snr = (int8_t)quality[0];
+    int16_t rssi = (int16_t)quality[1] - (lora.frequency < 525E6 ? 164 : 157);
+    if (snr < 0) {
+        rssi += snr / 4;
+    }
+    pkt->snr_x4 = snr;
+    pkt->rssi_dbm = rssi;
+
+    // Médias exponenciais; o primeiro pacote inicializa as duas
+    if (radio_stats.rx_packets++ == 0) {
+        rssi_avg_x16 = rssi * 16;
+        snr_avg_x16 = snr * 16;
+    } else {
+        rssi_avg_x16 += (rssi * 16 - rssi_avg_x16) / 8;
+        snr_avg_x16 += (snr * 16 - snr_avg_x16) / 8;
+    }
+    radio_stats.rssi_last_dbm = rssi;
+    radio_stats.snr_last_x4 = snr;
+    pkt->timestamp_us = time_us_64();
+    pkt->len = regs[REG_RX_NB_BYTES - REG_FIFO_RX_CURRENT_ADDR];
+
+    lora_write_reg(REG_FIFO_ADDR_PTR, regs[0]);
+    rx_dma_pkt = pkt;
+    lora_fifo_transfer(false, pkt->data, pkt->len, lora_rx_stored);
+}
+
+// DIO0 e DIO1 compartilham o tratamento: o motivo vem de RegIrqFlags
+static void lora_dio_irq_handler(uint gpio, uint32_t events) {
+    (void)events;
+    if (gpio != lora.pin_dio0 && (int)gpio != dio1_pin) {
+        return;
+    }
+
+    // SPI ocupado pelo DMA: o evento é tratado quando a transferência terminar
+    if (fifo_busy) {
+        dio_pending = true;
+        return;
+    }
+    lora_dio_process();
+}
+
+static void lora_dio_process(void) {
     uint8_t irq_flags = lora_read_reg(REG_IRQ_FLAGS);
     lora_write_reg(REG_IRQ_FLAGS, 0xFF); // Limpa todas as flags escrevendo 1s
 
-    if ((irq_flags & IRQ_RX_DONE_MASK) && !(irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK)) {
-        rx_done = true;
-    } else if (irq_flags & IRQ_TX_DONE_MASK) {
-        tx_done = true;
+    if (irq_flags & IRQ_CAD_DONE_MASK) {
+        lora_cad_done((irq_flags & IRQ_CAD_DETECTED_MASK) != 0);
+    } else if ((irq_flags & IRQ_RX_DONE_MASK) && !(irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK)) {
+        lora_rx_store();
+    } else if ((irq_flags & IRQ_TX_DONE_MASK) && tx_count > 0) {
+        if (tx_alarm > 0) {
+            cancel_alarm(tx_alarm);
+            tx_alarm = 0;
+        }
+        lora_tx_finish(LORA_TX_OK);
     } else if (irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK) {
-        printf("[LORA_LIB] Erro de CRC no pacote!\n");
+        crc_error = true; // Informado pelo laço principal em lora_receive_packet()
+        radio_stats.crc_errors++;
+        lora_rx_complete();
+    } else if (irq_flags & IRQ_RX_TIMEOUT_MASK) {
+        power.rx_timeouts++;
+        lora_rx_complete();
     }
-}
\ No newline at end of file
+}
@@ -7,11 +7,51 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "hardware/spi.h"
+#include "lora_profile.h"
 
 // ============================
 // CONFIGURAÇÕES DE TEMPO (ms)
 // ============================
-#define TX_TIMEOUT_MS       5000   // tempo máximo esperando TxDone
+#define TX_TIMEOUT_MARGIN_MS 100   // folga sobre o tempo no ar esperando TxDone
+
+// Listen-before-talk: tentativas de CAD antes de desistir do pacote
+#define LORA_LBT_MAX_TRIES  5
+
+// Símbolos que o RX_SINGLE espera pelo preâmbulo depois de um CAD positivo
+#define LORA_RX_SINGLE_SYMB_TIMEOUT 16
+
+// Quantidade de pacotes que podem aguardar transmissão
+#define LORA_TX_QUEUE_LEN   4
+
+// Quantidade de buffers de recepção pré-alocados
+#define LORA_RX_POOL_LEN    4
+
+// Tamanho máximo do payload (limite do FIFO)
+#define LORA_MAX_PAYLOAD    255
+
+// Potência de transmissão usada até aqui (PA_BOOST com PaDac em alta potência)
+#define LORA_TX_POWER_DEFAULT 20
+#define LORA_TX_POWER_MIN     2
+#define LORA_TX_POWER_MAX     20
+
+// Pacote recebido, entregue sem cópia a partir do pool de buffers
+typedef struct {
+    uint8_t data[LORA_MAX_PAYLOAD];
+    uint8_t len;
+    int16_t rssi_dbm;       // RSSI do pacote
+    int8_t snr_x4;          // SNR do pacote, em quartos de dB
+    uint64_t timestamp_us;  // Momento do RxDone
+} lora_packet_t;
+
+// Resultado de uma transmissão assíncrona
+typedef enum {
+    LORA_TX_OK = 0,
+    LORA_TX_TIMEOUT,    // TxDone não chegou no tempo no ar do pacote mais a folga
+    LORA_TX_CHANNEL_BUSY, // canal ocupado em todas as LORA_LBT_MAX_TRIES tentativas
+} lora_tx_status_t;
+
+// Chamada no contexto de interrupção quando um pacote termina de ser transmitido
+typedef void (*lora_tx_callback_t)(lora_tx_status_t status, void *user_data);
 
 // Struct de configuração para tornar a biblioteca mais portável
 typedef struct {
@@ -23,8 +63,39 @@ typedef struct {
     uint pin_rst;
     uint pin_dio0;
     long frequency; // Frequência em Hz (ex: 915E6)
+    lora_profile_t profile; // Perfil do modem (zerado = LORA_PROFILE_DEFAULT)
+    int8_t tx_power_dbm;    // Potência no PA_BOOST, 2 a 20 dBm (zero = LORA_TX_POWER_DEFAULT)
 } lora_config_t;
 
+// Qualidade do enlace vista pelo rádio. As médias são exponenciais (peso 1/8
+// para o pacote mais recente), então acompanham a variação do canal sem janela.
+typedef struct {
+    uint32_t rx_packets;
+    uint32_t crc_errors;
+    uint32_t tx_packets;        // transmitidos com TxDone
+    uint32_t tx_timeouts;
+    uint32_t tx_channel_busy;   // desistências do listen-before-talk
+    int16_t rssi_last_dbm;
+    int8_t snr_last_x4;
+    int16_t rssi_avg_dbm;
+    int16_t snr_avg_x4;
+} lora_radio_stats_t;
+
+// Tempo em cada modo do rádio e consumo estimado, para comparar os modos de recepção
+typedef struct {
+    uint64_t sleep_us;
+    uint64_t standby_us;
+    uint64_t rx_us;             // recepção contínua e RX_SINGLE
+    uint64_t cad_us;
+    uint64_t tx_us;
+    uint32_t avg_current_ua;    // média desde o boot, com as correntes típicas do datasheet
+    uint32_t cad_count;         // escutas do canal (recepção intermitente e LBT)
+    uint32_t cad_detected;      // escutas que encontraram preâmbulo
+    uint32_t rx_timeouts;       // CAD positivo sem pacote (falso alarme ou pacote de outra rede)
+    uint32_t lbt_busy;          // CADs do LBT com o canal ocupado
+    uint32_t max_listen_gap_us; // maior intervalo entre duas escutas: limite da latência de despertar
+} lora_power_stats_t;
+
 /**
  * @brief Inicializa o módulo LoRa com as configurações fornecidas.
  * * @param config A struct com as configurações de pinos, SPI e frequência.
@@ -33,12 +104,73 @@ typedef struct {
 bool lora_init(lora_config_t config);
 
 /**
- * @brief Envia uma mensagem de texto via LoRa.
+ * @brief Troca o perfil do modem (SF, BW, CR, preâmbulo, LDRO e sync word).
+ * Deve ser chamada sem transmissão em andamento; a recepção contínua, se
+ * ativa, é retomada com o novo perfil.
+ * @return false se os parâmetros são inválidos ou há pacotes na fila de TX.
+ */
+bool lora_set_profile(const lora_profile_t *profile);
+
+/**
+ * @brief Retorna o perfil do modem em uso.
+ */
+void lora_get_profile(lora_profile_t *profile);
+
+/**
+ * @brief Ajusta a potência de transmissão (LORA_TX_POWER_MIN a LORA_TX_POWER_MAX dBm).
+ * @return false se o valor é inválido ou há pacotes na fila de TX.
+ */
+bool lora_set_tx_power(int8_t dbm);
+
+/**
+ * @brief Potência de transmissão atual, em dBm.
+ */
+int8_t lora_get_tx_power(void);
+
+/**
+ * @brief Calcula o tempo no ar de um pacote com o perfil atual.
+ * Segue a fórmula do datasheet (cabeçalho explícito, CRC ligado).
+ * * @param payload_len Tamanho do payload, em bytes.
+ * @return O tempo no ar, em microssegundos.
+ */
+uint32_t lora_time_on_air_us(size_t payload_len);
+
+/**
+ * @brief Envia uma mensagem de texto via LoRa e espera o fim da transmissão.
  * * @param msg A mensagem a ser enviada (string terminada em nulo).
  * @return true se o envio foi iniciado com sucesso, false em caso de erro.
  */
 bool lora_send(const char *msg);
 
+/**
+ * @brief Envia um payload binário (pode conter zeros) e espera o fim da transmissão.
+ * * @param data Os bytes a serem enviados.
+ * @param len A quantidade de bytes (até LORA_MAX_PAYLOAD).
+ * @return true se o pacote foi transmitido, false em caso de erro ou timeout.
+ */
+bool lora_send_buf(const uint8_t *data, size_t len);
+
+/**
+ * @brief Versão assíncrona de lora_send_buf(); ver lora_send_async().
+ */
+bool lora_send_buf_async(const uint8_t *data, size_t len, lora_tx_callback_t callback, void *user_data);
+
+/**
+ * @brief Coloca uma mensagem na fila de transmissão e retorna imediatamente.
+ * A interrupção do DIO0 (TxDone) encerra cada pacote e inicia o próximo da
+ * fila; ao esvaziar a fila o rádio volta à recepção contínua, se ela estava ativa.
+ * * @param msg A mensagem a ser enviada (string terminada em nulo); é copiada.
+ * @param callback Chamada ao final da transmissão (pode ser NULL).
+ * @param user_data Ponteiro repassado à callback.
+ * @return false se a mensagem é grande demais ou a fila está cheia.
+ */
+bool lora_send_async(const char *msg, lora_tx_callback_t callback, void *user_data);
+
+/**
+ * @brief Indica se há pacotes transmitindo ou na fila.
+ */
+bool lora_tx_busy(void);
+
 /**
  * @brief Tenta receber uma mensagem LoRa. Função não bloqueante.
  * * @param buf Buffer para armazenar a mensagem recebida.
@@ -47,10 +179,76 @@ bool lora_send(const char *msg);
  */
 int lora_receive(char *buf, size_t maxlen);
 
+/**
+ * @brief Retorna o próximo pacote recebido, sem copiar. Função não bloqueante.
+ * O pacote é lido do FIFO pela interrupção do RxDone para um buffer do pool e
+ * pertence ao chamador até lora_packet_release().
+ * @return O pacote, ou NULL se nenhum pacote foi recebido.
+ */
+lora_packet_t *lora_receive_packet(void);
+
+/**
+ * @brief Devolve ao pool um pacote obtido com lora_receive_packet().
+ */
+void lora_packet_release(lora_packet_t *pkt);
+
+/**
+ * @brief Pacotes descartados porque todos os buffers do pool estavam em uso.
+ */
+uint32_t lora_rx_dropped(void);
+
+/**
+ * @brief Retorna os contadores e as médias de RSSI/SNR do enlace.
+ */
+void lora_get_radio_stats(lora_radio_stats_t *stats);
+
+/**
+ * @brief Número de transações SPI (ativações do CS) desde o boot.
+ * Útil para medir o custo da inicialização e de cada pacote.
+ */
+uint32_t lora_spi_transactions(void);
+
 /**
  * @brief Coloca o rádio em modo de recepção contínua.
  */
 void lora_start_rx_continuous(void);
 
+/**
+ * @brief Recepção intermitente: o rádio dorme e, a cada period_ms, faz um CAD
+ * (detecção de atividade no canal, cerca de 2 símbolos). Só quando há preâmbulo
+ * no ar ele entra em RX_SINGLE para receber o pacote, voltando a dormir depois
+ * do RxDone ou do RxTimeout (DIO1). O transmissor precisa de um preâmbulo mais
+ * longo que o período, ver lora_duty_cycle_preamble_len().
+ * O DIO1 só é usado aqui, então o pino vem como parâmetro e não na
+ * lora_config_t: placas sem o DIO1 ligado não chamam esta função.
+ * * @param period_ms Intervalo entre as escutas; é o pior caso da latência de despertar.
+ * @param pin_dio1 GPIO ligado ao DIO1 (RxTimeout/CadDetected).
+ * @return false se o período é zero ou se outro pino já foi configurado como DIO1.
+ */
+bool lora_start_rx_duty_cycle(uint32_t period_ms, uint pin_dio1);
+
+/**
+ * @brief Preâmbulo (em símbolos, para o perfil atual) que garante que um pacote
+ * seja percebido por um receptor em lora_start_rx_duty_cycle(period_ms, ...).
+ * Deve ser usado no preamble_len do perfil dos dois lados.
+ */
+uint16_t lora_duty_cycle_preamble_len(uint32_t period_ms);
+
+/**
+ * @brief Encerra a recepção (contínua ou intermitente); o rádio fica em standby.
+ */
+void lora_stop_rx(void);
+
+/**
+ * @brief Liga o listen-before-talk: antes de cada pacote é feito um CAD e, com
+ * o canal ocupado, a transmissão é adiada por um tempo sorteado.
+ */
+void lora_set_listen_before_talk(bool enabled);
+
+/**
+ * @brief Retorna o tempo passado em cada modo e as estatísticas de escuta.
+ */
+void lora_get_power_stats(lora_power_stats_t *stats);
+
 
 #endif // LORA_RFM95_H_
\ No newline at end of file
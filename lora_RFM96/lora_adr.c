@@ -0,0 +1,147 @@
+// lora_adr.c
+
+#include <string.h>
+#include "lora_adr.h"
+
+const lora_profile_t lora_adr_steps[LORA_ADR_STEPS] = {
+    {  7, LORA_BW_125_KHZ,  LORA_CR_4_5, 12, LORA_LDRO_AUTO, 0x12 },
+    {  8, LORA_BW_125_KHZ,  LORA_CR_4_5, 12, LORA_LDRO_AUTO, 0x12 },
+    {  9, LORA_BW_125_KHZ,  LORA_CR_4_5, 12, LORA_LDRO_AUTO, 0x12 },
+    { 10, LORA_BW_125_KHZ,  LORA_CR_4_5, 12, LORA_LDRO_AUTO, 0x12 },
+    { 11, LORA_BW_125_KHZ,  LORA_CR_4_5, 12, LORA_LDRO_AUTO, 0x12 },
+    { 12, LORA_BW_125_KHZ,  LORA_CR_4_5, 12, LORA_LDRO_AUTO, 0x12 },
+    LORA_PROFILE_DEFAULT,
+};
+
+#define LORA_ADR_ROBUST (LORA_ADR_STEPS - 1)
+
+// SNR mínimo para demodular, em quartos de dB: -7,5 dB no SF7 e 2,5 dB a menos por SF
+static int lora_adr_floor_x4(const lora_profile_t *p) {
+    return -10 * ((int)p->sf - 4);
+}
+
+// O ruído cresce com a banda: o mesmo sinal tem 3 dB a mais de SNR a cada
+// metade da banda. Leva o SNR medido com bw para o equivalente em 125 kHz.
+static int lora_adr_bw_offset_x4(lora_bw_t bw) {
+    return ((int)LORA_BW_125_KHZ - (int)bw) * 12;
+}
+
+bool lora_adr_init_radio(lora_adr_t *adr, const lora_adr_radio_t *radio_ops, void *radio) {
+    memset(adr, 0, sizeof(*adr));
+    adr->radio_ops = radio_ops;
+    adr->radio = radio;
+    adr->step = LORA_ADR_ROBUST;
+    adr->target_step = LORA_ADR_ROBUST;
+    adr->tx_power_dbm = LORA_TX_POWER_MAX;
+    adr->last_rx_us = radio_ops->now_us(radio);
+    adr->crc_errors_base = radio_ops->crc_errors(radio);
+
+    return radio_ops->set_profile(radio, &lora_adr_steps[adr->step]) &&
+           radio_ops->set_tx_power(radio, adr->tx_power_dbm);
+}
+
+void lora_adr_on_packet(lora_adr_t *adr, const lora_packet_t *pkt) {
+    adr->rx_count++;
+    adr->snr_sum_x4 += pkt->snr_x4;
+    adr->last_rx_us = pkt->timestamp_us;
+}
+
+void lora_adr_on_tx(lora_adr_t *adr, bool delivered) {
+    if (delivered) {
+        adr->tx_delivered++;
+    } else {
+        adr->tx_lost++;
+    }
+}
+
+// Escolhe passo e potência para a janela que terminou
+static void lora_adr_decide(lora_adr_t *adr, uint32_t crc_errors) {
+    uint32_t lost = adr->tx_lost + crc_errors;
+    uint32_t total = adr->tx_delivered + adr->rx_count + lost;
+    adr->per_permille = (uint16_t)(total ? lost * 1000 / total : 0);
+    adr->decisions++;
+
+    const lora_profile_t *cur = &lora_adr_steps[adr->step];
+    int snr_x4 = adr->snr_sum_x4 / adr->rx_count;
+
+    // Orçamento do enlace: SNR em 125 kHz com a potência máxima
+    int budget_x4 = snr_x4 - lora_adr_bw_offset_x4(cur->bw) + (LORA_TX_POWER_MAX - adr->tx_power_dbm) * 4;
+
+    if (adr->per_permille > LORA_ADR_PER_MAX) {
+        // Perda alta com SNR bom indica desvanecimento ou interferência: não confia no SNR
+        adr->target_step = adr->step < LORA_ADR_ROBUST ? adr->step + 1 : adr->step;
+        adr->tx_power_dbm = LORA_TX_POWER_MAX;
+        return;
+    }
+
+    // Perfil mais rápido que ainda tem a margem com a potência máxima
+    uint8_t step = LORA_ADR_ROBUST;
+    for (uint8_t s = 0; s < LORA_ADR_STEPS; s++) {
+        const lora_profile_t *p = &lora_adr_steps[s];
+        if (budget_x4 + lora_adr_bw_offset_x4(p->bw) >= lora_adr_floor_x4(p) + LORA_ADR_MARGIN_DB * 4) {
+            step = s;
+            break;
+        }
+    }
+
+    // Nesse perfil, a menor potência que mantém a margem (arredondando para cima)
+    const lora_profile_t *p = &lora_adr_steps[step];
+    int excess_x4 = budget_x4 + lora_adr_bw_offset_x4(p->bw) - lora_adr_floor_x4(p) - LORA_ADR_MARGIN_DB * 4;
+    int power = LORA_TX_POWER_MAX - (excess_x4 > 0 ? excess_x4 / 4 : 0);
+    if (power < LORA_TX_POWER_MIN) {
+        power = LORA_TX_POWER_MIN;
+    }
+
+    adr->target_step = step;
+    adr->tx_power_dbm = (int8_t)power;
+}
+
+bool lora_adr_update(lora_adr_t *adr) {
+    const lora_adr_radio_t *ops = adr->radio_ops;
+    uint8_t previous = adr->target_step;
+    uint64_t now = ops->now_us(adr->radio);
+
+    // Silêncio longo: os dois lados voltam ao perfil mais robusto por conta própria
+    if (now - adr->last_rx_us > (uint64_t)LORA_ADR_FALLBACK_MS * 1000) {
+        adr->target_step = LORA_ADR_ROBUST;
+        adr->tx_power_dbm = LORA_TX_POWER_MAX;
+        previous = adr->target_step; // não há o que combinar
+        uint8_t before = adr->step;
+        // Com a fila de TX ocupada o perfil fica para a próxima chamada
+        if (lora_adr_apply(adr)) {
+            if (adr->step != before) {
+                adr->fallbacks++;
+            }
+            adr->last_rx_us = now;
+        }
+    }
+
+    if (adr->rx_count >= LORA_ADR_WINDOW) {
+        uint32_t crc_errors = ops->crc_errors(adr->radio);
+        lora_adr_decide(adr, crc_errors - adr->crc_errors_base);
+
+        adr->crc_errors_base = crc_errors;
+        adr->rx_count = 0;
+        adr->snr_sum_x4 = 0;
+        adr->tx_delivered = 0;
+        adr->tx_lost = 0;
+    }
+
+    // A potência é só deste lado; se a fila de TX estiver ocupada, tenta na próxima chamada
+    if (ops->get_tx_power(adr->radio) != adr->tx_power_dbm) {
+        ops->set_tx_power(adr->radio, adr->tx_power_dbm);
+    }
+
+    return adr->target_step != previous;
+}
+
+bool lora_adr_apply(lora_adr_t *adr) {
+    if (adr->step == adr->target_step) {
+        return true;
+    }
+    if (!adr->radio_ops->set_profile(adr->radio, &lora_adr_steps[adr->target_step])) {
+        return false;
+    }
+    adr->step = adr->target_step;
+    return true;
+}
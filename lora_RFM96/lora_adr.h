@@ -0,0 +1,109 @@
+// lora_adr.h - Taxa de dados adaptativa (ADR) para o lora_RFM96.
+//
+// Segue a ideia do ADR do LoRaWAN: a cada janela, a folga de SNR (média dos
+// pacotes recebidos menos o mínimo que o SF consegue demodular, menos uma
+// margem de segurança) decide o perfil. Com folga, o enlace sobe na escada de
+// perfis (mais rápido) e depois reduz a potência; sem folga, ou com perda de
+// pacotes alta, ele aumenta a potência e desce para perfis mais robustos.
+// O SNR medido é o dos pacotes do outro nó, então o controle supõe um enlace
+// simétrico, com os dois lados usando o ADR.
+//
+// A potência de transmissão só afeta este lado e é aplicada na hora. Já o
+// perfil precisa ser igual nos dois lados: lora_adr_update() apenas indica o
+// passo desejado, que a aplicação avisa ao outro nó (no perfil atual) antes de
+// chamar lora_adr_apply(). Se nenhum pacote chegar por LORA_ADR_FALLBACK_MS,
+// os dois lados voltam sozinhos ao passo mais robusto e se reencontram.
+
+#ifndef LORA_ADR_H_
+#define LORA_ADR_H_
+
+#include "lora_RFM96.h"
+
+// Pacotes recebidos entre duas decisões
+#define LORA_ADR_WINDOW         16
+
+// Margem de segurança sobre o SNR mínimo do SF, em dB
+#define LORA_ADR_MARGIN_DB      5
+
+// Perda de pacotes (em milésimos) a partir da qual o enlace fica mais robusto
+#define LORA_ADR_PER_MAX        200
+
+// Tempo sem receber nada até voltar ao passo mais robusto
+#define LORA_ADR_FALLBACK_MS    120000
+
+// Quantidade de passos em lora_adr_steps; o último é o mais robusto
+#define LORA_ADR_STEPS          7
+
+// Escada de perfis, do mais rápido (SF7, 125 kHz) ao mais robusto (LORA_PROFILE_DEFAULT)
+extern const lora_profile_t lora_adr_steps[LORA_ADR_STEPS];
+
+// Acesso ao rádio usado pelo ADR. lora_adr_radio_rfm96 liga o controlador ao
+// driver (lora_adr_rfm96.c); os testes no host usam um rádio falso.
+typedef struct {
+    uint64_t (*now_us)(void *radio);
+    uint32_t (*crc_errors)(void *radio);    // lora_radio_stats_t.crc_errors
+    bool (*set_profile)(void *radio, const lora_profile_t *profile);   // false com a fila de TX ocupada
+    bool (*set_tx_power)(void *radio, int8_t dbm);
+    int8_t (*get_tx_power)(void *radio);
+} lora_adr_radio_t;
+
+extern const lora_adr_radio_t lora_adr_radio_rfm96;
+
+typedef struct {
+    const lora_adr_radio_t *radio_ops;
+    void *radio;
+
+    uint8_t step;           // passo em uso
+    uint8_t target_step;    // passo recomendado pela última decisão
+    int8_t tx_power_dbm;
+
+    // Janela atual
+    uint16_t rx_count;
+    int32_t snr_sum_x4;
+    uint16_t tx_delivered;
+    uint16_t tx_lost;
+    uint32_t crc_errors_base;   // lora_radio_stats_t.crc_errors no início da janela
+
+    uint64_t last_rx_us;
+    uint16_t per_permille;  // perda de pacotes da última janela
+    uint32_t decisions;
+    uint32_t fallbacks;
+} lora_adr_t;
+
+/**
+ * @brief Inicializa o controlador no passo mais robusto e aplica o perfil e a potência máxima.
+ * @return false se o perfil não pôde ser aplicado (fila de TX ocupada).
+ */
+bool lora_adr_init(lora_adr_t *adr);
+
+/**
+ * @brief Inicializa o controlador sobre outro rádio; lora_adr_init() usa lora_adr_radio_rfm96.
+ * * @param radio_ops Funções de acesso ao rádio.
+ * @param radio Ponteiro repassado a essas funções.
+ */
+bool lora_adr_init_radio(lora_adr_t *adr, const lora_adr_radio_t *radio_ops, void *radio);
+
+/**
+ * @brief Registra um pacote recebido (SNR e momento da recepção).
+ */
+void lora_adr_on_packet(lora_adr_t *adr, const lora_packet_t *pkt);
+
+/**
+ * @brief Registra o resultado de um envio confirmado (ex: callback on_sent do lora_link).
+ */
+void lora_adr_on_tx(lora_adr_t *adr, bool delivered);
+
+/**
+ * @brief Reavalia o enlace ao fim de cada janela e faz o fallback por silêncio.
+ * Deve ser chamada com frequência pelo laço principal. Ajusta a potência na hora.
+ * @return true se target_step mudou e deve ser combinado com o outro nó.
+ */
+bool lora_adr_update(lora_adr_t *adr);
+
+/**
+ * @brief Aplica target_step (depois de avisado o outro nó).
+ * @return false se o perfil não pôde ser aplicado agora (fila de TX ocupada).
+ */
+bool lora_adr_apply(lora_adr_t *adr);
+
+#endif // LORA_ADR_H_
@@ -0,0 +1,43 @@
+// lora_adr_rfm96.c - Liga o ADR ao driver lora_RFM96.
+
+#include "pico/stdlib.h"
+#include "lora_adr.h"
+
+static uint64_t rfm96_now_us(void *radio) {
+    (void)radio;
+    return time_us_64();
+}
+
+static uint32_t rfm96_crc_errors(void *radio) {
+    (void)radio;
+    lora_radio_stats_t stats;
+    lora_get_radio_stats(&stats);
+    return stats.crc_errors;
+}
+
+static bool rfm96_set_profile(void *radio, const lora_profile_t *profile) {
+    (void)radio;
+    return lora_set_profile(profile);
+}
+
+static bool rfm96_set_tx_power(void *radio, int8_t dbm) {
+    (void)radio;
+    return lora_set_tx_power(dbm);
+}
+
+static int8_t rfm96_get_tx_power(void *radio) {
+    (void)radio;
+    return lora_get_tx_power();
+}
+
+const lora_adr_radio_t lora_adr_radio_rfm96 = {
+    .now_us = rfm96_now_us,
+    .crc_errors = rfm96_crc_errors,
+    .set_profile = rfm96_set_profile,
+    .set_tx_power = rfm96_set_tx_power,
+    .get_tx_power = rfm96_get_tx_power,
+};
+
+bool lora_adr_init(lora_adr_t *adr) {
+    return lora_adr_init_radio(adr, &lora_adr_radio_rfm96, NULL);
+}
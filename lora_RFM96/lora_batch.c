@@ -0,0 +1,197 @@
+// lora_batch.c
+
+#include <string.h>
+#include "lora_batch.h"
+
+// Pior caso de um registro: tipo + dt + campos, cada varint com até 5 bytes
+#define LORA_BATCH_MAX_RECORD   (1 + 5 + 5 * LORA_BATCH_MAX_FIELDS)
+
+// Cabeçalho do quadro: magic + t0
+#define LORA_BATCH_MAX_HEADER   (1 + 5)
+
+// Quantidade de campos de cada tipo
+static const uint8_t lora_batch_fields[LORA_BATCH_NUM_TYPES] = {
+    [LORA_BATCH_BMP280] = 2,
+    [LORA_BATCH_DISTANCIA] = 1,
+    [LORA_BATCH_OXIMETRO] = 2,
+};
+
+static size_t lora_batch_put_varint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static bool lora_batch_get_varint(lora_batch_reader_t *reader, uint32_t *v) {
+    uint32_t result = 0;
+    for (uint shift = 0; shift < 35; shift += 7) {
+        if (reader->pos >= reader->len) {
+            return false;
+        }
+        uint8_t b = reader->frame[reader->pos++];
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Zigzag: pequenos valores negativos também viram varints curtos (0, -1, 1, -2... -> 0, 1, 2, 3...)
+static uint32_t lora_batch_zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t lora_batch_unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Abre um quadro novo: os deltas recomeçam do zero
+static void lora_batch_start(lora_batch_t *batch, uint32_t now) {
+    batch->frame[0] = LORA_BATCH_MAGIC;
+    batch->len = 1 + lora_batch_put_varint(&batch->frame[1], now);
+    batch->first_ms = now;
+    batch->last_ms = now;
+    batch->count = 0;
+    memset(batch->prev, 0, sizeof(batch->prev));
+}
+
+// Codifica um registro em relação ao estado atual do quadro
+static size_t lora_batch_encode(const lora_batch_t *batch, uint8_t *out, lora_batch_type_t type,
+                                const int32_t *fields, uint32_t now) {
+    size_t n = 0;
+    out[n++] = (uint8_t)type;
+    n += lora_batch_put_varint(&out[n], now - batch->last_ms);
+    for (uint i = 0; i < lora_batch_fields[type]; i++) {
+        // Diferença em aritmética sem sinal: dá a volta igual nos dois lados
+        int32_t delta = (int32_t)((uint32_t)fields[i] - (uint32_t)batch->prev[type][i]);
+        n += lora_batch_put_varint(&out[n], lora_batch_zigzag(delta));
+    }
+    return n;
+}
+
+static void lora_batch_add(lora_batch_t *batch, lora_batch_type_t type, const int32_t *fields) {
+    uint8_t record[LORA_BATCH_MAX_RECORD];
+    uint32_t now = batch->now_ms();
+
+    if (batch->count == 0) {
+        lora_batch_start(batch, now);
+    }
+
+    size_t n = lora_batch_encode(batch, record, type, fields, now);
+    if (batch->len + n > batch->max_len) {
+        // Não cabe: envia o quadro atual e recodifica como primeira amostra do próximo
+        lora_batch_flush(batch);
+        lora_batch_start(batch, now);
+        n = lora_batch_encode(batch, record, type, fields, now);
+    }
+
+    memcpy(&batch->frame[batch->len], record, n);
+    batch->len += n;
+    batch->last_ms = now;
+    memcpy(batch->prev[type], fields, lora_batch_fields[type] * sizeof(int32_t));
+    batch->count++;
+    batch->samples++;
+
+    // Se nem o menor registro cabe mais, não há por que esperar o prazo
+    if (batch->len + 3 > batch->max_len) {
+        lora_batch_flush(batch);
+    }
+}
+
+void lora_batch_init_clock(lora_batch_t *batch, size_t max_len, uint32_t max_age_ms,
+                           lora_batch_clock_t now_ms, lora_batch_flush_t flush, void *user_data) {
+    memset(batch, 0, sizeof(*batch));
+    if (max_len > LORA_MAX_PAYLOAD) {
+        max_len = LORA_MAX_PAYLOAD;
+    }
+    if (max_len < LORA_BATCH_MAX_HEADER + LORA_BATCH_MAX_RECORD) {
+        max_len = LORA_BATCH_MAX_HEADER + LORA_BATCH_MAX_RECORD;
+    }
+    batch->max_len = max_len;
+    batch->max_age_ms = max_age_ms;
+    batch->flush = flush;
+    batch->user_data = user_data;
+    batch->now_ms = now_ms;
+}
+
+void lora_batch_add_bmp280(lora_batch_t *batch, int32_t temp, int32_t pressao) {
+    int32_t fields[] = { temp, pressao };
+    lora_batch_add(batch, LORA_BATCH_BMP280, fields);
+}
+
+void lora_batch_add_distance(lora_batch_t *batch, uint32_t distance_mm) {
+    int32_t fields[] = { (int32_t)distance_mm };
+    lora_batch_add(batch, LORA_BATCH_DISTANCIA, fields);
+}
+
+void lora_batch_add_oximetro(lora_batch_t *batch, int32_t spo2, int32_t bpm) {
+    int32_t fields[] = { spo2, bpm };
+    lora_batch_add(batch, LORA_BATCH_OXIMETRO, fields);
+}
+
+void lora_batch_poll(lora_batch_t *batch) {
+    if (batch->count > 0 && batch->now_ms() - batch->first_ms >= batch->max_age_ms) {
+        lora_batch_flush(batch);
+    }
+}
+
+void lora_batch_flush(lora_batch_t *batch) {
+    if (batch->count == 0) {
+        return;
+    }
+    batch->frames++;
+    batch->bytes += batch->len;
+    if (batch->flush) {
+        batch->flush(batch->frame, batch->len, batch->user_data);
+    }
+    batch->count = 0;
+    batch->len = 0;
+}
+
+bool lora_batch_reader_init(lora_batch_reader_t *reader, const uint8_t *frame, size_t len) {
+    memset(reader, 0, sizeof(*reader));
+    reader->frame = frame;
+    reader->len = len;
+    if (len < 2 || frame[0] != LORA_BATCH_MAGIC) {
+        return false;
+    }
+    reader->pos = 1;
+    return lora_batch_get_varint(reader, &reader->time_ms);
+}
+
+bool lora_batch_next(lora_batch_reader_t *reader, lora_batch_sample_t *sample) {
+    if (reader->pos >= reader->len) {
+        return false;
+    }
+
+    uint8_t type = reader->frame[reader->pos++];
+    if (type == 0 || type >= LORA_BATCH_NUM_TYPES) {
+        reader->pos = reader->len; // tipo desconhecido: o resto do quadro não tem como ser lido
+        return false;
+    }
+
+    uint32_t dt;
+    if (!lora_batch_get_varint(reader, &dt)) {
+        return false;
+    }
+    reader->time_ms += dt;
+
+    memset(sample, 0, sizeof(*sample));
+    sample->type = (lora_batch_type_t)type;
+    sample->timestamp_ms = reader->time_ms;
+    for (uint i = 0; i < lora_batch_fields[type]; i++) {
+        uint32_t v;
+        if (!lora_batch_get_varint(reader, &v)) {
+            return false;
+        }
+        reader->prev[type][i] = (int32_t)((uint32_t)reader->prev[type][i] + (uint32_t)lora_batch_unzigzag(v));
+        sample->fields[i] = reader->prev[type][i];
+    }
+    return true;
+}
@@ -0,0 +1,123 @@
+// lora_batch.h - Agregação de amostras de sensores em quadros compactos para o uplink LoRa.
+//
+// Em vez de um pacote por leitura, as amostras são acumuladas em um quadro de
+// até LORA_MAX_PAYLOAD bytes, enviado quando enche ou quando a amostra mais
+// antiga atinge o prazo máximo. Cada campo é gravado como a diferença para a
+// amostra anterior do mesmo tipo, em varint com zigzag: leituras que variam
+// pouco ocupam um byte por campo.
+//
+// Formato do quadro:
+//   LORA_BATCH_MAGIC | t0 (varint, ms desde o boot) | registros...
+// Cada registro:
+//   tipo (u8) | dt (varint, ms desde o registro anterior) | campos (zigzag varint, delta)
+// Os deltas recomeçam do zero a cada quadro, que pode ser decodificado sozinho.
+
+#ifndef LORA_BATCH_H_
+#define LORA_BATCH_H_
+
+#include "lora_RFM96.h"
+
+#define LORA_BATCH_MAGIC 0xB1
+
+// Tipos de amostra e seus campos, na ordem em que são gravados
+typedef enum {
+    LORA_BATCH_BMP280 = 1,      // temperatura (0,01 °C), pressão (Pa)
+    LORA_BATCH_DISTANCIA,       // distância (mm)
+    LORA_BATCH_OXIMETRO,        // SpO2 (%), BPM
+    LORA_BATCH_NUM_TYPES
+} lora_batch_type_t;
+
+#define LORA_BATCH_MAX_FIELDS 2
+
+// Amostra decodificada
+typedef struct {
+    lora_batch_type_t type;
+    uint32_t timestamp_ms;
+    int32_t fields[LORA_BATCH_MAX_FIELDS];
+} lora_batch_sample_t;
+
+// Chamada com um quadro pronto para envio (ex: lora_send_buf_async ou lora_link_send)
+typedef void (*lora_batch_flush_t)(const uint8_t *frame, size_t len, void *user_data);
+
+// Relógio em ms usado nos carimbos de tempo e no prazo do quadro
+typedef uint32_t (*lora_batch_clock_t)(void);
+
+typedef struct {
+    uint8_t frame[LORA_MAX_PAYLOAD];
+    size_t len;
+    size_t max_len;
+    uint32_t max_age_ms;
+    uint32_t first_ms;      // momento da amostra mais antiga do quadro
+    uint32_t last_ms;       // momento do registro anterior
+    uint16_t count;         // amostras no quadro
+    int32_t prev[LORA_BATCH_NUM_TYPES][LORA_BATCH_MAX_FIELDS];
+    lora_batch_flush_t flush;
+    void *user_data;
+    lora_batch_clock_t now_ms;
+
+    // Estatísticas para comparar com um pacote por leitura
+    uint32_t samples;
+    uint32_t frames;
+    uint32_t bytes;
+} lora_batch_t;
+
+/**
+ * @brief Inicializa o agregador.
+ * * @param batch O agregador.
+ * @param max_len Tamanho máximo do quadro (até LORA_MAX_PAYLOAD; menos se houver cabeçalho do enlace).
+ * @param max_age_ms Prazo máximo da amostra mais antiga antes do envio.
+ * @param flush Chamada com cada quadro pronto.
+ * @param user_data Ponteiro repassado a flush.
+ */
+void lora_batch_init(lora_batch_t *batch, size_t max_len, uint32_t max_age_ms,
+                     lora_batch_flush_t flush, void *user_data);
+
+/**
+ * @brief Inicializa o agregador com outro relógio; lora_batch_init() usa time_us_64().
+ * * @param now_ms Fonte de tempo em ms.
+ */
+void lora_batch_init_clock(lora_batch_t *batch, size_t max_len, uint32_t max_age_ms,
+                           lora_batch_clock_t now_ms, lora_batch_flush_t flush, void *user_data);
+
+/**
+ * @brief Acrescentam uma amostra ao quadro (enviando o quadro atual antes, se ela não couber).
+ */
+void lora_batch_add_bmp280(lora_batch_t *batch, int32_t temp, int32_t pressao);
+void lora_batch_add_distance(lora_batch_t *batch, uint32_t distance_mm);
+void lora_batch_add_oximetro(lora_batch_t *batch, int32_t spo2, int32_t bpm);
+
+/**
+ * @brief Envia o quadro se o prazo da amostra mais antiga venceu.
+ * Deve ser chamada com frequência pelo laço principal.
+ */
+void lora_batch_poll(lora_batch_t *batch);
+
+/**
+ * @brief Envia o quadro atual, se houver amostras.
+ */
+void lora_batch_flush(lora_batch_t *batch);
+
+/**
+ * @brief Leitor de um quadro recebido.
+ */
+typedef struct {
+    const uint8_t *frame;
+    size_t len;
+    size_t pos;
+    uint32_t time_ms;
+    int32_t prev[LORA_BATCH_NUM_TYPES][LORA_BATCH_MAX_FIELDS];
+} lora_batch_reader_t;
+
+/**
+ * @brief Prepara a leitura de um quadro.
+ * @return false se o quadro não é deste formato.
+ */
+bool lora_batch_reader_init(lora_batch_reader_t *reader, const uint8_t *frame, size_t len);
+
+/**
+ * @brief Decodifica a próxima amostra do quadro.
+ * @return false no fim do quadro ou se ele está corrompido.
+ */
+bool lora_batch_next(lora_batch_reader_t *reader, lora_batch_sample_t *sample);
+
+#endif // LORA_BATCH_H_
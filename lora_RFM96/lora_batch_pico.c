@@ -0,0 +1,13 @@
+// lora_batch_pico.c - Relógio do agregador no Pico.
+
+#include "pico/stdlib.h"
+#include "lora_batch.h"
+
+static uint32_t lora_batch_pico_now_ms(void) {
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+void lora_batch_init(lora_batch_t *batch, size_t max_len, uint32_t max_age_ms,
+                     lora_batch_flush_t flush, void *user_data) {
+    lora_batch_init_clock(batch, max_len, max_age_ms, lora_batch_pico_now_ms, flush, user_data);
+}
@@ -0,0 +1,240 @@
+// lora_link.c
+
+#include <string.h>
+#include "lora_link.h"
+
+#define LORA_LINK_ACK_LEN       7
+#define LORA_LINK_TURNAROUND_US 50000   // troca TX/RX e processamento do outro lado
+
+// Gerador pseudoaleatório (xorshift32) para espalhar as retransmissões
+static uint32_t lora_link_rand(lora_link_t *link) {
+    uint32_t x = link->rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    link->rand_state = x;
+    return x;
+}
+
+// Espera pelo ACK antes da tentativa "retries": ida + volta, dobrando a cada
+// tentativa, mais um sorteio de até uma espera base
+static uint64_t lora_link_backoff_us(lora_link_t *link, uint8_t len, uint8_t retries) {
+    const lora_link_radio_t *ops = link->radio_ops;
+    uint32_t base = ops->time_on_air_us(link->radio, len) + ops->time_on_air_us(link->radio, LORA_LINK_ACK_LEN) +
+                    LORA_LINK_TURNAROUND_US;
+    return ((uint64_t)base << retries) + lora_link_rand(link) % base;
+}
+
+void lora_link_init_radio(lora_link_t *link, const lora_link_radio_t *radio_ops, void *radio,
+                          lora_link_rx_callback_t on_receive, lora_link_tx_callback_t on_sent,
+                          void *user_data) {
+    memset(link, 0, sizeof(*link));
+    link->radio_ops = radio_ops;
+    link->radio = radio;
+    link->on_receive = on_receive;
+    link->on_sent = on_sent;
+    link->user_data = user_data;
+    link->rand_state = radio_ops->random(radio) | 1;
+    link->session = (uint8_t)radio_ops->random(radio);
+}
+
+// Fim da transmissão de uma cópia do slot (contexto de interrupção). Com a
+// fila do rádio, o pacote pode sair bem depois de lora_link_send(); só a partir
+// daqui faz sentido esperar o ACK.
+static void lora_link_tx_done(lora_tx_status_t status, void *user_data) {
+    (void)status; // Falhou ou não, a retransmissão fica por conta do temporizador
+    lora_link_slot_t *slot = user_data;
+    slot->tx_completed++;
+    slot->tx_done = true;
+}
+
+// Entrega o pacote do slot ao rádio; false se a fila do rádio está cheia
+static bool lora_link_transmit(lora_link_t *link, lora_link_slot_t *slot) {
+    if (!link->radio_ops->send(link->radio, slot->frame, slot->len, lora_link_tx_done, slot)) {
+        return false;
+    }
+    slot->tx_submitted++;
+    slot->deadline_us = UINT64_MAX;
+    return true;
+}
+
+uint lora_link_pending(const lora_link_t *link) {
+    uint n = 0;
+    for (uint i = 0; i < LORA_LINK_WINDOW; i++) {
+        if (link->window[i].in_use) {
+            n++;
+        }
+    }
+    return n;
+}
+
+int lora_link_send(lora_link_t *link, const uint8_t *data, size_t len) {
+    if (len > LORA_LINK_MAX_PAYLOAD) {
+        return -1;
+    }
+
+    // Um slot só volta a ser usado quando nenhuma cópia dele está na fila do rádio
+    lora_link_slot_t *slot = NULL;
+    for (uint i = 0; i < LORA_LINK_WINDOW; i++) {
+        if (!link->window[i].in_use && link->window[i].tx_submitted == link->window[i].tx_completed) {
+            slot = &link->window[i];
+            break;
+        }
+    }
+    if (!slot) {
+        return -1; // Janela cheia
+    }
+
+    slot->seq = link->tx_seq++;
+    slot->frame[0] = LORA_LINK_DATA;
+    slot->frame[1] = link->session;
+    slot->frame[2] = slot->seq;
+    memcpy(&slot->frame[LORA_LINK_HEADER_LEN], data, len);
+    slot->len = (uint8_t)(len + LORA_LINK_HEADER_LEN);
+    slot->retries = 0;
+    slot->tx_done = false;
+    // Nenhuma cópia anterior está na fila (ver acima): os contadores recomeçam,
+    // e tx_submitted == 0 passa a indicar que o pacote ainda não foi ao rádio
+    slot->tx_submitted = 0;
+    slot->tx_completed = 0;
+    slot->in_use = true;
+
+    // Se a fila do rádio estiver cheia, a primeira tentativa sai no próximo poll
+    if (!lora_link_transmit(link, slot)) {
+        slot->deadline_us = link->radio_ops->now_us(link->radio);
+    }
+    link->stats.sent++;
+    return slot->seq;
+}
+
+// Marca como confirmados os pacotes cobertos por um ACK
+static void lora_link_handle_ack(lora_link_t *link, uint8_t high, uint32_t bitmap) {
+    for (uint i = 0; i < LORA_LINK_WINDOW; i++) {
+        lora_link_slot_t *slot = &link->window[i];
+        if (!slot->in_use) {
+            continue;
+        }
+        uint8_t diff = (uint8_t)(high - slot->seq);
+        bool acked = (diff == 0) || (diff <= 32 && (bitmap & (1u << (diff - 1))));
+        if (acked) {
+            slot->in_use = false;
+            link->stats.acked++;
+            if (link->on_sent) {
+                link->on_sent(link, slot->seq, true);
+            }
+        }
+    }
+}
+
+// Atualiza a janela de recepção; retorna false se o pacote é repetido
+static bool lora_link_accept_seq(lora_link_t *link, uint8_t session, uint8_t seq) {
+    // Primeiro pacote, ou o outro lado reiniciou: a janela antiga não vale mais
+    if (!link->rx_synced || session != link->rx_session) {
+        link->rx_synced = true;
+        link->rx_session = session;
+        link->rx_high = seq;
+        link->rx_bitmap = 0;
+        return true;
+    }
+
+    int8_t diff = (int8_t)(seq - link->rx_high);
+    if (diff > 0) {
+        // Mais novo: desloca o mapa e o antigo "mais alto" vira o bit diff - 1
+        link->rx_bitmap = diff >= 32 ? 0 : link->rx_bitmap << diff;
+        if (diff <= 32) {
+            link->rx_bitmap |= 1u << (diff - 1);
+        }
+        link->rx_high = seq;
+        return true;
+    }
+    if (diff == 0) {
+        return false;
+    }
+
+    uint8_t back = (uint8_t)(-diff);
+    if (back > 32) {
+        return false; // Velho demais para saber; tratado como repetido
+    }
+    uint32_t bit = 1u << (back - 1);
+    if (link->rx_bitmap & bit) {
+        return false;
+    }
+    link->rx_bitmap |= bit;
+    return true;
+}
+
+static void lora_link_send_ack(lora_link_t *link) {
+    uint8_t ack[LORA_LINK_ACK_LEN] = {
+        LORA_LINK_ACK, link->rx_session, link->rx_high,
+        (uint8_t)link->rx_bitmap, (uint8_t)(link->rx_bitmap >> 8),
+        (uint8_t)(link->rx_bitmap >> 16), (uint8_t)(link->rx_bitmap >> 24),
+    };
+    if (link->radio_ops->send(link->radio, ack, sizeof(ack), NULL, NULL)) {
+        link->stats.acks_sent++;
+    }
+}
+
+void lora_link_poll(lora_link_t *link) {
+    const lora_link_radio_t *ops = link->radio_ops;
+    lora_packet_t *pkt;
+
+    while ((pkt = ops->receive(link->radio)) != NULL) {
+        if (pkt->len >= LORA_LINK_HEADER_LEN && pkt->data[0] == LORA_LINK_DATA) {
+            // Repetidos também são confirmados: o ACK anterior pode ter se perdido
+            if (lora_link_accept_seq(link, pkt->data[1], pkt->data[2])) {
+                link->stats.received++;
+                if (link->on_receive) {
+                    link->on_receive(link, pkt, &pkt->data[LORA_LINK_HEADER_LEN], pkt->len - LORA_LINK_HEADER_LEN);
+                }
+            } else {
+                link->stats.duplicates++;
+            }
+            lora_link_send_ack(link);
+        } else if (pkt->len == LORA_LINK_ACK_LEN && pkt->data[0] == LORA_LINK_ACK) {
+            // ACK de uma sessão anterior deste nó: os mesmos seqs agora são outros pacotes
+            if (pkt->data[1] == link->session) {
+                uint32_t bitmap = (uint32_t)pkt->data[3] | ((uint32_t)pkt->data[4] << 8) |
+                                  ((uint32_t)pkt->data[5] << 16) | ((uint32_t)pkt->data[6] << 24);
+                lora_link_handle_ack(link, pkt->data[2], bitmap);
+            } else {
+                link->stats.stale_acks++;
+            }
+        } else {
+            link->stats.foreign++;
+        }
+        ops->release(link->radio, pkt);
+    }
+
+    // Retransmissões vencidas
+    uint64_t now = ops->now_us(link->radio);
+    for (uint i = 0; i < LORA_LINK_WINDOW; i++) {
+        lora_link_slot_t *slot = &link->window[i];
+        if (!slot->in_use) {
+            continue;
+        }
+        if (slot->tx_done) {
+            slot->tx_done = false;
+            slot->deadline_us = now + lora_link_backoff_us(link, slot->len, slot->retries);
+        }
+        if (now < slot->deadline_us) {
+            continue;
+        }
+        if (slot->retries >= LORA_LINK_MAX_RETRIES) {
+            slot->in_use = false;
+            link->stats.failed++;
+            if (link->on_sent) {
+                link->on_sent(link, slot->seq, false);
+            }
+            continue;
+        }
+        // A primeira tentativa adiada por fila cheia em lora_link_send() não é retransmissão
+        bool first = slot->tx_submitted == 0;
+        if (!lora_link_transmit(link, slot)) {
+            continue; // Fila do rádio cheia; tenta no próximo poll
+        }
+        if (!first) {
+            slot->retries++;
+            link->stats.retransmits++;
+        }
+    }
+}
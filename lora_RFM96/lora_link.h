@@ -0,0 +1,149 @@
+// lora_link.h - Camada de enlace confiável (opcional) sobre o lora_RFM96.
+//
+// Cada pacote de dados leva um número de sequência e fica guardado até ser
+// confirmado. O receptor responde com um ACK seletivo: o maior número recebido
+// e um mapa de bits dos 32 anteriores, de modo que um único ACK confirma
+// vários pacotes e um ACK perdido é coberto pelo próximo. Pacotes sem ACK são
+// retransmitidos com espera exponencial (e um sorteio para dois nós não
+// colidirem de novo) até LORA_LINK_MAX_RETRIES vezes. O mesmo mapa descarta
+// pacotes duplicados, entregando cada um à aplicação uma única vez.
+//
+// Cada inicialização sorteia um byte de sessão que vai em todos os pacotes de
+// dados e volta no ACK. Quando o transmissor reinicia, a sessão muda e o
+// receptor recomeça a janela, em vez de tomar o seq 0 novo por um repetido (e
+// confirmá-lo sem entregar); ACKs da sessão anterior são ignorados. Há uma
+// chance em 256 de a sessão nova repetir a anterior.
+//
+// Formato dos pacotes:
+//   dados: LORA_LINK_DATA | sessão | seq | payload
+//   ACK:   LORA_LINK_ACK  | sessão | seq mais alto recebido | mapa (u32, little-endian)
+
+#ifndef LORA_LINK_H_
+#define LORA_LINK_H_
+
+#include "lora_RFM96.h"
+
+// Pacotes aguardando confirmação ao mesmo tempo
+#define LORA_LINK_WINDOW        4
+
+// Retransmissões antes de desistir de um pacote
+#define LORA_LINK_MAX_RETRIES   4
+
+// Tamanho do cabeçalho dos pacotes de dados e máximo do payload da aplicação
+#define LORA_LINK_HEADER_LEN    3
+#define LORA_LINK_MAX_PAYLOAD   (LORA_MAX_PAYLOAD - LORA_LINK_HEADER_LEN)
+
+#define LORA_LINK_DATA  0xD1
+#define LORA_LINK_ACK   0xA1
+
+typedef struct lora_link lora_link_t;
+
+// Acesso ao rádio usado pelo enlace. lora_link_radio_rfm96 liga o enlace ao
+// driver (lora_link_rfm96.c, que precisa de pico_rand no target_link_libraries);
+// os testes no host usam um rádio simulado.
+typedef struct {
+    // Coloca um pacote na fila de transmissão, sem bloquear; false se a fila
+    // está cheia. callback (pode ser NULL) é chamada quando ele sai do ar.
+    bool (*send)(void *radio, const uint8_t *data, size_t len, lora_tx_callback_t callback, void *user_data);
+    // Próximo pacote recebido, ou NULL; devolvido depois com release()
+    lora_packet_t *(*receive)(void *radio);
+    void (*release)(void *radio, lora_packet_t *pkt);
+    uint32_t (*time_on_air_us)(void *radio, size_t len);
+    uint64_t (*now_us)(void *radio);
+    // Número aleatório para a sessão e o sorteio das esperas; precisa variar
+    // de um boot para o outro
+    uint32_t (*random)(void *radio);
+} lora_link_radio_t;
+
+extern const lora_link_radio_t lora_link_radio_rfm96;
+
+// Pacote de dados novo (não duplicado) recebido
+typedef void (*lora_link_rx_callback_t)(lora_link_t *link, const lora_packet_t *pkt,
+                                        const uint8_t *data, size_t len);
+
+// Pacote confirmado (ok) ou abandonado após LORA_LINK_MAX_RETRIES
+typedef void (*lora_link_tx_callback_t)(lora_link_t *link, uint8_t seq, bool ok);
+
+typedef struct {
+    uint32_t sent;          // pacotes de dados novos
+    uint32_t retransmits;
+    uint32_t acked;
+    uint32_t failed;        // desistências
+    uint32_t received;      // pacotes de dados entregues à aplicação
+    uint32_t duplicates;    // pacotes repetidos descartados
+    uint32_t acks_sent;
+    uint32_t stale_acks;    // ACKs de outra sessão, ignorados
+    uint32_t foreign;       // pacotes que não são da camada de enlace
+} lora_link_stats_t;
+
+typedef struct {
+    bool in_use;
+    uint8_t seq;
+    uint8_t retries;
+    uint8_t len;
+    uint64_t deadline_us;   // próxima retransmissão; UINT64_MAX enquanto espera o fim da transmissão
+    uint8_t tx_submitted;   // cópias entregues ao rádio (laço principal); 0 = ainda não enviado
+    volatile uint8_t tx_completed;  // cópias que já saíram do ar (interrupção)
+    volatile bool tx_done;  // saiu do ar desde o último poll: a espera pelo ACK começa agora
+    uint8_t frame[LORA_MAX_PAYLOAD];
+} lora_link_slot_t;
+
+struct lora_link {
+    const lora_link_radio_t *radio_ops;
+    void *radio;
+    lora_link_rx_callback_t on_receive;
+    lora_link_tx_callback_t on_sent;
+    void *user_data;
+
+    // Envio
+    uint8_t session;        // sorteada a cada inicialização
+    uint8_t tx_seq;
+    lora_link_slot_t window[LORA_LINK_WINDOW];
+    uint32_t rand_state;
+
+    // Recepção: sessão do outro lado, maior seq visto e mapa dos 32 anteriores (bit i = seq - 1 - i)
+    bool rx_synced;
+    uint8_t rx_session;
+    uint8_t rx_high;
+    uint32_t rx_bitmap;
+
+    lora_link_stats_t stats;
+};
+
+/**
+ * @brief Inicializa o enlace. O rádio já deve estar inicializado e em recepção contínua.
+ * * @param link O enlace.
+ * @param on_receive Chamada para cada pacote novo recebido.
+ * @param on_sent Chamada quando um pacote é confirmado ou abandonado (pode ser NULL).
+ * @param user_data Ponteiro livre para a aplicação.
+ */
+void lora_link_init(lora_link_t *link, lora_link_rx_callback_t on_receive,
+                    lora_link_tx_callback_t on_sent, void *user_data);
+
+/**
+ * @brief Inicializa o enlace sobre outro rádio; lora_link_init() usa lora_link_radio_rfm96.
+ * * @param radio_ops Funções de acesso ao rádio.
+ * @param radio Ponteiro repassado a essas funções.
+ */
+void lora_link_init_radio(lora_link_t *link, const lora_link_radio_t *radio_ops, void *radio,
+                          lora_link_rx_callback_t on_receive, lora_link_tx_callback_t on_sent,
+                          void *user_data);
+
+/**
+ * @brief Envia um pacote com confirmação. Não bloqueante.
+ * @return O número de sequência do pacote, ou -1 se a janela está cheia ou o payload é grande demais.
+ */
+int lora_link_send(lora_link_t *link, const uint8_t *data, size_t len);
+
+/**
+ * @brief Processa pacotes recebidos, envia ACKs e faz as retransmissões.
+ * Deve ser chamada com frequência pelo laço principal.
+ */
+void lora_link_poll(lora_link_t *link);
+
+/**
+ * @brief Pacotes aguardando confirmação.
+ */
+uint lora_link_pending(const lora_link_t *link);
+
+#endif // LORA_LINK_H_
@@ -0,0 +1,51 @@
+// lora_link_rfm96.c - Liga a camada de enlace ao driver lora_RFM96.
+
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "lora_link.h"
+
+static bool rfm96_send(void *radio, const uint8_t *data, size_t len, lora_tx_callback_t callback, void *user_data) {
+    (void)radio;
+    return lora_send_buf_async(data, len, callback, user_data);
+}
+
+static lora_packet_t *rfm96_receive(void *radio) {
+    (void)radio;
+    return lora_receive_packet();
+}
+
+static void rfm96_release(void *radio, lora_packet_t *pkt) {
+    (void)radio;
+    lora_packet_release(pkt);
+}
+
+static uint32_t rfm96_time_on_air_us(void *radio, size_t len) {
+    (void)radio;
+    return lora_time_on_air_us(len);
+}
+
+static uint64_t rfm96_now_us(void *radio) {
+    (void)radio;
+    return time_us_64();
+}
+
+// Entropia do hardware (pico_rand): o relógio no momento da inicialização
+// se repete de um boot para o outro
+static uint32_t rfm96_random(void *radio) {
+    (void)radio;
+    return get_rand_32();
+}
+
+const lora_link_radio_t lora_link_radio_rfm96 = {
+    .send = rfm96_send,
+    .receive = rfm96_receive,
+    .release = rfm96_release,
+    .time_on_air_us = rfm96_time_on_air_us,
+    .now_us = rfm96_now_us,
+    .random = rfm96_random,
+};
+
+void lora_link_init(lora_link_t *link, lora_link_rx_callback_t on_receive,
+                    lora_link_tx_callback_t on_sent, void *user_data) {
+    lora_link_init_radio(link, &lora_link_radio_rfm96, NULL, on_receive, on_sent, user_data);
+}
@@ -0,0 +1,39 @@
+// lora_profile.c
+
+#include "lora_profile.h"
+
+// Largura de banda em Hz, indexada por lora_bw_t
+static const uint32_t bw_hz[] = { 7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000 };
+
+bool lora_profile_valid(const lora_profile_t *p) {
+    return p->sf >= 7 && p->sf <= 12 && p->bw <= LORA_BW_500_KHZ &&
+           p->cr >= LORA_CR_4_5 && p->cr <= LORA_CR_4_8 && p->preamble_len >= 6;
+}
+
+uint32_t lora_profile_symbol_us(const lora_profile_t *p) {
+    return (uint32_t)(((uint64_t)1000000 << p->sf) / bw_hz[p->bw]);
+}
+
+// LDRO obrigatória quando o símbolo dura mais de 16 ms
+bool lora_profile_ldro(const lora_profile_t *p) {
+    if (p->ldro != LORA_LDRO_AUTO) {
+        return p->ldro == LORA_LDRO_ON;
+    }
+    return lora_profile_symbol_us(p) > 16000;
+}
+
+uint32_t lora_profile_time_on_air_us(const lora_profile_t *p, size_t payload_len) {
+    // Tsym = 2^SF / BW; preâmbulo = (n + 4,25) símbolos
+    // payload = 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / (4(SF - 2DE))) * (CR + 4), 0)
+    int32_t sf = p->sf;
+    int32_t de = lora_profile_ldro(p) ? 1 : 0;
+    int32_t num = 8 * (int32_t)payload_len - 4 * sf + 28 + 16;
+    int32_t den = 4 * (sf - 2 * de);
+    int32_t blocks = num > 0 ? (num + den - 1) / den : 0;
+    uint32_t payload_symbols = 8 + (uint32_t)(blocks * ((int32_t)p->cr + 4));
+
+    // Em quartos de símbolo, para representar os 4,25 do preâmbulo sem ponto flutuante
+    uint64_t quarter_symbols = 4u * ((uint64_t)p->preamble_len + payload_symbols) + 17;
+    uint64_t us = (quarter_symbols * ((uint64_t)1000000 << sf)) / (4u * bw_hz[p->bw]);
+    return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us; // só os preâmbulos enormes em 7,8 kHz passam de ~71 min
+}
@@ -0,0 +1,81 @@
+// lora_profile.h - Perfil do modem LoRa e cálculo do tempo no ar.
+//
+// Não depende do SDK do Pico nem do rádio: é usado pelo lora_RFM96 para
+// configurar o modem e calcular os timeouts, e compilado no host pelos
+// testes (test/).
+
+#ifndef LORA_PROFILE_H_
+#define LORA_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Largura de banda (valores do campo Bw de RegModemConfig1)
+typedef enum {
+    LORA_BW_7_8_KHZ = 0,
+    LORA_BW_10_4_KHZ,
+    LORA_BW_15_6_KHZ,
+    LORA_BW_20_8_KHZ,
+    LORA_BW_31_25_KHZ,
+    LORA_BW_41_7_KHZ,
+    LORA_BW_62_5_KHZ,
+    LORA_BW_125_KHZ,
+    LORA_BW_250_KHZ,
+    LORA_BW_500_KHZ,
+} lora_bw_t;
+
+// Taxa de codificação (valores do campo CodingRate de RegModemConfig1)
+typedef enum {
+    LORA_CR_4_5 = 1,
+    LORA_CR_4_6,
+    LORA_CR_4_7,
+    LORA_CR_4_8,
+} lora_cr_t;
+
+// Otimização para baixa taxa de dados
+typedef enum {
+    LORA_LDRO_AUTO = 0, // ligada quando o símbolo dura mais de 16 ms, como pede o datasheet
+    LORA_LDRO_OFF,
+    LORA_LDRO_ON,
+} lora_ldro_t;
+
+// Perfil do modem. Com sf == 0 é usado LORA_PROFILE_DEFAULT.
+typedef struct {
+    uint8_t sf;             // Spreading factor, 7 a 12
+    lora_bw_t bw;
+    lora_cr_t cr;
+    uint16_t preamble_len;  // Em símbolos (o rádio acrescenta 4,25)
+    lora_ldro_t ldro;
+    uint8_t sync_word;      // 0x12 para redes privadas, 0x34 para LoRaWAN
+} lora_profile_t;
+
+// Perfil de máximo alcance usado até aqui: SF12, BW 62,5 kHz, CR 4/8
+#define LORA_PROFILE_DEFAULT { 12, LORA_BW_62_5_KHZ, LORA_CR_4_8, 12, LORA_LDRO_AUTO, 0x12 }
+
+/**
+ * @brief Confere se SF, BW, CR e preâmbulo estão dentro do que o rádio aceita.
+ */
+bool lora_profile_valid(const lora_profile_t *profile);
+
+/**
+ * @brief Indica se o perfil usa a otimização para baixa taxa de dados.
+ * Em LORA_LDRO_AUTO ela é ligada quando o símbolo dura mais de 16 ms.
+ */
+bool lora_profile_ldro(const lora_profile_t *profile);
+
+/**
+ * @brief Duração de um símbolo (2^SF / BW), em microssegundos.
+ */
+uint32_t lora_profile_symbol_us(const lora_profile_t *profile);
+
+/**
+ * @brief Calcula o tempo no ar de um pacote para um perfil qualquer.
+ * Segue a fórmula do datasheet (cabeçalho explícito, CRC ligado).
+ * * @param profile O perfil do modem.
+ * @param payload_len Tamanho do payload, em bytes.
+ * @return O tempo no ar, em microssegundos.
+ */
+uint32_t lora_profile_time_on_air_us(const lora_profile_t *profile, size_t payload_len);
+
+#endif // LORA_PROFILE_H_
@@ -0,0 +1,127 @@
+// bench_lora_batch.c - Compressão do agregador (lora_batch) comparada a um
+// pacote por leitura.
+//
+// Para cada cenário mede bytes por amostra, pacotes enviados e tempo no ar
+// por amostra no perfil padrão do modem (lora_profile_time_on_air_us), além
+// do tempo de codificação no host. O pacote por leitura leva o formato
+// binário cru: tipo (u8), carimbo de tempo (u32) e os campos em i32.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_timer.h"
+#include "lora_batch.h"
+#include "lora_profile.h"
+
+#define SAMPLES 100000
+
+static const lora_profile_t profile = LORA_PROFILE_DEFAULT;
+
+static uint32_t fake_now_ms;
+
+static uint32_t fake_clock(void) {
+    return fake_now_ms;
+}
+
+static uint64_t airtime_us;
+
+static void count_airtime(const uint8_t *frame, size_t len, void *user_data) {
+    (void)user_data;
+    airtime_us += lora_profile_time_on_air_us(&profile, len);
+    bench_sink += frame[len / 2];
+}
+
+static uint32_t rng_state = 0x9E3779B9;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+typedef enum {
+    CENARIO_BMP280,     // uma leitura por segundo, variações pequenas
+    CENARIO_DISTANCIA,  // 10 leituras por segundo, valores que saltam
+    CENARIO_MISTO,      // os três sensores intercalados
+} cenario_t;
+
+static const char *const cenario_nome[] = { "bmp280 1 Hz", "distancia 10 Hz", "misto" };
+
+// Gera a próxima leitura do cenário e devolve o tamanho do pacote cru equivalente
+static size_t next_sample(cenario_t c, lora_batch_sample_t *s) {
+    static int32_t temp = 2500, press = 101325, bpm = 72;
+    lora_batch_type_t type = (c == CENARIO_BMP280) ? LORA_BATCH_BMP280
+                           : (c == CENARIO_DISTANCIA) ? LORA_BATCH_DISTANCIA
+                           : (lora_batch_type_t)(1 + rng() % 3);
+
+    fake_now_ms += (c == CENARIO_DISTANCIA) ? 100 : 1000;
+    s->type = type;
+    s->timestamp_ms = fake_now_ms;
+    switch (type) {
+    case LORA_BATCH_BMP280:
+        temp += (int32_t)(rng() % 5) - 2;
+        press += (int32_t)(rng() % 21) - 10;
+        s->fields[0] = temp;
+        s->fields[1] = press;
+        return 1 + 4 + 2 * 4;
+    case LORA_BATCH_DISTANCIA:
+        s->fields[0] = 200 + (int32_t)(rng() % 3800);
+        return 1 + 4 + 4;
+    default:
+        bpm += (int32_t)(rng() % 3) - 1;
+        s->fields[0] = 95 + (int32_t)(rng() % 4);
+        s->fields[1] = bpm;
+        return 1 + 4 + 2 * 4;
+    }
+}
+
+static void run(cenario_t c, uint32_t max_age_ms) {
+    lora_batch_t batch;
+    lora_batch_sample_t s;
+    uint64_t raw_bytes = 0, raw_airtime_us = 0, ns = 0;
+
+    lora_batch_init_clock(&batch, LORA_MAX_PAYLOAD, max_age_ms, fake_clock, count_airtime, NULL);
+    airtime_us = 0;
+    fake_now_ms = 0;
+    rng_state = 0x9E3779B9;
+
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        size_t raw = next_sample(c, &s);
+        raw_bytes += raw;
+        raw_airtime_us += lora_profile_time_on_air_us(&profile, raw);
+
+        uint64_t t0 = bench_ns();
+        switch (s.type) {
+        case LORA_BATCH_BMP280:
+            lora_batch_add_bmp280(&batch, s.fields[0], s.fields[1]);
+            break;
+        case LORA_BATCH_DISTANCIA:
+            lora_batch_add_distance(&batch, (uint32_t)s.fields[0]);
+            break;
+        default:
+            lora_batch_add_oximetro(&batch, s.fields[0], s.fields[1]);
+            break;
+        }
+        lora_batch_poll(&batch);
+        ns += bench_ns() - t0;
+    }
+    lora_batch_flush(&batch);
+
+    printf("%-16s prazo %3u s: %5.2f bytes/amostra (cru %5.2f), %6u pacotes (cru %u), "
+           "%7.1f ms no ar/amostra (cru %7.1f), %5.1f ns/amostra\n",
+           cenario_nome[c], max_age_ms / 1000,
+           (double)batch.bytes / SAMPLES, (double)raw_bytes / SAMPLES,
+           batch.frames, SAMPLES,
+           airtime_us / 1000.0 / SAMPLES, raw_airtime_us / 1000.0 / SAMPLES,
+           (double)ns / SAMPLES);
+}
+
+int main(void) {
+    printf("perfil: SF%u, %u bytes de payload no máximo\n", profile.sf, LORA_MAX_PAYLOAD);
+    for (cenario_t c = CENARIO_BMP280; c <= CENARIO_MISTO; c++) {
+        run(c, 10000);
+        run(c, 60000);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef BENCH_TIMER_H
+#define BENCH_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+ /* Timing helpers for the host benchmarks: wall clock in ns plus the CPU
+    cycle counter where the host has one readable from user space (x86 TSC).
+    Host numbers compare code paths against each other; absolute Cortex-M0+
+    cycle counts still have to be taken on the board.
+ */
+
+static inline uint64_t bench_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t bench_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// keeps results alive without letting the compiler drop the measured loop
+static volatile uint32_t bench_sink;
+
+#endif
@@ -0,0 +1,10 @@
+// hardware/spi.h - Substituto mínimo do SDK do Pico para os testes no host:
+// só os tipos que lora_RFM96.h usa na configuração.
+
+#ifndef FAKE_HARDWARE_SPI_H
+#define FAKE_HARDWARE_SPI_H
+
+typedef unsigned int uint;
+typedef struct spi_inst spi_inst_t;
+
+#endif
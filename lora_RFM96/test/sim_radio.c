@@ -0,0 +1,168 @@
+// sim_radio.c - Canal LoRa simulado para testar o lora_link no host.
+
+#include <string.h>
+
+#include "sim_radio.h"
+
+static uint32_t sim_rand(sim_channel_t *ch) {
+    uint32_t x = ch->rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ch->rand_state = x;
+    return x;
+}
+
+void sim_channel_init(sim_channel_t *ch, uint32_t seed) {
+    memset(ch, 0, sizeof(*ch));
+    ch->rand_state = seed | 1;
+    ch->now_us = 1000000;
+}
+
+static void sim_radio_init(sim_radio_t *r, sim_channel_t *ch, sim_radio_t *peer, const lora_profile_t *profile) {
+    memset(r, 0, sizeof(*r));
+    r->ch = ch;
+    r->peer = peer;
+    r->profile = *profile;
+}
+
+void sim_radio_pair(sim_channel_t *ch, sim_radio_t *a, sim_radio_t *b, const lora_profile_t *profile) {
+    sim_radio_init(a, ch, b, profile);
+    sim_radio_init(b, ch, a, profile);
+}
+
+void sim_radio_inject(sim_radio_t *r, const uint8_t *data, size_t len) {
+    for (int i = 0; i < LORA_RX_POOL_LEN; i++) {
+        if (!r->pool_used[i]) {
+            lora_packet_t *pkt = &r->pool[i];
+            r->pool_used[i] = true;
+            memcpy(pkt->data, data, len);
+            pkt->len = (uint8_t)len;
+            pkt->rssi_dbm = -80;
+            pkt->snr_x4 = 20;
+            pkt->timestamp_us = r->ch->now_us;
+            r->ready[(r->ready_head + r->ready_count) % LORA_RX_POOL_LEN] = pkt;
+            r->ready_count++;
+            return;
+        }
+    }
+    r->rx_dropped++;
+}
+
+// Pacote txq[tx_head] terminou de sair: entrega (ou não) e passa ao próximo
+static void sim_tx_done(sim_radio_t *r) {
+    sim_channel_t *ch = r->ch;
+    const uint8_t *data = r->txq[r->tx_head].data;
+    size_t len = r->txq[r->tx_head].len;
+    sim_radio_t *peer = r->peer;
+
+    bool lost = ch->drop && ch->drop(r, data, len, ch->drop_ctx);
+    if (!lost && ch->loss_permille && sim_rand(ch) % 1000 < ch->loss_permille) {
+        lost = true;
+    }
+    // Em half-duplex, o outro lado não escuta enquanto transmite
+    if (!lost && ch->half_duplex && peer->tx_count > 0) {
+        lost = true;
+    }
+
+    if (lost) {
+        ch->lost++;
+    } else {
+        sim_radio_inject(peer, data, len);
+        ch->delivered++;
+        if (ch->dup_permille && sim_rand(ch) % 1000 < ch->dup_permille) {
+            sim_radio_inject(peer, data, len);
+            ch->duplicated++;
+        }
+    }
+
+    // Como no driver: o próximo da fila entra no ar antes da callback
+    lora_tx_callback_t callback = r->txq[r->tx_head].callback;
+    void *user_data = r->txq[r->tx_head].user_data;
+    r->tx_packets++;
+    r->tx_head = (uint8_t)((r->tx_head + 1) % LORA_TX_QUEUE_LEN);
+    r->tx_count--;
+    if (r->tx_count > 0) {
+        r->tx_end_us += lora_profile_time_on_air_us(&r->profile, r->txq[r->tx_head].len);
+    }
+    if (callback) {
+        callback(LORA_TX_OK, user_data);
+    }
+}
+
+void sim_advance(sim_channel_t *ch, sim_radio_t *a, sim_radio_t *b, uint64_t dt_us) {
+    uint64_t end = ch->now_us + dt_us;
+    for (;;) {
+        // Próxima transmissão a terminar dentro do intervalo, na ordem do tempo
+        sim_radio_t *next = NULL;
+        if (a->tx_count > 0 && a->tx_end_us <= end) {
+            next = a;
+        }
+        if (b->tx_count > 0 && b->tx_end_us <= end && (!next || b->tx_end_us < next->tx_end_us)) {
+            next = b;
+        }
+        if (!next) {
+            break;
+        }
+        ch->now_us = next->tx_end_us;
+        sim_tx_done(next);
+    }
+    ch->now_us = end;
+}
+
+static bool sim_send(void *radio, const uint8_t *data, size_t len, lora_tx_callback_t callback, void *user_data) {
+    sim_radio_t *r = radio;
+    if (r->tx_count == LORA_TX_QUEUE_LEN || len > LORA_MAX_PAYLOAD) {
+        return false;
+    }
+    uint8_t idx = (uint8_t)((r->tx_head + r->tx_count) % LORA_TX_QUEUE_LEN);
+    memcpy(r->txq[idx].data, data, len);
+    r->txq[idx].len = (uint8_t)len;
+    r->txq[idx].callback = callback;
+    r->txq[idx].user_data = user_data;
+    if (r->tx_count == 0) {
+        r->tx_end_us = r->ch->now_us + lora_profile_time_on_air_us(&r->profile, len);
+    }
+    r->tx_count++;
+    return true;
+}
+
+static lora_packet_t *sim_receive(void *radio) {
+    sim_radio_t *r = radio;
+    if (r->ready_count == 0) {
+        return NULL;
+    }
+    lora_packet_t *pkt = r->ready[r->ready_head];
+    r->ready_head = (uint8_t)((r->ready_head + 1) % LORA_RX_POOL_LEN);
+    r->ready_count--;
+    return pkt;
+}
+
+static void sim_release(void *radio, lora_packet_t *pkt) {
+    sim_radio_t *r = radio;
+    r->pool_used[pkt - r->pool] = false;
+}
+
+static uint32_t sim_time_on_air_us(void *radio, size_t len) {
+    sim_radio_t *r = radio;
+    return lora_profile_time_on_air_us(&r->profile, len);
+}
+
+static uint64_t sim_now_us(void *radio) {
+    sim_radio_t *r = radio;
+    return r->ch->now_us;
+}
+
+static uint32_t sim_random(void *radio) {
+    sim_radio_t *r = radio;
+    return sim_rand(r->ch);
+}
+
+const lora_link_radio_t sim_radio_ops = {
+    .send = sim_send,
+    .receive = sim_receive,
+    .release = sim_release,
+    .time_on_air_us = sim_time_on_air_us,
+    .now_us = sim_now_us,
+    .random = sim_random,
+};
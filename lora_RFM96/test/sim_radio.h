@@ -0,0 +1,71 @@
+// sim_radio.h - Canal LoRa simulado para testar o lora_link no host.
+//
+// Dois rádios ligados por um canal com relógio virtual. Cada rádio tem a
+// fila de transmissão e o pool de recepção com os mesmos tamanhos do driver;
+// um pacote ocupa o ar pelo seu tempo no ar e, ao terminar, chega ao outro
+// rádio, a menos que o canal o perca. O canal também pode duplicar pacotes
+// e, em half-duplex, perde o que chega enquanto o receptor transmite.
+
+#ifndef SIM_RADIO_H
+#define SIM_RADIO_H
+
+#include "lora_link.h"
+
+typedef struct sim_radio sim_radio_t;
+
+// Decide se um pacote específico se perde; chamada para cada pacote que
+// termina de ser transmitido, antes do sorteio de perda
+typedef bool (*sim_drop_t)(const sim_radio_t *from, const uint8_t *data, size_t len, void *ctx);
+
+typedef struct {
+    uint64_t now_us;
+    uint32_t rand_state;
+    uint32_t loss_permille;     // perda aleatória, em milésimos
+    uint32_t dup_permille;      // pacotes entregues duas vezes, em milésimos
+    bool half_duplex;
+    sim_drop_t drop;
+    void *drop_ctx;
+
+    uint32_t delivered;
+    uint32_t lost;
+    uint32_t duplicated;
+} sim_channel_t;
+
+struct sim_radio {
+    sim_channel_t *ch;
+    sim_radio_t *peer;
+    lora_profile_t profile;
+
+    struct {
+        uint8_t data[LORA_MAX_PAYLOAD];
+        uint8_t len;
+        lora_tx_callback_t callback;
+        void *user_data;
+    } txq[LORA_TX_QUEUE_LEN];
+    uint8_t tx_head;
+    uint8_t tx_count;
+    uint64_t tx_end_us;         // fim do pacote no ar (txq[tx_head])
+    uint32_t tx_packets;
+
+    lora_packet_t pool[LORA_RX_POOL_LEN];
+    bool pool_used[LORA_RX_POOL_LEN];
+    lora_packet_t *ready[LORA_RX_POOL_LEN];
+    uint8_t ready_head;
+    uint8_t ready_count;
+    uint32_t rx_dropped;        // pool cheio
+};
+
+extern const lora_link_radio_t sim_radio_ops;
+
+void sim_channel_init(sim_channel_t *ch, uint32_t seed);
+
+// Liga dois rádios ao canal, com o perfil de modem dado
+void sim_radio_pair(sim_channel_t *ch, sim_radio_t *a, sim_radio_t *b, const lora_profile_t *profile);
+
+// Avança o relógio em dt_us, terminando as transmissões que vencem nesse intervalo
+void sim_advance(sim_channel_t *ch, sim_radio_t *a, sim_radio_t *b, uint64_t dt_us);
+
+// Coloca um pacote direto no pool de recepção, como se tivesse chegado pelo ar
+void sim_radio_inject(sim_radio_t *radio, const uint8_t *data, size_t len);
+
+#endif
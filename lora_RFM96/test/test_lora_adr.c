@@ -0,0 +1,275 @@
+// test_lora_adr.c - Testes no host da taxa de dados adaptativa (lora_adr).
+//
+// O rádio é falso: relógio, contador de erros de CRC, perfil e potência são
+// campos de fake_radio_t. Os passos e potências esperados saem das contas do
+// SNR mínimo por SF (-7,5 dB no SF7, 2,5 dB a menos por SF), da margem de
+// LORA_ADR_MARGIN_DB e dos 3 dB de SNR a mais a cada metade da banda.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lora_adr.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+typedef struct {
+    uint64_t now_us;
+    uint32_t crc_errors;
+    lora_profile_t profile;
+    uint32_t profile_calls;
+    bool busy;              // fila de TX ocupada: set_profile falha
+    int8_t tx_power;
+    uint32_t power_calls;
+} fake_radio_t;
+
+static uint64_t fake_now_us(void *radio) {
+    return ((fake_radio_t *)radio)->now_us;
+}
+
+static uint32_t fake_crc_errors(void *radio) {
+    return ((fake_radio_t *)radio)->crc_errors;
+}
+
+static bool fake_set_profile(void *radio, const lora_profile_t *profile) {
+    fake_radio_t *r = radio;
+    if (r->busy) {
+        return false;
+    }
+    r->profile = *profile;
+    r->profile_calls++;
+    return true;
+}
+
+static bool fake_set_tx_power(void *radio, int8_t dbm) {
+    fake_radio_t *r = radio;
+    r->tx_power = dbm;
+    r->power_calls++;
+    return true;
+}
+
+static int8_t fake_get_tx_power(void *radio) {
+    return ((fake_radio_t *)radio)->tx_power;
+}
+
+static const lora_adr_radio_t fake_ops = {
+    .now_us = fake_now_us,
+    .crc_errors = fake_crc_errors,
+    .set_profile = fake_set_profile,
+    .set_tx_power = fake_set_tx_power,
+    .get_tx_power = fake_get_tx_power,
+};
+
+static fake_radio_t radio;
+static lora_adr_t adr;
+
+static void setup(void) {
+    memset(&radio, 0, sizeof(radio));
+    radio.now_us = 5000000;
+    radio.crc_errors = 7;   // contagem anterior ao ADR não entra na primeira janela
+    CHECK(lora_adr_init_radio(&adr, &fake_ops, &radio));
+}
+
+// Uma janela inteira de pacotes com o mesmo SNR (em quartos de dB), 100 ms entre eles
+static bool window(int snr_x4) {
+    for (int i = 0; i < LORA_ADR_WINDOW; i++) {
+        lora_packet_t pkt;
+        memset(&pkt, 0, sizeof(pkt));
+        radio.now_us += 100000;
+        pkt.snr_x4 = (int8_t)snr_x4;
+        pkt.timestamp_us = radio.now_us;
+        lora_adr_on_packet(&adr, &pkt);
+    }
+    return lora_adr_update(&adr);
+}
+
+static void test_init(void) {
+    setup();
+    CHECK(adr.step == LORA_ADR_STEPS - 1 && adr.target_step == LORA_ADR_STEPS - 1);
+    CHECK(radio.profile_calls == 1);
+    CHECK(memcmp(&radio.profile, &lora_adr_steps[LORA_ADR_STEPS - 1], sizeof(lora_profile_t)) == 0);
+    CHECK(radio.tx_power == LORA_TX_POWER_MAX);
+
+    // O último passo é o perfil padrão (62,5 kHz); os outros, 125 kHz do SF7 ao SF12
+    lora_profile_t def = LORA_PROFILE_DEFAULT;
+    CHECK(memcmp(&lora_adr_steps[LORA_ADR_STEPS - 1], &def, sizeof(def)) == 0);
+    for (int s = 0; s < LORA_ADR_STEPS - 1; s++) {
+        CHECK(lora_adr_steps[s].sf == 7 + s && lora_adr_steps[s].bw == LORA_BW_125_KHZ);
+    }
+
+    // Antes de a janela encher nada muda
+    for (int i = 0; i < LORA_ADR_WINDOW - 1; i++) {
+        lora_packet_t pkt = { .snr_x4 = 40, .timestamp_us = radio.now_us };
+        lora_adr_on_packet(&adr, &pkt);
+    }
+    CHECK(!lora_adr_update(&adr));
+    CHECK(adr.decisions == 0);
+}
+
+// Medido no passo mais robusto (SF12, 62,5 kHz, 20 dBm). Orçamento em 125 kHz =
+// SNR - 3 dB; o passo s (SF 7 + s) precisa de orçamento >= -7,5 - 2,5 s + 5 dB
+static void test_step_selection(void) {
+    static const struct {
+        int snr_x4;
+        uint8_t step;
+        int8_t power;
+    } cases[] = {
+        // +10 dB: orçamento 7 dB, SF7 precisa de -2,5 dB; sobram 9,5 dB -> 20 - 9
+        { 40, 0, 11 },
+        // exatamente a margem do SF7: orçamento -2,5 dB, potência máxima
+        { 2, 0, 20 },
+        // 0,25 dB abaixo: não cabe no SF7, SF8 com 2,25 dB de sobra -> 20 - 2
+        { 1, 1, 18 },
+        // -10 dB: orçamento -13 dB; SF11 pede -12,5, SF12 -15 -> sobram 2 dB
+        { -40, 5, 18 },
+        // -14 dB: orçamento -17 dB; no 125 kHz nada serve, mas em 62,5 kHz
+        // (+3 dB) o SF12 pede -15: sobra 1 dB -> 20 - 1
+        { -56, 6, 19 },
+        // -20 dB: nem o passo mais robusto tem margem; fica nele, potência máxima
+        { -80, 6, 20 },
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        setup();
+        bool changed = window(cases[c].snr_x4);
+        if (adr.target_step != cases[c].step || adr.tx_power_dbm != cases[c].power) {
+            printf("%s:%d: falhou: SNR %d/4 dB: passo %u, %d dBm; esperado passo %u, %d dBm\n", __FILE__, __LINE__,
+                   cases[c].snr_x4, adr.target_step, adr.tx_power_dbm, cases[c].step, cases[c].power);
+            failures++;
+        }
+        CHECK(changed == (cases[c].step != LORA_ADR_STEPS - 1));
+        CHECK(radio.tx_power == cases[c].power);    // a potência é aplicada na hora
+        CHECK(adr.step == LORA_ADR_STEPS - 1);      // o perfil só com lora_adr_apply()
+        CHECK(adr.per_permille == 0);
+    }
+}
+
+// Potência reduzida entra no orçamento: o SNR medido a 11 dBm vale 9 dB a mais
+static void test_power_backoff(void) {
+    setup();
+    window(40);
+    CHECK(adr.target_step == 0 && adr.tx_power_dbm == 11);
+    CHECK(lora_adr_apply(&adr));
+    CHECK(adr.step == 0 && radio.profile.sf == 7 && radio.profile.bw == LORA_BW_125_KHZ);
+
+    // SF7 a 11 dBm com +1 dB: orçamento 10 dB, sobram 12,5 -> 20 - 12
+    CHECK(!window(4));
+    CHECK(adr.target_step == 0 && adr.tx_power_dbm == 8);
+    CHECK(radio.tx_power == 8);
+
+    // Com a potência já no mínimo útil, muita folga satura em LORA_TX_POWER_MIN
+    setup();
+    window(120);    // +30 dB
+    CHECK(adr.target_step == 0 && adr.tx_power_dbm == LORA_TX_POWER_MIN);
+    CHECK(lora_adr_apply(&adr));
+    window(100);    // +25 dB a 2 dBm: continua no mínimo, não passa dele
+    CHECK(adr.tx_power_dbm == LORA_TX_POWER_MIN);
+    CHECK(radio.tx_power == LORA_TX_POWER_MIN);
+
+    // Folga some: a potência volta a subir no mesmo passo (SF7 a 2 dBm com -2,5 dB
+    // = orçamento 15,5 dB, sobram 18 -> 20 - 18 = 2; com -7 dB sobram 13,5 -> 7)
+    window(-28);
+    CHECK(adr.target_step == 0 && adr.tx_power_dbm == 7);
+}
+
+// Perda acima de LORA_ADR_PER_MAX: um passo mais robusto e potência máxima, mesmo com SNR bom
+static void test_per_fallback(void) {
+    setup();
+    window(40);
+    CHECK(lora_adr_apply(&adr));
+    CHECK(adr.step == 0);
+
+    // 5 envios perdidos contra 16 recebidos: 5/21 = 238 por mil
+    for (int i = 0; i < 5; i++) {
+        lora_adr_on_tx(&adr, false);
+    }
+    CHECK(window(40));
+    CHECK(adr.per_permille == 238);
+    CHECK(adr.target_step == 1 && adr.tx_power_dbm == LORA_TX_POWER_MAX);
+    CHECK(radio.tx_power == LORA_TX_POWER_MAX);
+
+    // Erros de CRC contam como perda: 4 deles e 1 envio perdido, 5 em 25
+    // (16 recebidos + 4 entregues + 5) = 200 por mil, no limite
+    CHECK(lora_adr_apply(&adr));
+    radio.crc_errors += 4;
+    lora_adr_on_tx(&adr, false);
+    for (int i = 0; i < 4; i++) {
+        lora_adr_on_tx(&adr, true);
+    }
+    window(40);
+    CHECK(adr.per_permille == 200);
+    CHECK(adr.target_step == 0);    // 200 não passa do limite: decide pelo SNR
+
+    // 6 erros de CRC em 22: 272 por mil
+    CHECK(lora_adr_apply(&adr));
+    radio.crc_errors += 6;
+    CHECK(window(40));
+    CHECK(adr.per_permille == 272);
+    CHECK(adr.target_step == 1);
+
+    // No passo mais robusto não há para onde descer
+    setup();
+    radio.crc_errors += 10;
+    CHECK(!window(40));
+    CHECK(adr.target_step == LORA_ADR_STEPS - 1 && adr.tx_power_dbm == LORA_TX_POWER_MAX);
+}
+
+// Sem pacotes por LORA_ADR_FALLBACK_MS: volta sozinho ao passo mais robusto
+static void test_silence_fallback(void) {
+    setup();
+    window(40);
+    CHECK(lora_adr_apply(&adr));
+    CHECK(adr.step == 0 && radio.tx_power == 11);
+    uint32_t calls = radio.profile_calls;
+
+    radio.now_us += (uint64_t)LORA_ADR_FALLBACK_MS * 1000;
+    CHECK(!lora_adr_update(&adr));
+    CHECK(adr.step == 0 && adr.fallbacks == 0);   // no limite ainda não
+
+    // Fila de TX ocupada: o perfil fica para a próxima chamada
+    radio.now_us += 1;
+    radio.busy = true;
+    CHECK(!lora_adr_update(&adr));   // nada a combinar com o outro nó
+    CHECK(adr.step == 0 && adr.target_step == LORA_ADR_STEPS - 1);
+    CHECK(radio.tx_power == LORA_TX_POWER_MAX);
+    CHECK(adr.fallbacks == 0);
+
+    radio.busy = false;
+    radio.now_us += 1000;
+    CHECK(!lora_adr_update(&adr));
+    CHECK(adr.step == LORA_ADR_STEPS - 1 && adr.fallbacks == 1);
+    CHECK(radio.profile_calls == calls + 1);
+    CHECK(memcmp(&radio.profile, &lora_adr_steps[LORA_ADR_STEPS - 1], sizeof(lora_profile_t)) == 0);
+
+    // O prazo recomeça: mais silêncio logo depois não repete o fallback
+    radio.now_us += (uint64_t)LORA_ADR_FALLBACK_MS * 1000 / 2;
+    lora_adr_update(&adr);
+    CHECK(adr.fallbacks == 1);
+    CHECK(radio.profile_calls == calls + 1);
+
+    // Já no passo mais robusto, o silêncio não conta como fallback
+    radio.now_us += (uint64_t)LORA_ADR_FALLBACK_MS * 1000;
+    lora_adr_update(&adr);
+    CHECK(adr.fallbacks == 1);
+}
+
+int main(void) {
+    test_init();
+    test_step_selection();
+    test_power_backoff();
+    test_per_fallback();
+    test_silence_fallback();
+
+    if (failures) {
+        printf("test_lora_adr: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_lora_adr: ok\n");
+    return 0;
+}
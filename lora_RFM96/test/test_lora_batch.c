@@ -0,0 +1,283 @@
+// test_lora_batch.c - Testes no host do agregador de amostras (lora_batch).
+//
+// O relógio é injetado com lora_batch_init_clock(), então os carimbos de
+// tempo e o prazo do quadro são determinísticos. Os quadros enviados são
+// guardados e decodificados de volta com lora_batch_next().
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lora_batch.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static uint32_t fake_now_ms;
+
+static uint32_t fake_clock(void) {
+    return fake_now_ms;
+}
+
+// Quadros recebidos por flush, em sequência
+#define MAX_FRAMES 2048
+
+static struct {
+    uint8_t data[MAX_FRAMES][LORA_MAX_PAYLOAD];
+    size_t len[MAX_FRAMES];
+    int count;
+} sent;
+
+static void capture(const uint8_t *frame, size_t len, void *user_data) {
+    (void)user_data;
+    if (sent.count < MAX_FRAMES) {
+        memcpy(sent.data[sent.count], frame, len);
+        sent.len[sent.count] = len;
+    }
+    sent.count++;
+}
+
+static void setup(lora_batch_t *batch, size_t max_len, uint32_t max_age_ms) {
+    memset(&sent, 0, sizeof(sent));
+    fake_now_ms = 0;
+    lora_batch_init_clock(batch, max_len, max_age_ms, fake_clock, capture, NULL);
+}
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void add(lora_batch_t *batch, const lora_batch_sample_t *s) {
+    switch (s->type) {
+    case LORA_BATCH_BMP280:
+        lora_batch_add_bmp280(batch, s->fields[0], s->fields[1]);
+        break;
+    case LORA_BATCH_DISTANCIA:
+        lora_batch_add_distance(batch, (uint32_t)s->fields[0]);
+        break;
+    default:
+        lora_batch_add_oximetro(batch, s->fields[0], s->fields[1]);
+        break;
+    }
+}
+
+// Decodifica todos os quadros enviados e compara com as amostras esperadas
+static void check_round_trip(const lora_batch_sample_t *expected, int n, size_t max_len) {
+    int idx = 0;
+    for (int f = 0; f < sent.count && f < MAX_FRAMES; f++) {
+        CHECK(sent.len[f] <= max_len);
+
+        lora_batch_reader_t reader;
+        CHECK(lora_batch_reader_init(&reader, sent.data[f], sent.len[f]));
+        lora_batch_sample_t s;
+        int in_frame = 0;
+        while (lora_batch_next(&reader, &s)) {
+            if (idx >= n) {
+                CHECK(idx < n);
+                return;
+            }
+            if (s.type != expected[idx].type || s.timestamp_ms != expected[idx].timestamp_ms ||
+                s.fields[0] != expected[idx].fields[0] || s.fields[1] != expected[idx].fields[1]) {
+                printf("%s:%d: falhou: amostra %d: tipo %d t=%u (%d, %d), esperado tipo %d t=%u (%d, %d)\n",
+                       __FILE__, __LINE__, idx, s.type, s.timestamp_ms, s.fields[0], s.fields[1],
+                       expected[idx].type, expected[idx].timestamp_ms, expected[idx].fields[0], expected[idx].fields[1]);
+                failures++;
+                return;
+            }
+            idx++;
+            in_frame++;
+        }
+        CHECK(reader.pos == reader.len);  // o quadro inteiro foi consumido
+        CHECK(in_frame > 0);
+    }
+    CHECK(idx == n);
+}
+
+static void test_golden(void) {
+    lora_batch_t batch;
+    setup(&batch, LORA_MAX_PAYLOAD, 60000);
+
+    fake_now_ms = 1000;
+    lora_batch_add_bmp280(&batch, 2500, 101325);
+    fake_now_ms = 1250;
+    lora_batch_add_bmp280(&batch, 2497, 101337);
+    lora_batch_flush(&batch);
+
+    // magic | t0=1000 | BMP280 dt=0 2500 101325 | BMP280 dt=250 -3 +12
+    static const uint8_t expected[] = {
+        0xB1, 0xE8, 0x07,
+        0x01, 0x00, 0x88, 0x27, 0x9A, 0xAF, 0x0C,
+        0x01, 0xFA, 0x01, 0x05, 0x18,
+    };
+    CHECK(sent.count == 1);
+    CHECK(sent.len[0] == sizeof(expected));
+    CHECK(memcmp(sent.data[0], expected, sizeof(expected)) == 0);
+    CHECK(batch.samples == 2 && batch.frames == 1 && batch.bytes == sizeof(expected));
+
+    // flush sem amostras não envia nada
+    lora_batch_flush(&batch);
+    CHECK(sent.count == 1);
+}
+
+// Leituras realistas misturadas: variações pequenas, intervalos irregulares
+static void test_round_trip(size_t max_len) {
+    static lora_batch_sample_t expected[5000];
+    lora_batch_t batch;
+    setup(&batch, max_len, 30000);
+
+    int32_t temp = 2500, press = 101325, dist = 1500, spo2 = 97, bpm = 72;
+    fake_now_ms = 123456;
+    for (int i = 0; i < 5000; i++) {
+        fake_now_ms += rng() % 2000;
+        lora_batch_sample_t *s = &expected[i];
+        memset(s, 0, sizeof(*s));
+        s->timestamp_ms = fake_now_ms;
+        switch (rng() % 3) {
+        case 0:
+            temp += (int32_t)(rng() % 21) - 10;
+            press += (int32_t)(rng() % 61) - 30;
+            *s = (lora_batch_sample_t){ LORA_BATCH_BMP280, fake_now_ms, { temp, press } };
+            break;
+        case 1:
+            dist = (int32_t)(rng() % 4000);  // distância salta: deltas grandes
+            *s = (lora_batch_sample_t){ LORA_BATCH_DISTANCIA, fake_now_ms, { dist, 0 } };
+            break;
+        default:
+            spo2 = 90 + (int32_t)(rng() % 10);
+            bpm += (int32_t)(rng() % 5) - 2;
+            *s = (lora_batch_sample_t){ LORA_BATCH_OXIMETRO, fake_now_ms, { spo2, bpm } };
+            break;
+        }
+        add(&batch, s);
+        lora_batch_poll(&batch);
+    }
+    lora_batch_flush(&batch);
+
+    CHECK(sent.count > 1);
+    CHECK(batch.samples == 5000);
+    CHECK(batch.frames == (uint32_t)sent.count);
+    check_round_trip(expected, 5000, max_len);
+}
+
+// Valores extremos: os deltas dão a volta em 32 bits e ocupam 5 bytes
+static void test_extremes(void) {
+    static const int32_t values[] = { 0, INT32_MAX, INT32_MIN, -1, 1, INT32_MIN, INT32_MAX, 0 };
+    enum { N = sizeof(values) / sizeof(values[0]) };
+    lora_batch_sample_t expected[2 * N];
+    lora_batch_t batch;
+    setup(&batch, 48, 60000);
+
+    fake_now_ms = UINT32_MAX - 5000;
+    for (int i = 0; i < N; i++) {
+        fake_now_ms += 1000;  // também atravessa a volta do relógio de 32 bits
+        expected[2 * i] = (lora_batch_sample_t){ LORA_BATCH_BMP280, fake_now_ms, { values[i], values[N - 1 - i] } };
+        add(&batch, &expected[2 * i]);
+        expected[2 * i + 1] = (lora_batch_sample_t){ LORA_BATCH_DISTANCIA, fake_now_ms, { values[i], 0 } };
+        add(&batch, &expected[2 * i + 1]);
+    }
+    lora_batch_flush(&batch);
+    check_round_trip(expected, 2 * N, 48);
+}
+
+static void test_max_age(void) {
+    lora_batch_t batch;
+    setup(&batch, LORA_MAX_PAYLOAD, 10000);
+
+    fake_now_ms = 5000;
+    lora_batch_add_distance(&batch, 100);
+    fake_now_ms = 14999;
+    lora_batch_add_distance(&batch, 101);
+    lora_batch_poll(&batch);
+    CHECK(sent.count == 0);  // a amostra mais antiga ainda está no prazo
+
+    fake_now_ms = 15000;
+    lora_batch_poll(&batch);
+    CHECK(sent.count == 1);
+    lora_batch_poll(&batch);
+    CHECK(sent.count == 1);  // quadro vazio não é reenviado
+
+    // o próximo quadro conta o prazo a partir da sua primeira amostra
+    fake_now_ms = 20000;
+    lora_batch_add_distance(&batch, 102);
+    fake_now_ms = 29999;
+    lora_batch_poll(&batch);
+    CHECK(sent.count == 1);
+    fake_now_ms = 30000;
+    lora_batch_poll(&batch);
+    CHECK(sent.count == 2);
+
+    // os deltas recomeçam: o segundo quadro é lido sozinho
+    lora_batch_reader_t reader;
+    lora_batch_sample_t s;
+    CHECK(lora_batch_reader_init(&reader, sent.data[1], sent.len[1]));
+    CHECK(lora_batch_next(&reader, &s));
+    CHECK(s.type == LORA_BATCH_DISTANCIA && s.fields[0] == 102 && s.timestamp_ms == 20000);
+    CHECK(!lora_batch_next(&reader, &s));
+}
+
+static void test_corrupt(void) {
+    lora_batch_t batch;
+    setup(&batch, LORA_MAX_PAYLOAD, 60000);
+    fake_now_ms = 1000;
+    lora_batch_add_bmp280(&batch, 2500, 101325);
+    lora_batch_add_oximetro(&batch, 97, 72);
+    lora_batch_flush(&batch);
+    CHECK(sent.count == 1);
+
+    uint8_t frame[LORA_MAX_PAYLOAD];
+    size_t len = sent.len[0];
+    lora_batch_reader_t reader;
+    lora_batch_sample_t s;
+
+    // magic errado ou quadro curto demais
+    memcpy(frame, sent.data[0], len);
+    frame[0] ^= 0xFF;
+    CHECK(!lora_batch_reader_init(&reader, frame, len));
+    CHECK(!lora_batch_reader_init(&reader, sent.data[0], 1));
+
+    // truncado em qualquer ponto: nunca lê além do fim
+    for (size_t cut = 2; cut < len; cut++) {
+        int n = 0;
+        if (lora_batch_reader_init(&reader, sent.data[0], cut)) {
+            while (lora_batch_next(&reader, &s)) {
+                n++;
+            }
+        }
+        CHECK(n < 2);
+        CHECK(reader.pos <= cut);
+    }
+
+    // tipo desconhecido encerra a leitura
+    memcpy(frame, sent.data[0], len);
+    frame[3] = LORA_BATCH_NUM_TYPES;
+    CHECK(lora_batch_reader_init(&reader, frame, len));
+    CHECK(!lora_batch_next(&reader, &s));
+    CHECK(!lora_batch_next(&reader, &s));
+}
+
+int main(void) {
+    test_golden();
+    test_round_trip(LORA_MAX_PAYLOAD);
+    test_round_trip(40);
+    test_extremes();
+    test_max_age();
+    test_corrupt();
+
+    if (failures) {
+        printf("test_lora_batch: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_lora_batch: ok\n");
+    return 0;
+}
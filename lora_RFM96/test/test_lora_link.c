@@ -0,0 +1,389 @@
+// test_lora_link.c - Testes no host do enlace confiável (lora_link) sobre um
+// canal simulado com perda, duplicação e half-duplex (sim_radio.c).
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sim_radio.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define MAX_IDS 4000
+#define PAYLOAD_LEN 12
+#define STEP_US 1000
+
+// SF7 / 125 kHz: pacotes de dezenas de ms, bom para simular milhares
+static const lora_profile_t profile = { 7, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 };
+
+typedef struct {
+    lora_link_t link;
+    sim_radio_t radio;
+
+    // Recepção: quantas vezes cada id chegou à aplicação e em que ordem
+    uint8_t rx_count[MAX_IDS];
+    uint16_t rx_order[MAX_IDS];
+    size_t rx_n;
+
+    // Envio: id de cada seq em voo e o destino de cada id
+    uint16_t seq_id[256];
+    uint8_t acked[MAX_IDS];
+    uint8_t failed[MAX_IDS];
+    uint16_t ack_order[MAX_IDS];
+    size_t ack_n;
+} node_t;
+
+static node_t node_a, node_b;
+static sim_channel_t ch;
+
+static void on_receive(lora_link_t *link, const lora_packet_t *pkt, const uint8_t *data, size_t len) {
+    node_t *n = link->user_data;
+    (void)pkt;
+    if (len != PAYLOAD_LEN) {
+        failures++;
+        return;
+    }
+    uint16_t id = (uint16_t)(data[0] | (data[1] << 8));
+    for (size_t i = 2; i < len; i++) {
+        if (data[i] != (uint8_t)(id + i)) {
+            printf("payload corrompido no id %u\n", id);
+            failures++;
+            return;
+        }
+    }
+    n->rx_count[id]++;
+    n->rx_order[n->rx_n++] = id;
+}
+
+static void on_sent(lora_link_t *link, uint8_t seq, bool ok) {
+    node_t *n = link->user_data;
+    uint16_t id = n->seq_id[seq];
+    if (ok) {
+        n->acked[id]++;
+        n->ack_order[n->ack_n++] = id;
+    } else {
+        n->failed[id]++;
+    }
+}
+
+static void setup(uint32_t seed) {
+    sim_channel_init(&ch, seed);
+    memset(&node_a, 0, sizeof(node_a));
+    memset(&node_b, 0, sizeof(node_b));
+    sim_radio_pair(&ch, &node_a.radio, &node_b.radio, &profile);
+    lora_link_init_radio(&node_a.link, &sim_radio_ops, &node_a.radio, on_receive, on_sent, &node_a);
+    lora_link_init_radio(&node_b.link, &sim_radio_ops, &node_b.radio, on_receive, on_sent, &node_b);
+}
+
+static bool send_id(node_t *n, uint16_t id) {
+    uint8_t data[PAYLOAD_LEN];
+    data[0] = (uint8_t)id;
+    data[1] = (uint8_t)(id >> 8);
+    for (size_t i = 2; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(id + i);
+    }
+    int seq = lora_link_send(&n->link, data, sizeof(data));
+    if (seq < 0) {
+        return false;
+    }
+    n->seq_id[seq] = id;
+    return true;
+}
+
+static bool idle(void) {
+    return lora_link_pending(&node_a.link) == 0 && lora_link_pending(&node_b.link) == 0 &&
+           node_a.radio.tx_count == 0 && node_b.radio.tx_count == 0;
+}
+
+// A envia os ids first..end-1 assim que a janela permite; roda até tudo terminar
+static void run_ids(uint16_t first, uint16_t end) {
+    uint16_t next = first;
+    uint16_t total = end;
+    for (uint64_t t = 0; t < 3600ull * 1000000; t += STEP_US) {
+        while (next < total && send_id(&node_a, next)) {
+            next++;
+        }
+        lora_link_poll(&node_a.link);
+        lora_link_poll(&node_b.link);
+        if (next == total && idle()) {
+            return;
+        }
+        sim_advance(&ch, &node_a.radio, &node_b.radio, STEP_US);
+    }
+    printf("simulação não terminou\n");
+    failures++;
+}
+
+static void run(uint16_t total) {
+    run_ids(0, total);
+}
+
+// Canal perfeito: tudo chega uma vez, em ordem, sem retransmissão, com o
+// número de sequência dando várias voltas
+static void test_clean(void) {
+    setup(1);
+    run(700);
+
+    CHECK(node_b.rx_n == 700);
+    bool in_order = true;
+    for (size_t i = 0; i < node_b.rx_n; i++) {
+        in_order &= node_b.rx_order[i] == i;
+    }
+    CHECK(in_order);
+    CHECK(node_a.link.stats.sent == 700);
+    CHECK(node_a.link.stats.acked == 700);
+    CHECK(node_a.link.stats.retransmits == 0);
+    CHECK(node_a.link.stats.failed == 0);
+    CHECK(node_b.link.stats.duplicates == 0);
+    CHECK(node_b.radio.rx_dropped == 0);
+}
+
+// Perda, duplicação e half-duplex: cada pacote chega no máximo uma vez e todo
+// pacote confirmado chegou de fato
+static void test_lossy(void) {
+    // max_failed: desistências aceitas em 2000 pacotes (perda nos dois sentidos
+    // e half-duplex, então a chance de 5 tentativas sem ACK não é desprezível)
+    static const struct { uint32_t seed, loss, dup, max_failed; } cases[] = {
+        { 7, 100, 50, 5 }, { 11, 200, 100, 20 }, { 23, 300, 0, 60 },
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        setup(cases[c].seed);
+        ch.loss_permille = cases[c].loss;
+        ch.dup_permille = cases[c].dup;
+        ch.half_duplex = true;
+        run(2000);
+
+        uint32_t delivered = 0, acked = 0, failed = 0, bad = 0;
+        for (uint16_t id = 0; id < 2000; id++) {
+            if (node_b.rx_count[id] > 1) bad++;                     // entregue duas vezes
+            if (node_a.acked[id] && !node_b.rx_count[id]) bad++;    // confirmado sem chegar
+            if (node_a.acked[id] + node_a.failed[id] != 1) bad++;   // sem desfecho único
+            delivered += node_b.rx_count[id] ? 1 : 0;
+            acked += node_a.acked[id];
+            failed += node_a.failed[id];
+        }
+        CHECK(bad == 0);
+        CHECK(acked + failed == 2000);
+        CHECK(node_a.link.stats.acked == acked);
+        CHECK(node_a.link.stats.failed == failed);
+        CHECK(node_b.link.stats.received == delivered);
+        CHECK(node_a.link.stats.retransmits > 0);
+        if (cases[c].dup) {
+            CHECK(node_b.link.stats.duplicates > 0);
+        }
+        CHECK(failed <= cases[c].max_failed);
+        printf("  perda %u%%, duplicação %u%%: %u entregues, %u desistências, %u retransmissões\n",
+               cases[c].loss / 10, cases[c].dup / 10, delivered, failed, node_a.link.stats.retransmits);
+    }
+}
+
+// Perde a primeira transmissão do seq 1 e registra os ACKs de B
+static uint8_t ack_high[64];
+static uint32_t ack_bitmap[64];
+static size_t ack_seen;
+static uint8_t drop_seq;
+static int drop_left;
+
+static bool drop_first_of_seq(const sim_radio_t *from, const uint8_t *data, size_t len, void *ctx) {
+    (void)ctx;
+    if (from == &node_a.radio && data[0] == LORA_LINK_DATA && data[2] == drop_seq && drop_left > 0) {
+        drop_left--;
+        return true;
+    }
+    if (from == &node_b.radio && len == 7 && data[0] == LORA_LINK_ACK && ack_seen < 64) {
+        ack_high[ack_seen] = data[2];
+        ack_bitmap[ack_seen] = (uint32_t)data[3] | ((uint32_t)data[4] << 8) |
+                               ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 24);
+        ack_seen++;
+    }
+    return false;
+}
+
+static void test_selective_ack(void) {
+    setup(3);
+    ack_seen = 0;
+    drop_seq = 1;
+    drop_left = 1;
+    ch.drop = drop_first_of_seq;
+    run(4);
+
+    CHECK(node_b.rx_n == 4);
+    CHECK(node_a.link.stats.retransmits == 1);
+
+    // O ACK depois do seq 3 confirma 0, 2 e 3 e deixa o buraco do 1
+    bool hole = false;
+    for (size_t i = 0; i < ack_seen; i++) {
+        if (ack_high[i] == 3 && !(ack_bitmap[i] & 0x2)) {
+            hole = (ack_bitmap[i] & 0x5) == 0x5;
+        }
+    }
+    CHECK(hole);
+
+    // Só o 1 ficou esperando a retransmissão
+    CHECK(node_a.ack_n == 4);
+    CHECK(node_a.ack_order[0] == 0 && node_a.ack_order[1] == 2 && node_a.ack_order[2] == 3);
+    CHECK(node_a.ack_order[3] == 1);
+    ch.drop = NULL;
+}
+
+// ACKs perdidos: A retransmite, B descarta o repetido mas confirma de novo
+static int acks_to_drop;
+
+static bool drop_acks(const sim_radio_t *from, const uint8_t *data, size_t len, void *ctx) {
+    (void)len;
+    (void)ctx;
+    if (from == &node_b.radio && data[0] == LORA_LINK_ACK && acks_to_drop > 0) {
+        acks_to_drop--;
+        return true;
+    }
+    return false;
+}
+
+static void test_lost_acks(void) {
+    setup(5);
+    acks_to_drop = 2;
+    ch.drop = drop_acks;
+    run(1);
+
+    CHECK(node_b.rx_count[0] == 1);
+    CHECK(node_b.link.stats.duplicates == 2);
+    CHECK(node_b.link.stats.acks_sent == 3);
+    CHECK(node_a.link.stats.retransmits == 2);
+    CHECK(node_a.acked[0] == 1);
+    ch.drop = NULL;
+}
+
+// Canal mudo: o pacote é abandonado depois de LORA_LINK_MAX_RETRIES e a janela libera
+static void test_give_up(void) {
+    setup(9);
+    ch.loss_permille = 1000;
+    run(1);
+
+    CHECK(node_a.failed[0] == 1);
+    CHECK(node_a.acked[0] == 0);
+    CHECK(node_a.link.stats.failed == 1);
+    CHECK(node_a.link.stats.retransmits == LORA_LINK_MAX_RETRIES);
+    CHECK(node_a.radio.tx_packets == 1 + LORA_LINK_MAX_RETRIES);
+    CHECK(lora_link_pending(&node_a.link) == 0);
+    CHECK(node_b.rx_n == 0);
+
+    // Depois da desistência o enlace continua funcionando
+    ch.loss_permille = 0;
+    run(3);
+    CHECK(node_b.rx_n == 3);    // run() recomeça nos ids 0, 1 e 2
+}
+
+// Fila do rádio cheia em lora_link_send(): a primeira tentativa sai no poll
+// e não conta como retransmissão, então ainda há LORA_LINK_MAX_RETRIES delas
+static void test_radio_queue_full(void) {
+    static const uint8_t other[] = { 0x42, 1, 2 };
+    setup(19);
+    ch.loss_permille = 1000;
+    for (int i = 0; i < LORA_TX_QUEUE_LEN; i++) {
+        CHECK(sim_radio_ops.send(&node_a.radio, other, sizeof(other), NULL, NULL));
+    }
+    run(1);
+
+    CHECK(node_a.failed[0] == 1);
+    CHECK(node_a.link.stats.sent == 1);
+    CHECK(node_a.link.stats.retransmits == LORA_LINK_MAX_RETRIES);
+    CHECK(node_a.radio.tx_packets == LORA_TX_QUEUE_LEN + 1 + LORA_LINK_MAX_RETRIES);
+
+    // Canal perfeito com a fila cheia: confirmado sem retransmissão
+    setup(19);
+    for (int i = 0; i < LORA_TX_QUEUE_LEN; i++) {
+        CHECK(sim_radio_ops.send(&node_a.radio, other, sizeof(other), NULL, NULL));
+    }
+    run(1);
+    CHECK(node_a.acked[0] == 1);
+    CHECK(node_a.link.stats.retransmits == 0);
+}
+
+// Cópias atrasadas depois de a sequência dar a volta não chegam à aplicação
+static void test_stale_copies(void) {
+    setup(13);
+    run(300);
+    CHECK(node_b.rx_n == 300);
+
+    // Último seq recebido: 299 % 256 = 43. Repete um de 10 atrás (no mapa)
+    // e um de 40 atrás (fora do mapa, tratado como repetido)
+    uint8_t frame[LORA_LINK_HEADER_LEN + PAYLOAD_LEN] = { LORA_LINK_DATA, node_a.link.session, 0 };
+    uint32_t dups = node_b.link.stats.duplicates;
+    frame[2] = (uint8_t)(299 - 10);
+    sim_radio_inject(&node_b.radio, frame, sizeof(frame));
+    frame[2] = (uint8_t)(299 - 40);
+    sim_radio_inject(&node_b.radio, frame, sizeof(frame));
+    lora_link_poll(&node_b.link);
+    CHECK(node_b.rx_n == 300);
+    CHECK(node_b.link.stats.duplicates == dups + 2);
+
+    // Pacotes que não são do enlace são só contados
+    static const uint8_t other[] = { 0x42, 1, 2 };
+    sim_radio_inject(&node_b.radio, other, sizeof(other));
+    lora_link_poll(&node_b.link);
+    CHECK(node_b.link.stats.foreign == 1);
+}
+
+// A reinicia no meio do fluxo: o seq recomeça em 0 com outra sessão. Antes,
+// o receptor tomava os seqs até 32 atrás por repetidos (e os confirmava sem
+// entregar) e os de 33 a 127 atrás por velhos demais (retransmitidos até a
+// desistência).
+static void test_sender_restart(void) {
+    static const uint16_t before[] = { 10, 40, 100 };
+
+    for (size_t c = 0; c < sizeof(before) / sizeof(before[0]); c++) {
+        setup(17 + (uint32_t)c);
+        run(before[c]);
+        CHECK(node_b.rx_n == before[c]);
+
+        uint8_t old_session = node_a.link.session;
+        lora_link_init_radio(&node_a.link, &sim_radio_ops, &node_a.radio, on_receive, on_sent, &node_a);
+        CHECK(node_a.link.session != old_session);
+
+        // Um ACK atrasado da sessão anterior não confirma o seq 0 novo
+        CHECK(send_id(&node_a, before[c]));
+        const uint8_t stale_ack[] = { LORA_LINK_ACK, old_session, 0, 0xFF, 0xFF, 0xFF, 0xFF };
+        sim_radio_inject(&node_a.radio, stale_ack, sizeof(stale_ack));
+        lora_link_poll(&node_a.link);
+        CHECK(node_a.acked[before[c]] == 0);
+        CHECK(lora_link_pending(&node_a.link) == 1);
+        CHECK(node_a.link.stats.stale_acks == 1);
+
+        run_ids(before[c] + 1, before[c] + 50);
+
+        bool all = true;
+        for (uint16_t id = 0; id < before[c] + 50; id++) {
+            all &= node_b.rx_count[id] == 1 && node_a.acked[id] == 1;
+        }
+        CHECK(all);
+        CHECK(node_b.rx_n == before[c] + 50u);
+        CHECK(node_b.link.stats.duplicates == 0);
+        CHECK(node_a.link.stats.failed == 0);
+        CHECK(node_a.link.stats.retransmits == 0);
+    }
+}
+
+int main(void) {
+    test_clean();
+    test_lossy();
+    test_selective_ack();
+    test_lost_acks();
+    test_give_up();
+    test_radio_queue_full();
+    test_stale_copies();
+    test_sender_restart();
+
+    if (failures) {
+        printf("test_lora_link: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_lora_link: ok\n");
+    return 0;
+}
@@ -0,0 +1,108 @@
+// test_lora_profile.c - Testes no host do tempo no ar e do perfil do modem.
+//
+// Os valores de referência saem da fórmula do datasheet do SX1276 calculada
+// em ponto flutuante (cabeçalho explícito, CRC ligado), em microssegundos;
+// os de 20 bytes batem com a calculadora de tempo no ar da Semtech.
+
+#include <stdio.h>
+
+#include "lora_profile.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static lora_profile_t make(uint8_t sf, lora_bw_t bw, lora_cr_t cr, uint16_t preamble, lora_ldro_t ldro) {
+    lora_profile_t p = { sf, bw, cr, preamble, ldro, 0x12 };
+    return p;
+}
+
+// Compara com a referência, aceitando o arredondamento para baixo do inteiro
+static void check_toa(lora_profile_t p, size_t len, uint32_t expected_us, int line) {
+    uint32_t us = lora_profile_time_on_air_us(&p, len);
+    if (us > expected_us || expected_us - us > 1) {
+        printf("%s:%d: falhou: SF%u, %zu bytes: %u us, esperado %u us\n", __FILE__, line, p.sf, len, us, expected_us);
+        failures++;
+    }
+}
+
+#define CHECK_TOA(p, len, expected) check_toa((p), (len), (expected), __LINE__)
+
+static void test_time_on_air(void) {
+    // SF7 / 125 kHz / CR 4/5 / preâmbulo 8, 20 bytes: 56,6 ms
+    CHECK_TOA(make(7, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO), 20, 56576);
+
+    // SF12 / 125 kHz: símbolo de 32,8 ms, LDRO ligada automaticamente
+    CHECK_TOA(make(12, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO), 20, 1318912);
+    CHECK_TOA(make(12, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO), 51, 2465792);
+    CHECK_TOA(make(12, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_ON), 51, 2465792);
+    // Sem LDRO cabem mais bits por símbolo
+    CHECK_TOA(make(12, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_OFF), 51, 2138112);
+
+    // Perfil padrão da biblioteca: SF12 / 62,5 kHz / CR 4/8 / preâmbulo 12
+    lora_profile_t def = LORA_PROFILE_DEFAULT;
+    CHECK_TOA(def, 20, 3686400);
+
+    CHECK_TOA(make(11, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO), 20, 741376);
+    CHECK_TOA(make(9, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO), 10, 144384);
+    CHECK_TOA(make(10, LORA_BW_250_KHZ, LORA_CR_4_6, 8, LORA_LDRO_AUTO), 255, 1360896);
+
+    // Payload vazio: só o preâmbulo e os 8 símbolos fixos
+    CHECK_TOA(make(7, LORA_BW_500_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO), 0, 6464);
+
+    // Cresce com o payload e nunca diminui
+    lora_profile_t p = make(8, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO);
+    uint32_t prev = 0;
+    for (size_t len = 0; len <= 255; len++) {
+        uint32_t us = lora_profile_time_on_air_us(&p, len);
+        CHECK(us >= prev);
+        prev = us;
+    }
+
+    // Resultados que não cabem em 32 bits saturam em vez de dar a volta
+    CHECK(lora_profile_time_on_air_us(&(lora_profile_t){ 12, LORA_BW_7_8_KHZ, LORA_CR_4_8, 65535, LORA_LDRO_AUTO, 0x12 }, 255) == UINT32_MAX);
+}
+
+static void test_ldro(void) {
+    // Automática: ligada quando o símbolo passa de 16 ms
+    CHECK(lora_profile_ldro(&(lora_profile_t){ 11, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(lora_profile_ldro(&(lora_profile_t){ 10, LORA_BW_62_5_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(lora_profile_ldro(&(lora_profile_t){ 12, LORA_BW_250_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(!lora_profile_ldro(&(lora_profile_t){ 10, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(!lora_profile_ldro(&(lora_profile_t){ 11, LORA_BW_250_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+
+    // Forçada
+    CHECK(lora_profile_ldro(&(lora_profile_t){ 7, LORA_BW_500_KHZ, LORA_CR_4_5, 8, LORA_LDRO_ON, 0x12 }));
+    CHECK(!lora_profile_ldro(&(lora_profile_t){ 12, LORA_BW_7_8_KHZ, LORA_CR_4_5, 8, LORA_LDRO_OFF, 0x12 }));
+
+    CHECK(lora_profile_symbol_us(&(lora_profile_t){ 7, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }) == 1024);
+    CHECK(lora_profile_symbol_us(&(lora_profile_t){ 12, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }) == 32768);
+}
+
+static void test_valid(void) {
+    lora_profile_t def = LORA_PROFILE_DEFAULT;
+    CHECK(lora_profile_valid(&def));
+    CHECK(!lora_profile_valid(&(lora_profile_t){ 6, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(!lora_profile_valid(&(lora_profile_t){ 13, LORA_BW_125_KHZ, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(!lora_profile_valid(&(lora_profile_t){ 7, (lora_bw_t)10, LORA_CR_4_5, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(!lora_profile_valid(&(lora_profile_t){ 7, LORA_BW_125_KHZ, (lora_cr_t)0, 8, LORA_LDRO_AUTO, 0x12 }));
+    CHECK(!lora_profile_valid(&(lora_profile_t){ 7, LORA_BW_125_KHZ, LORA_CR_4_5, 5, LORA_LDRO_AUTO, 0x12 }));
+}
+
+int main(void) {
+    test_time_on_air();
+    test_ldro();
+    test_valid();
+
+    if (failures) {
+        printf("test_lora_profile: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_lora_profile: ok\n");
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "max30102.h"
+
+// handles com pino INT, para a callback de GPIO achar o dono da borda
+static max30102_t *irq_devs[2];
+
+static void max30102_int_handler(uint gpio, uint32_t events) {
+    (void)events;
+    for (uint i = 0; i < count_of(irq_devs); i++) {
+        if (irq_devs[i] && irq_devs[i]->pin_int == (int)gpio) {
+            irq_devs[i]->irq = true;
+        }
+    }
+}
+
+void max30102_bus_init(i2c_inst_t *i2c, uint sda, uint scl) {
+    i2c_init(i2c, 400 * 1000); // Comunicação I2C a 400 kHz (modo Fast)
+    gpio_set_function(sda, GPIO_FUNC_I2C);
+    gpio_set_function(scl, GPIO_FUNC_I2C);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+}
+
+void max30102_get_default_config(struct max30102_config *cfg) {
+    // configuração usada até aqui pelos programas do oxímetro: modo SpO2,
+    // 400 Hz com média de 4 (100 Hz de dados), pulso de 411 µs (18 bits), 4096 nA e LEDs em ~7,2 mA
+    const struct max30102_config def = {
+        .mode = MAX30102_MODE_SPO2,
+        .sample_rate = MAX30102_SR_400_HZ,
+        .pulse_width = MAX30102_PW_411_US,
+        .adc_range = MAX30102_ADC_4096_NA,
+        .sample_avg = MAX30102_AVG_4,
+        .a_full_samples = 17,
+        .led_red_pa = 0x24,
+        .led_ir_pa = 0x24,
+        .slots = { MAX30102_SLOT_RED, MAX30102_SLOT_IR, MAX30102_SLOT_NONE, MAX30102_SLOT_NONE },
+    };
+    *cfg = def;
+}
+
+void max30102_write_reg(max30102_t *dev, uint8_t reg, uint8_t val) {
+    uint8_t buf[2] = {reg, val};
+    i2c_write_blocking(dev->i2c, MAX30102_ADDR, buf, 2, false);
+}
+
+uint8_t max30102_read_reg(max30102_t *dev, uint8_t reg) {
+    uint8_t val;
+    i2c_write_blocking(dev->i2c, MAX30102_ADDR, &reg, 1, true); // repeated start
+    i2c_read_blocking(dev->i2c, MAX30102_ADDR, &val, 1, false);
+    return val;
+}
+
+void max30102_reset(max30102_t *dev) {
+    max30102_write_reg(dev, MAX30102_REG_MODE_CONFIG, MAX30102_MODE_RESET);
+    sleep_ms(100);
+}
+
+float max30102_sample_rate_hz(const struct max30102_config *cfg) {
+    static const uint16_t rates[] = { 50, 100, 200, 400, 800, 1000, 1600, 3200 };
+    return (float)rates[cfg->sample_rate] / (float)(1u << cfg->sample_avg);
+}
+
+void max30102_configure(max30102_t *dev, const struct max30102_config *cfg) {
+    dev->config = *cfg;
+
+    // leituras por amostra: RED e IR no SpO2, só RED no HR, os slots em uso no multi-LED
+    if (cfg->mode == MAX30102_MODE_MULTI_LED) {
+        dev->channels = 0;
+        while (dev->channels < MAX30102_MAX_SLOTS && cfg->slots[dev->channels] != MAX30102_SLOT_NONE) {
+            dev->channel_led[dev->channels] = cfg->slots[dev->channels];
+            dev->channels++;
+        }
+    } else {
+        dev->channel_led[0] = MAX30102_SLOT_RED;
+        dev->channel_led[1] = MAX30102_SLOT_IR;
+        dev->channels = cfg->mode == MAX30102_MODE_SPO2 ? 2 : 1;
+    }
+
+    // desliga as medidas enquanto reconfigura e descarta o que estava na FIFO
+    max30102_write_reg(dev, MAX30102_REG_MODE_CONFIG, 0x00);
+    max30102_write_reg(dev, MAX30102_REG_FIFO_WR_PTR, 0x00);
+    max30102_write_reg(dev, MAX30102_REG_FIFO_OVF_CNT, 0x00);
+    max30102_write_reg(dev, MAX30102_REG_FIFO_RD_PTR, 0x00);
+    dev->ring_head = dev->ring_tail = 0;
+
+    // média, rollover habilitado e A_FULL com (32 - a_full_samples) espaços vazios
+    uint8_t a_full = cfg->a_full_samples;
+    if (a_full < MAX30102_FIFO_DEPTH - 15) a_full = MAX30102_FIFO_DEPTH - 15;
+    if (a_full > MAX30102_FIFO_DEPTH) a_full = MAX30102_FIFO_DEPTH;
+    max30102_write_reg(dev, MAX30102_REG_FIFO_CONFIG, (uint8_t)((cfg->sample_avg << 5) | (1 << 4) | (MAX30102_FIFO_DEPTH - a_full)));
+
+    max30102_write_reg(dev, MAX30102_REG_SPO2_CONFIG, (uint8_t)((cfg->adc_range << 5) | (cfg->sample_rate << 2) | cfg->pulse_width));
+    max30102_write_reg(dev, MAX30102_REG_LED1_PA, cfg->led_red_pa);
+    max30102_write_reg(dev, MAX30102_REG_LED2_PA, cfg->led_ir_pa);
+
+    if (cfg->mode == MAX30102_MODE_MULTI_LED) {
+        max30102_write_reg(dev, MAX30102_REG_MULTILED_CTRL1, (uint8_t)((cfg->slots[1] << 4) | cfg->slots[0]));
+        max30102_write_reg(dev, MAX30102_REG_MULTILED_CTRL2, (uint8_t)((cfg->slots[3] << 4) | cfg->slots[2]));
+    }
+
+    max30102_write_reg(dev, MAX30102_REG_MODE_CONFIG, (uint8_t)cfg->mode);
+}
+
+bool max30102_init(max30102_t *dev, i2c_inst_t *i2c, int pin_int, const struct max30102_config *cfg) {
+    *dev = (max30102_t){0};
+    dev->i2c = i2c;
+    dev->pin_int = pin_int;
+
+    max30102_reset(dev);
+
+    if (pin_int >= 0) {
+        for (uint i = 0; i < count_of(irq_devs); i++) {
+            if (!irq_devs[i] || irq_devs[i] == dev) {
+                irq_devs[i] = dev;
+                break;
+            }
+        }
+        gpio_init((uint)pin_int);
+        gpio_set_dir((uint)pin_int, GPIO_IN);
+        gpio_pull_up((uint)pin_int);
+        gpio_set_irq_enabled_with_callback((uint)pin_int, GPIO_IRQ_EDGE_FALL, true, &max30102_int_handler);
+        max30102_write_reg(dev, MAX30102_REG_INTR_ENABLE_1, MAX30102_INTR_A_FULL);
+    }
+    // a leitura do status descarta o aviso de power-ready que vem do reset
+    max30102_read_reg(dev, MAX30102_REG_INTR_STATUS_1);
+
+    max30102_configure(dev, cfg);
+
+    dev->part_id = max30102_read_reg(dev, MAX30102_REG_PART_ID);
+    return dev->part_id == MAX30102_PART_ID;
+}
+
+int max30102_read_burst(max30102_t *dev) {
+    // INTR_STATUS_1 até RD_PTR numa transação só: ler o status libera o pino
+    // INT (senão ele fica baixo e não há nova borda), e os ponteiros vêm junto
+    uint8_t regs[MAX30102_REG_FIFO_RD_PTR - MAX30102_REG_INTR_STATUS_1 + 1];
+    uint8_t reg = MAX30102_REG_INTR_STATUS_1;
+    i2c_write_blocking(dev->i2c, MAX30102_ADDR, &reg, 1, true);
+    i2c_read_blocking(dev->i2c, MAX30102_ADDR, regs, sizeof(regs), false);
+
+    uint8_t wr = regs[MAX30102_REG_FIFO_WR_PTR] & 0x1F;
+    uint8_t ovf = regs[MAX30102_REG_FIFO_OVF_CNT] & 0x1F;
+    uint8_t rd = regs[MAX30102_REG_FIFO_RD_PTR] & 0x1F;
+
+    // com overflow os ponteiros se igualam e a FIFO está cheia
+    int count = ovf ? MAX30102_FIFO_DEPTH : (wr - rd) & (MAX30102_FIFO_DEPTH - 1);
+    dev->fifo_overflows += ovf;
+    if (count == 0 || dev->channels == 0) return 0;
+
+    // cada leitura de FIFO_DATA avança a FIFO: todas as amostras de uma vez
+    uint8_t data[MAX30102_FIFO_DEPTH * MAX30102_MAX_SLOTS * 3];
+    uint bytes_per_sample = 3u * dev->channels;
+    reg = MAX30102_REG_FIFO_DATA;
+    i2c_write_blocking(dev->i2c, MAX30102_ADDR, &reg, 1, true);
+    i2c_read_blocking(dev->i2c, MAX30102_ADDR, data, count * bytes_per_sample, false);
+    dev->bursts++;
+
+    for (int i = 0; i < count; i++) {
+        const uint8_t *p = &data[i * bytes_per_sample];
+        uint32_t red = 0, ir = 0;
+        for (uint c = 0; c < dev->channels; c++, p += 3) {
+            // 3 bytes por leitura -> Mascarar para 18 bits
+            uint32_t v = ((uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2]) & 0x3FFFF;
+            if (dev->channel_led[c] == MAX30102_SLOT_RED) {
+                red = v;
+            } else {
+                ir = v;
+            }
+        }
+
+        if (dev->ring_head - dev->ring_tail == MAX30102_RING_LEN) {
+            dev->ring_tail++; // fila cheia: descarta a amostra mais antiga
+            dev->ring_overflows++;
+        }
+        dev->ring_red[dev->ring_head & (MAX30102_RING_LEN - 1)] = red;
+        dev->ring_ir[dev->ring_head & (MAX30102_RING_LEN - 1)] = ir;
+        dev->ring_head++;
+    }
+    return count;
+}
+
+bool max30102_read_sample(max30102_t *dev, uint32_t *red, uint32_t *ir) {
+    if (dev->ring_head == dev->ring_tail) {
+        // com o INT ligado, só vai ao sensor se ele sinalizou (borda ou pino ainda baixo)
+        if (dev->pin_int >= 0 && !dev->irq && gpio_get((uint)dev->pin_int)) return false;
+        dev->irq = false;
+        if (max30102_read_burst(dev) == 0) return false;
+    }
+
+    *red = dev->ring_red[dev->ring_tail & (MAX30102_RING_LEN - 1)];
+    *ir = dev->ring_ir[dev->ring_tail & (MAX30102_RING_LEN - 1)];
+    dev->ring_tail++;
+    return true;
+}
@@ -0,0 +1,146 @@
+#ifndef MAX30102_H
+#define MAX30102_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+/* Driver do sensor oxímetro/batimentos MAX30102 (módulo OXI BAT)
+
+   Compartilhado pelos programas de oximetro/ e oximetro/sensor_oximetro_bc/.
+   As amostras são lidas da FIFO do sensor em rajada (ponteiros em uma
+   transação, todas as amostras pendentes em outra) para uma fila circular
+   no handle. Com o pino INT ligado, a leitura só acontece quando o sensor
+   avisa que a FIFO está quase cheia (A_FULL); sem ele, a FIFO é consultada
+   sempre que a fila esvazia.
+
+   AVISO: feito para o MAX30102; pode não ser compatível com o MAX30101.
+ */
+
+#define MAX30102_ADDR       _u(0x57)
+#define MAX30102_PART_ID    _u(0x15)    // valor de REG_PART_ID no MAX30102
+
+// registradores
+#define MAX30102_REG_INTR_STATUS_1  _u(0x00)
+#define MAX30102_REG_INTR_ENABLE_1  _u(0x02)
+#define MAX30102_REG_FIFO_WR_PTR    _u(0x04)
+#define MAX30102_REG_FIFO_OVF_CNT   _u(0x05)
+#define MAX30102_REG_FIFO_RD_PTR    _u(0x06)
+#define MAX30102_REG_FIFO_DATA      _u(0x07)
+#define MAX30102_REG_FIFO_CONFIG    _u(0x08)
+#define MAX30102_REG_MODE_CONFIG    _u(0x09)
+#define MAX30102_REG_SPO2_CONFIG    _u(0x0A)
+#define MAX30102_REG_LED1_PA        _u(0x0C)    // corrente do LED RED
+#define MAX30102_REG_LED2_PA        _u(0x0D)    // corrente do LED IR
+#define MAX30102_REG_MULTILED_CTRL1 _u(0x11)    // slots 1 e 2
+#define MAX30102_REG_MULTILED_CTRL2 _u(0x12)    // slots 3 e 4
+#define MAX30102_REG_PART_ID        _u(0xFF)
+
+#define MAX30102_INTR_A_FULL    _u(0x80)    // FIFO quase cheia
+#define MAX30102_MODE_RESET     _u(0x40)
+
+#define MAX30102_FIFO_DEPTH     32          // amostras na FIFO do sensor
+#define MAX30102_MAX_SLOTS      4
+#define MAX30102_RING_LEN       64          // potência de 2, com folga para duas rajadas
+
+// modo de operação (MODE_CONFIG mode[2:0])
+typedef enum {
+    MAX30102_MODE_HR = 0x02,        // só RED
+    MAX30102_MODE_SPO2 = 0x03,      // RED e IR
+    MAX30102_MODE_MULTI_LED = 0x07, // LEDs escolhidos por slot
+} max30102_mode_t;
+
+// taxa de amostragem (SPO2_CONFIG sr[4:2])
+typedef enum {
+    MAX30102_SR_50_HZ = 0x00,
+    MAX30102_SR_100_HZ = 0x01,
+    MAX30102_SR_200_HZ = 0x02,
+    MAX30102_SR_400_HZ = 0x03,
+    MAX30102_SR_800_HZ = 0x04,
+    MAX30102_SR_1000_HZ = 0x05,
+    MAX30102_SR_1600_HZ = 0x06,
+    MAX30102_SR_3200_HZ = 0x07,
+} max30102_sample_rate_t;
+
+// largura do pulso do LED e resolução do ADC (SPO2_CONFIG led_pw[1:0])
+typedef enum {
+    MAX30102_PW_69_US = 0x00,   // 15 bits
+    MAX30102_PW_118_US = 0x01,  // 16 bits
+    MAX30102_PW_215_US = 0x02,  // 17 bits
+    MAX30102_PW_411_US = 0x03,  // 18 bits
+} max30102_pulse_width_t;
+
+// fundo de escala do ADC (SPO2_CONFIG adc_rge[6:5])
+typedef enum {
+    MAX30102_ADC_2048_NA = 0x00,
+    MAX30102_ADC_4096_NA = 0x01,
+    MAX30102_ADC_8192_NA = 0x02,
+    MAX30102_ADC_16384_NA = 0x03,
+} max30102_adc_range_t;
+
+// média de amostras antes da FIFO (FIFO_CONFIG smp_ave[7:5])
+typedef enum {
+    MAX30102_AVG_1 = 0x00,
+    MAX30102_AVG_2 = 0x01,
+    MAX30102_AVG_4 = 0x02,
+    MAX30102_AVG_8 = 0x03,
+    MAX30102_AVG_16 = 0x04,
+    MAX30102_AVG_32 = 0x05,
+} max30102_sample_avg_t;
+
+// LED de cada slot no modo multi-LED (MULTILED_CTRLx)
+typedef enum {
+    MAX30102_SLOT_NONE = 0x00,
+    MAX30102_SLOT_RED = 0x01,
+    MAX30102_SLOT_IR = 0x02,
+} max30102_slot_t;
+
+struct max30102_config {
+    max30102_mode_t mode;
+    max30102_sample_rate_t sample_rate;
+    max30102_pulse_width_t pulse_width;
+    max30102_adc_range_t adc_range;
+    max30102_sample_avg_t sample_avg;
+    uint8_t a_full_samples;     // amostras na FIFO que disparam o A_FULL (17 a 32)
+    uint8_t led_red_pa;         // corrente do LED, 0,2 mA por passo (0x24 ~ 7,2 mA)
+    uint8_t led_ir_pa;
+    max30102_slot_t slots[MAX30102_MAX_SLOTS]; // só no modo multi-LED, preenchidos em ordem
+};
+
+// um MAX30102 em um barramento I2C
+typedef struct {
+    i2c_inst_t *i2c;
+    int pin_int;                // pino INT (dreno aberto, ativo em nível baixo), ou -1
+    uint8_t part_id;
+    struct max30102_config config;
+
+    // leituras de 3 bytes por amostra e o LED de cada uma
+    uint8_t channels;
+    max30102_slot_t channel_led[MAX30102_MAX_SLOTS];
+
+    // fila de amostras já lidas; índices livres, a máscara é aplicada no acesso
+    volatile bool irq;
+    uint32_t ring_red[MAX30102_RING_LEN];
+    uint32_t ring_ir[MAX30102_RING_LEN];
+    uint32_t ring_head;
+    uint32_t ring_tail;
+
+    uint32_t bursts;            // leituras em rajada da FIFO
+    uint32_t fifo_overflows;    // amostras perdidas na FIFO do sensor
+    uint32_t ring_overflows;    // amostras descartadas por falta de espaço na fila
+} max30102_t;
+
+// Funções da biblioteca
+void max30102_bus_init(i2c_inst_t *i2c, uint sda, uint scl);
+void max30102_get_default_config(struct max30102_config *cfg);
+bool max30102_init(max30102_t *dev, i2c_inst_t *i2c, int pin_int, const struct max30102_config *cfg);
+void max30102_configure(max30102_t *dev, const struct max30102_config *cfg);
+void max30102_reset(max30102_t *dev);
+float max30102_sample_rate_hz(const struct max30102_config *cfg);
+void max30102_write_reg(max30102_t *dev, uint8_t reg, uint8_t val);
+uint8_t max30102_read_reg(max30102_t *dev, uint8_t reg);
+int max30102_read_burst(max30102_t *dev);
+bool max30102_read_sample(max30102_t *dev, uint32_t *red, uint32_t *ir);
+
+#endif
@@ -0,0 +1,127 @@
+#include <string.h>
+#include "max30102_spo2.h"
+
+#define WINDOW_MASK (MAX30102_SPO2_WINDOW - 1)
+#define WINDOW_SHIFT (__builtin_ctz(MAX30102_SPO2_WINDOW))
+
+void max30102_spo2_init(max30102_spo2_t *est, float sample_rate_hz) {
+    memset(est, 0, sizeof(*est));
+    est->sample_rate_hz = sample_rate_hz;
+    est->min_interval = (uint32_t)(sample_rate_hz * 60.0f / 220.0f);
+    est->max_interval = (uint32_t)(sample_rate_hz * 60.0f / 40.0f);
+}
+
+static uint32_t abs_diff(uint32_t a, uint32_t b) {
+    return a > b ? a - b : b - a;
+}
+
+static void max30102_spo2_add_interval(max30102_spo2_t *est, uint32_t interval) {
+    if (est->interval_count == MAX30102_SPO2_BEATS) {
+        est->interval_sum -= est->intervals[est->interval_idx];
+    } else {
+        est->interval_count++;
+    }
+    est->intervals[est->interval_idx] = interval;
+    est->interval_sum += interval;
+    est->interval_idx = (uint8_t)((est->interval_idx + 1) % MAX30102_SPO2_BEATS);
+}
+
+static void max30102_spo2_clear_beats(max30102_spo2_t *est) {
+    est->interval_count = 0;
+    est->interval_idx = 0;
+    est->interval_sum = 0;
+}
+
+// Retorna true quando a amostra anterior foi um batimento
+bool max30102_spo2_update(max30102_spo2_t *est, uint32_t red, uint32_t ir) {
+    uint32_t slot = est->n & WINDOW_MASK;
+    bool full = est->n >= MAX30102_SPO2_WINDOW;
+
+    // DC: a amostra nova entra na soma e a mais antiga sai
+    if (full) {
+        est->red_sum -= est->red[slot];
+        est->ir_sum -= est->ir[slot];
+        est->red_dev_sum -= est->red_dev[slot];
+        est->ir_dev_sum -= est->ir_dev[slot];
+    }
+    est->red[slot] = red;
+    est->ir[slot] = ir;
+    est->red_sum += red;
+    est->ir_sum += ir;
+    est->n++;
+
+    uint32_t count = full ? MAX30102_SPO2_WINDOW : est->n;
+    uint32_t red_dc = full ? est->red_sum >> WINDOW_SHIFT : est->red_sum / count;
+    uint32_t ir_dc = full ? est->ir_sum >> WINDOW_SHIFT : est->ir_sum / count;
+
+    // AC: desvio de cada amostra em relação à média do momento em que entrou
+    est->red_dev[slot] = abs_diff(red, red_dc);
+    est->ir_dev[slot] = abs_diff(ir, ir_dc);
+    est->red_dev_sum += est->red_dev[slot];
+    est->ir_dev_sum += est->ir_dev[slot];
+
+    // Sinal de pulso: IR sem DC, suavizado
+    uint32_t s = est->n & 3;
+    est->smooth_sum += (int32_t)ir - (int32_t)ir_dc - est->smooth[s];
+    est->smooth[s] = (int32_t)ir - (int32_t)ir_dc;
+    int32_t cur = est->smooth_sum / 4;
+
+    // Pico na amostra anterior: acima de metade do AC médio e fora do período refratário.
+    // A onda dicrótica também é um máximo local, então o pico precisa ainda de metade
+    // da altura dos últimos batimentos; senão, abaixo de ~70 BPM, conta em dobro.
+    bool beat = false;
+    uint32_t now = est->n - 1;
+    int32_t threshold = (int32_t)(est->ir_dev_sum / count / 2);
+    if (threshold < est->peak_level / 2) {
+        threshold = est->peak_level / 2;
+    }
+    if (full && est->prev1 > est->prev2 && est->prev1 >= cur && est->prev1 > threshold &&
+        now - est->last_beat >= est->min_interval) {
+        uint32_t interval = now - est->last_beat;
+        if (est->last_beat != 0 && interval <= est->max_interval) {
+            max30102_spo2_add_interval(est, interval);
+        } else {
+            max30102_spo2_clear_beats(est); // primeiro batimento ou pulso perdido
+        }
+        est->peak_level = est->prev1 > est->peak_level ? est->prev1 : (3 * est->peak_level + est->prev1) / 4;
+        est->last_beat = now;
+        beat = true;
+    } else if (now - est->last_beat > 2 * est->max_interval) {
+        max30102_spo2_clear_beats(est); // sem batimentos há muito tempo
+        est->peak_level = 0;            // o pulso pode ter voltado mais fraco
+    }
+
+    est->prev2 = est->prev1;
+    est->prev1 = cur;
+    return beat;
+}
+
+bool max30102_spo2_finger(const max30102_spo2_t *est) {
+    uint32_t count = est->n < MAX30102_SPO2_WINDOW ? est->n : MAX30102_SPO2_WINDOW;
+    return count > 0 && est->ir_sum / count > MAX30102_SPO2_FINGER_DC;
+}
+
+bool max30102_spo2_get_spo2(const max30102_spo2_t *est, float *spo2) {
+    if (est->n < MAX30102_SPO2_WINDOW || !max30102_spo2_finger(est) ||
+        est->red_sum == 0 || est->ir_dev_sum == 0) {
+        return false;
+    }
+
+    // (AC_red / DC_red) / (AC_ir / DC_ir); o tamanho da janela se cancela
+    float ratio = ((float)est->red_dev_sum * (float)est->ir_sum) /
+                  ((float)est->red_sum * (float)est->ir_dev_sum);
+    float value = 110.0f - 25.0f * ratio; // Fórmula empírica
+
+    if (value > 100.0f) value = 100.0f;
+    if (value < 80.0f) value = 80.0f;
+    *spo2 = value;
+    return true;
+}
+
+bool max30102_spo2_get_bpm(const max30102_spo2_t *est, float *bpm) {
+    if (est->interval_count < 2 || !max30102_spo2_finger(est)) {
+        return false;
+    }
+    *bpm = 60.0f * est->sample_rate_hz * (float)est->interval_count / (float)est->interval_sum;
+    return true;
+}
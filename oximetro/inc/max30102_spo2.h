@@ -0,0 +1,56 @@
+#ifndef MAX30102_SPO2_H
+#define MAX30102_SPO2_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Estimativa contínua de SpO2 e BPM a partir das amostras RED/IR
+
+   Cada amostra atualiza somas corridas de uma janela deslizante (DC = média,
+   AC = desvio absoluto médio em relação à média) e um detector de picos no IR,
+   sempre com o mesmo trabalho por amostra, sem esperar um bloco inteiro. Os
+   resultados são calculados na consulta a partir dessas somas.
+ */
+
+// amostras da janela deslizante (potência de 2); a 100 Hz são ~1,3 s
+#define MAX30102_SPO2_WINDOW    128
+
+// intervalos entre batimentos usados na média do BPM
+#define MAX30102_SPO2_BEATS     8
+
+// DC do IR abaixo disso indica que não há dedo no sensor
+#define MAX30102_SPO2_FINGER_DC 10000
+
+typedef struct {
+    float sample_rate_hz;
+    uint32_t n;                 // amostras recebidas
+
+    // janela deslizante: amostras e desvios, com as somas correspondentes
+    uint32_t red[MAX30102_SPO2_WINDOW];
+    uint32_t ir[MAX30102_SPO2_WINDOW];
+    uint32_t red_dev[MAX30102_SPO2_WINDOW];
+    uint32_t ir_dev[MAX30102_SPO2_WINDOW];
+    uint32_t red_sum, ir_sum;
+    uint32_t red_dev_sum, ir_dev_sum;
+
+    // detector de picos no IR sem DC (suavizado por média de 4 amostras)
+    int32_t smooth[4];
+    int32_t smooth_sum;
+    int32_t prev1, prev2;
+    int32_t peak_level;         // altura dos últimos batimentos (sobe na hora, desce aos poucos)
+    uint32_t last_beat;
+    uint32_t min_interval, max_interval;   // limites de 220 e 40 BPM, em amostras
+
+    uint32_t intervals[MAX30102_SPO2_BEATS];
+    uint32_t interval_sum;
+    uint8_t interval_count;
+    uint8_t interval_idx;
+} max30102_spo2_t;
+
+void max30102_spo2_init(max30102_spo2_t *est, float sample_rate_hz);
+bool max30102_spo2_update(max30102_spo2_t *est, uint32_t red, uint32_t ir);
+bool max30102_spo2_finger(const max30102_spo2_t *est);
+bool max30102_spo2_get_spo2(const max30102_spo2_t *est, float *spo2);
+bool max30102_spo2_get_bpm(const max30102_spo2_t *est, float *bpm);
+
+#endif
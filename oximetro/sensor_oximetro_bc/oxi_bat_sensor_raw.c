@@ -18,132 +18,30 @@ Os valores de RED e IR medidos podem ser lidos via Serial Monitor.
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "max30102.h"
 
 // Definições de I2C
 #define I2C_PORT i2c0
 #define I2C_SDA 0          // GPIO 0
 #define I2C_SCL 1          // GPIO 1
 
-#define MAX30102_ADDR    0x57
-
-// Lista de endereços de registradores
-#define REG_INTR_STATUS_1   0x00
-#define REG_INTR_ENABLE_1   0x02
-#define REG_FIFO_WR_PTR     0x04
-#define REG_FIFO_OVF_CNT    0x05
-#define REG_FIFO_RD_PTR     0x06
-#define REG_FIFO_DATA       0x07
-#define REG_FIFO_CONFIG     0x08
-#define REG_MODE_CONFIG     0x09
-#define REG_SPO2_CONFIG     0x0A
-#define REG_LED1_PA         0x0C   // Corrente do LED RED
-#define REG_LED2_PA         0x0D   // Corrente do LED IR
-#define REG_MULTILED_CTRL1  0x11
-#define REG_PART_ID         0xFF   // Deve retornar 0x15
-
-/*
---- CONFIGURAR I2C ---
-    Função de inicialização e configuração geral do I2C.
-*/
-void config_i2c() {
-    i2c_init(i2c0, 400 * 1000); // Comunicação I2C a 400 kHz (modo Fast) para melhor desempenho
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
-}
-
-/*
---- ESCRITA DO SENSOR MAX30102 ---
-    Escreve um valor de 8 bits em um registrador do sensor, montando um
-    buffer com o endereço do registrador e o valor a ser escrito. Usa
-    i2c_write_blocking() para transmitir ao sensor via I2C.
-*/
-static inline void max30102_write(uint8_t reg, uint8_t val) {
-    uint8_t buf[2] = {reg, val};
-    i2c_write_blocking(I2C_PORT, MAX30102_ADDR, buf, 2, false); // Libera escrita
-}
-
-/*
---- LEITURA DO SENSOR MAX30102 ---
-    Lê um valor de 8 bits de um registrador do sensor, primeiro enviando
-    o endereço do registrador com repeated start (não finaliza a
-    comunicação com stop bit), depois lê 1 byte.
-*/
-static inline uint8_t max30102_read(uint8_t reg) {
-    uint8_t val;
-    i2c_write_blocking(I2C_PORT, MAX30102_ADDR, &reg, 1, true); // Bloqueia escrita
-    i2c_read_blocking(I2C_PORT, MAX30102_ADDR, &val, 1, false); // Libera leitura
-    return val;
-}
-
-/*
---- INICIALIZAÇÃO DO SENSOR ---
-*/
-void max30102_init(void) {
-    // Soft reset
-    max30102_write(REG_MODE_CONFIG, 0x40);
-    sleep_ms(100);
-
-    // Limpar ponteiros do buffer FIFO
-    max30102_write(REG_FIFO_WR_PTR, 0x00);  // Ponteiro Write
-    max30102_write(REG_FIFO_OVF_CNT, 0x00); // Ponteiro Overflow
-    max30102_write(REG_FIFO_RD_PTR, 0x00);  // Ponteiro Read
-
-    // Configuração FIFO:
-    //   - média de amostras = 4
-    //   - rollover habilitado
-    //   - limite de amostras = 17
-    max30102_write(REG_FIFO_CONFIG, (0b010 << 5) | (1 << 4) | 0x11);
-
-    // Configuração de SpO2:
-    //   - resolução do ADC: 4096 nA
-    //   - taxa de amostragem de 100 Hz
-    //   - 411 µs (18 bits de amplitude)
-    max30102_write(REG_SPO2_CONFIG, (0b01 << 5) | (0b011 << 2) | 0b11);
-
-    // Amplitudes de operação dos LEDs (~6.4 mA -> 0x24)
-    max30102_write(REG_LED1_PA, 0x24);  // RED
-    max30102_write(REG_LED2_PA, 0x24);  // IR
-
-    // Habilitação do modo SpO2 (RED e IR)
-    //   - 0x03 = modo SpO₂
-    max30102_write(REG_MODE_CONFIG, 0x03);
-}
-
-/*
---- LEITURA DE AMOSTRA RED/IR ---
-    1. Verifica se há dados não lidos no buffer FIFO;
-    2. Caso haja, lê 6 bytes do buffer (3 para RED e 3 para IR);
-    3. Constrói inteiros de 18 bits.
-*/
-bool max30102_read_sample(uint32_t *red, uint32_t *ir) {
-    uint8_t wr = max30102_read(REG_FIFO_WR_PTR);
-    uint8_t rd = max30102_read(REG_FIFO_RD_PTR);
-    if (wr == rd) return false;     // Sem amostras não lidas
-
-    uint8_t data[6];
-    uint8_t reg = REG_FIFO_DATA;
-    i2c_write_blocking(I2C_PORT, MAX30102_ADDR, &reg, 1, true);
-    i2c_read_blocking (I2C_PORT, MAX30102_ADDR, data, 6, false);
-
-    // 3 bytes por amostra -> Mascarar para 18 bits
-    *red = ((uint32_t)data[0] << 16 | data[1] << 8 | data[2]) & 0x3FFFF;
-    *ir  = ((uint32_t)data[3] << 16 | data[4] << 8 | data[5]) & 0x3FFFF;
-    return true;        // Amostras não lidas (há dados em standby)
-}
+// O conector JST SH de 4 fios não traz o pino INT: a FIFO é consultada
+static max30102_t sensor;
 
 /*
 --- FUNÇÃO PRINCIPAL ---
 */
 int main(void) {
     stdio_init_all();   // Inicialização geral
-    config_i2c();       // Configuração de I2C
+    max30102_bus_init(I2C_PORT, I2C_SDA, I2C_SCL); // Configuração de I2C
 
-    max30102_init();    // Inicialização do sensor
+    // Inicialização do sensor com a configuração padrão da biblioteca
+    struct max30102_config cfg;
+    max30102_get_default_config(&cfg);
+    bool ok = max30102_init(&sensor, I2C_PORT, -1, &cfg);
     sleep_ms(3000);
-    uint8_t part_id = max30102_read(REG_PART_ID);
-    if (part_id == 0x15) {
+    uint8_t part_id = sensor.part_id;
+    if (ok) {
         printf("MAX30102 pronto (Part ID: 0x%02X)\n", part_id);
     } else {
         printf("Erro: Part ID inesperado (0x%02X). Verifique conexão ou compatibilidade.\n", part_id);
@@ -153,9 +51,9 @@ int main(void) {
     {
         // Leitura de dados
         uint32_t red, ir;
-        if (max30102_read_sample(&red, &ir))
+        if (max30102_read_sample(&sensor, &red, &ir))
             printf("RED: %u\tIR: %u\n", red, ir);
-
-        sleep_ms(10);   // ~100 Hz -> freq. de leitura bate com a taxa de amostragem
+        else
+            sleep_ms(10);   // FIFO vazia: as próximas amostras vêm na mesma rajada
     }
 }
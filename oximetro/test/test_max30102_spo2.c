@@ -0,0 +1,224 @@
+// test_max30102_spo2.c - Testes no host do estimador de SpO2 e BPM.
+//
+// Reproduz traços sintéticos de RED/IR como os que saem da FIFO: DC do
+// tecido, pulso com onda sistólica e dicrótica, ruído e deriva lenta da
+// linha de base. O BPM precisa acompanhar 50 a 170 BPM com erro de cerca
+// de 1% e o SpO2 seguir a razão AC/DC programada.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "max30102_spo2.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// taxa padrão da FIFO: 400 Hz com média de 4
+#define SAMPLE_RATE_HZ  100.0f
+
+static const double pi = 3.14159265358979323846;
+
+static uint32_t rng_state = 0x2545F491;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// ruído uniforme em [-1, 1]
+static double noise(void) {
+    return (double)rng() / 2147483647.5 - 1.0;
+}
+
+// Forma de um batimento, fase em [0, 1): pico sistólico e onda dicrótica menor
+static double pulse(double phase) {
+    double a = (phase - 0.15) / 0.07;
+    double b = (phase - 0.45) / 0.10;
+    return exp(-a * a) + 0.35 * exp(-b * b);
+}
+
+typedef struct {
+    double phase;
+    double t;
+    double ir_dc, ir_ac;
+    double red_dc, red_ac;
+} ppg_t;
+
+// Razão R = (AC_red / DC_red) / (AC_ir / DC_ir) que dá o SpO2 pedido (110 - 25 R)
+static void ppg_init(ppg_t *ppg, double spo2) {
+    double ratio = (110.0 - spo2) / 25.0;
+    ppg->phase = 0.0;
+    ppg->t = 0.0;
+    ppg->ir_dc = 120000.0;
+    ppg->ir_ac = 1500.0;
+    ppg->red_dc = 90000.0;
+    ppg->red_ac = ppg->ir_ac / ppg->ir_dc * ratio * ppg->red_dc;
+}
+
+static void ppg_next(ppg_t *ppg, double bpm, uint32_t *red, uint32_t *ir) {
+    double p = pulse(ppg->phase);
+    double drift = sin(2.0 * pi * 0.05 * ppg->t);   // respiração/movimento lento
+    *ir = (uint32_t)(ppg->ir_dc + 400.0 * drift + ppg->ir_ac * p + 20.0 * noise());
+    *red = (uint32_t)(ppg->red_dc + 300.0 * drift + ppg->red_ac * p + 20.0 * noise());
+
+    ppg->t += 1.0 / SAMPLE_RATE_HZ;
+    ppg->phase += bpm / 60.0 / SAMPLE_RATE_HZ;
+    if (ppg->phase >= 1.0) {
+        ppg->phase -= 1.0;
+    }
+}
+
+// Alimenta seconds de sinal; devolve quantos batimentos foram detectados
+static int feed(max30102_spo2_t *est, ppg_t *ppg, double bpm, double seconds) {
+    int beats = 0;
+    int n = (int)(seconds * SAMPLE_RATE_HZ);
+    for (int i = 0; i < n; i++) {
+        uint32_t red, ir;
+        ppg_next(ppg, bpm, &red, &ir);
+        beats += max30102_spo2_update(est, red, ir);
+    }
+    return beats;
+}
+
+static void test_bpm_range(void) {
+    for (int bpm = 50; bpm <= 170; bpm += 10) {
+        max30102_spo2_t est;
+        ppg_t ppg;
+        max30102_spo2_init(&est, SAMPLE_RATE_HZ);
+        ppg_init(&ppg, 97.0);
+
+        feed(&est, &ppg, bpm, 10.0);
+        int beats = feed(&est, &ppg, bpm, 30.0);
+
+        // um batimento detectado por período, sem falsos picos da onda dicrótica
+        int expected = (int)lround(bpm * 30.0 / 60.0);
+        if (beats < expected - 1 || beats > expected + 1) {
+            printf("%s:%d: falhou: %d BPM: %d batimentos em 30 s, esperado %d\n", __FILE__, __LINE__, bpm, beats, expected);
+            failures++;
+        }
+
+        float measured;
+        CHECK(max30102_spo2_get_bpm(&est, &measured));
+        if (fabsf(measured - (float)bpm) > 0.01f * (float)bpm) {
+            printf("%s:%d: falhou: %d BPM medido como %.2f\n", __FILE__, __LINE__, bpm, measured);
+            failures++;
+        }
+    }
+}
+
+static void test_bpm_change(void) {
+    max30102_spo2_t est;
+    ppg_t ppg;
+    float measured;
+    max30102_spo2_init(&est, SAMPLE_RATE_HZ);
+    ppg_init(&ppg, 97.0);
+
+    feed(&est, &ppg, 60.0, 20.0);
+    CHECK(max30102_spo2_get_bpm(&est, &measured) && fabsf(measured - 60.0f) < 0.6f);
+
+    // a média cobre os últimos MAX30102_SPO2_BEATS intervalos: 8 batimentos depois já é o novo ritmo
+    feed(&est, &ppg, 120.0, 8.0);
+    CHECK(max30102_spo2_get_bpm(&est, &measured) && fabsf(measured - 120.0f) < 1.2f);
+}
+
+// Pulso que enfraquece de repente (dedo mais solto): a detecção volta depois de alguns segundos
+static void test_weak_pulse(void) {
+    max30102_spo2_t est;
+    ppg_t ppg;
+    float measured;
+    max30102_spo2_init(&est, SAMPLE_RATE_HZ);
+    ppg_init(&ppg, 97.0);
+
+    feed(&est, &ppg, 70.0, 15.0);
+    ppg.ir_ac /= 4.0;
+    ppg.red_ac /= 4.0;
+    int beats = feed(&est, &ppg, 70.0, 20.0);
+    CHECK(beats >= 15);
+    CHECK(max30102_spo2_get_bpm(&est, &measured) && fabsf(measured - 70.0f) < 0.7f);
+}
+
+static void test_spo2(void) {
+    static const double levels[] = { 99.0, 97.0, 94.0, 90.0, 85.0 };
+    for (unsigned i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        max30102_spo2_t est;
+        ppg_t ppg;
+        float spo2;
+        max30102_spo2_init(&est, SAMPLE_RATE_HZ);
+        ppg_init(&ppg, levels[i]);
+
+        // antes de a janela encher não há resultado
+        feed(&est, &ppg, 75.0, 1.0);
+        CHECK(!max30102_spo2_get_spo2(&est, &spo2));
+
+        feed(&est, &ppg, 75.0, 20.0);
+        CHECK(max30102_spo2_get_spo2(&est, &spo2));
+        if (fabsf(spo2 - (float)levels[i]) > 1.0f) {
+            printf("%s:%d: falhou: SpO2 %.1f%% medido como %.2f%%\n", __FILE__, __LINE__, levels[i], spo2);
+            failures++;
+        }
+    }
+}
+
+// Sem dedo: só luz ambiente e ruído, DC bem abaixo de MAX30102_SPO2_FINGER_DC
+static void test_no_finger(void) {
+    max30102_spo2_t est;
+    float value;
+    max30102_spo2_init(&est, SAMPLE_RATE_HZ);
+
+    CHECK(!max30102_spo2_finger(&est));
+    CHECK(!max30102_spo2_get_bpm(&est, &value));
+    CHECK(!max30102_spo2_get_spo2(&est, &value));
+
+    for (int i = 0; i < 3000; i++) {
+        uint32_t red = (uint32_t)(800.0 + 200.0 * noise());
+        uint32_t ir = (uint32_t)(1200.0 + 300.0 * noise());
+        max30102_spo2_update(&est, red, ir);
+    }
+    CHECK(!max30102_spo2_finger(&est));
+    CHECK(!max30102_spo2_get_bpm(&est, &value));
+    CHECK(!max30102_spo2_get_spo2(&est, &value));
+}
+
+// Dedo retirado no meio da medição: os resultados somem assim que a janela esvazia do pulso
+static void test_finger_removed(void) {
+    max30102_spo2_t est;
+    ppg_t ppg;
+    float value;
+    max30102_spo2_init(&est, SAMPLE_RATE_HZ);
+    ppg_init(&ppg, 97.0);
+
+    feed(&est, &ppg, 80.0, 20.0);
+    CHECK(max30102_spo2_finger(&est));
+    CHECK(max30102_spo2_get_bpm(&est, &value));
+
+    for (int i = 0; i < MAX30102_SPO2_WINDOW; i++) {
+        max30102_spo2_update(&est, (uint32_t)(800.0 + 200.0 * noise()), (uint32_t)(1200.0 + 300.0 * noise()));
+    }
+    CHECK(!max30102_spo2_finger(&est));
+    CHECK(!max30102_spo2_get_bpm(&est, &value));
+    CHECK(!max30102_spo2_get_spo2(&est, &value));
+}
+
+int main(void) {
+    test_bpm_range();
+    test_bpm_change();
+    test_weak_pulse();
+    test_spo2();
+    test_no_finger();
+    test_finger_removed();
+
+    if (failures) {
+        printf("test_max30102_spo2: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_max30102_spo2: ok\n");
+    return 0;
+}
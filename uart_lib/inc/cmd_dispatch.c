@@ -0,0 +1,103 @@
+// cmd_dispatch.c
+
+#include "cmd_dispatch.h"
+#include <string.h>
+
+// Compara um trecho (não terminado em nulo) com um nome da tabela, como o strcmp
+static int cmd_compare(const char *name, const char *token, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char a = (unsigned char)name[i];
+        unsigned char b = (unsigned char)token[i];
+        if (a != b) {
+            return a - b; // inclui o caso do nome terminar antes (a == '\0')
+        }
+        if (a == '\0') {
+            return -1; // nulo embutido no trecho: o nome acabou e o trecho continua
+        }
+    }
+    return name[len] == '\0' ? 0 : 1;
+}
+
+bool cmd_table_check(const cmd_table_t *table) {
+    for (size_t i = 1; i < table->count; i++) {
+        if (strcmp(table->entries[i - 1].name, table->entries[i].name) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const cmd_entry_t *cmd_find(const cmd_table_t *table, const char *name, size_t len) {
+    size_t lo = 0;
+    size_t hi = table->count;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = cmd_compare(table->entries[mid].name, name, len);
+        if (cmp == 0) {
+            return &table->entries[mid];
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+cmd_result_t cmd_dispatch(const cmd_table_t *table, const char *line, size_t len, void *ctx) {
+    cmd_token_t argv[CMD_MAX_ARGS];
+    int argc = 0;
+    size_t i = 0;
+
+    // Separa as palavras apontando para dentro da própria linha
+    while (i < len) {
+        while (i < len && (line[i] == ' ' || line[i] == '\t')) {
+            i++;
+        }
+        if (i == len) {
+            break;
+        }
+        if (argc == CMD_MAX_ARGS) {
+            return CMD_TOO_MANY_ARGS;
+        }
+        size_t start = i;
+        while (i < len && line[i] != ' ' && line[i] != '\t') {
+            i++;
+        }
+        argv[argc].ptr = &line[start];
+        argv[argc].len = i - start;
+        argc++;
+    }
+
+    if (argc == 0) {
+        return CMD_EMPTY;
+    }
+
+    const cmd_entry_t *entry = cmd_find(table, argv[0].ptr, argv[0].len);
+    if (entry == NULL) {
+        return CMD_UNKNOWN;
+    }
+    entry->handler(argc, argv, ctx);
+    return CMD_OK;
+}
+
+cmd_result_t cmd_dispatch_uart_line(const cmd_table_t *table, const uart_lib_line_t *line, void *ctx) {
+    if (line->truncated) {
+        return CMD_LINE_TOO_LONG;
+    }
+    if (line->part2_len == 0) {
+        return cmd_dispatch(table, line->part1, line->part1_len, ctx);
+    }
+
+    // A linha está dividida no fim do buffer circular: junta as duas partes.
+    // Cortar aqui mudaria o comando ou seus argumentos, então é recusada.
+    char scratch[CMD_LINE_SCRATCH_LEN];
+    if (line->part1_len + line->part2_len > sizeof(scratch)) {
+        return CMD_LINE_TOO_LONG;
+    }
+    memcpy(scratch, line->part1, line->part1_len);
+    memcpy(scratch + line->part1_len, line->part2, line->part2_len);
+    return cmd_dispatch(table, scratch, line->part1_len + line->part2_len, ctx);
+}
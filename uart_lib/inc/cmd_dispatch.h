@@ -0,0 +1,86 @@
+// cmd_dispatch.h - Despachante de comandos por tabela para o console serial.
+//
+// Os comandos ficam em uma tabela constante, ordenada pelo nome; a busca é
+// binária (O(log n) comparações) e compara os bytes da própria linha
+// recebida, sem copiá-la. Os argumentos são separados
+// por espaços e entregues como trechos da linha original, sem cópia.
+// Serve tanto para linhas lidas da USB (stdio) quanto para as do pico_uart.
+
+#ifndef CMD_DISPATCH_H
+#define CMD_DISPATCH_H
+
+#include "uart_lib_line.h"
+
+// Máximo de palavras por linha, incluindo o nome do comando
+#define CMD_MAX_ARGS 8
+
+// Tamanho do buffer usado apenas quando uma linha do pico_uart dá a volta no buffer circular
+#define CMD_LINE_SCRATCH_LEN 128
+
+/**
+ * @brief Um trecho da linha, não terminado em nulo.
+ */
+typedef struct {
+    const char *ptr;
+    size_t len;
+} cmd_token_t;
+
+/**
+ * @brief Função de um comando. argv[0] é o próprio nome do comando.
+ */
+typedef void (*cmd_handler_t)(int argc, const cmd_token_t *argv, void *ctx);
+
+typedef struct {
+    const char *name;
+    cmd_handler_t handler;
+} cmd_entry_t;
+
+/**
+ * @brief Tabela de comandos. As entradas precisam estar em ordem crescente de
+ * nome (ordem do strcmp: maiúsculas antes de minúsculas).
+ */
+typedef struct {
+    const cmd_entry_t *entries;
+    size_t count;
+} cmd_table_t;
+
+#define CMD_TABLE(entries) { (entries), sizeof(entries) / sizeof((entries)[0]) }
+
+typedef enum {
+    CMD_OK = 0,
+    CMD_EMPTY,          // linha sem nenhuma palavra
+    CMD_UNKNOWN,        // comando não está na tabela
+    CMD_TOO_MANY_ARGS,  // mais de CMD_MAX_ARGS palavras
+    CMD_LINE_TOO_LONG,  // linha cortada pelo pico_uart ou maior que CMD_LINE_SCRATCH_LEN
+} cmd_result_t;
+
+/**
+ * @brief Confere se a tabela está ordenada e sem nomes repetidos.
+ * Deve ser chamada uma vez na inicialização.
+ */
+bool cmd_table_check(const cmd_table_t *table);
+
+/**
+ * @brief Procura um comando pelo nome.
+ * @return A entrada, ou NULL se não existe.
+ */
+const cmd_entry_t *cmd_find(const cmd_table_t *table, const char *name, size_t len);
+
+/**
+ * @brief Separa a linha em palavras e chama o comando correspondente.
+ * * @param table A tabela de comandos.
+ * @param line A linha, sem o terminador (não precisa ser terminada em nulo).
+ * @param len O tamanho da linha.
+ * @param ctx Ponteiro repassado ao comando.
+ */
+cmd_result_t cmd_dispatch(const cmd_table_t *table, const char *line, size_t len, void *ctx);
+
+/**
+ * @brief Despacha uma linha obtida com uart_lib_peek_line().
+ * A linha só é copiada no caso raro em que ela dá a volta no buffer circular;
+ * nesse caso ela precisa caber em CMD_LINE_SCRATCH_LEN. Linhas cortadas
+ * (truncated) nunca são despachadas, pois o comando chegou incompleto.
+ */
+cmd_result_t cmd_dispatch_uart_line(const cmd_table_t *table, const uart_lib_line_t *line, void *ctx);
+
+#endif // CMD_DISPATCH_H
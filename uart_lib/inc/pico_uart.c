@@ -1,10 +1,109 @@
 // pico_uart.c
 
 #include "pico_uart.h"
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
 #include <string.h> // Para strlen
 
-void uart_lib_init(uart_inst_t *uart_id, uint baudrate, uint tx_pin, uint rx_pin) {
+#define UART_LIB_RX_MASK (UART_LIB_RX_BUF_LEN - 1)
+#define UART_LIB_TX_MASK (UART_LIB_TX_BUF_LEN - 1)
+
+#define UART_DR_ERROR_BITS (UART_UARTDR_FE_BITS | UART_UARTDR_PE_BITS | UART_UARTDR_BE_BITS)
+
+// Estado de cada UART. Os índices crescem livremente e são mascarados no
+// acesso; head é escrito apenas por quem produz e tail apenas por quem consome.
+typedef struct {
+    char rx_buf[UART_LIB_RX_BUF_LEN];
+    volatile uint32_t rx_head;      // escrito pela interrupção
+    volatile uint32_t rx_tail;      // escrito pelo laço principal
+    volatile uint32_t rx_lines;     // terminadores ainda não consumidos
+
+    uint8_t tx_buf[UART_LIB_TX_BUF_LEN];
+    volatile uint32_t tx_head;      // escrito pelo laço principal
+    volatile uint32_t tx_tail;      // escrito pela interrupção
+
+    uart_lib_stats_t stats;
+
+    // Modo de transmissão contínua: dois blocos, um com o DMA e outro em
+    // preenchimento ou na fila
+    uint8_t block[2][UART_LIB_STREAM_BLOCK_LEN];
+    volatile uint32_t block_len[2];
+    uint8_t fill;               // bloco em preenchimento (ou o próximo a ficar livre)
+    volatile int8_t sending;    // bloco com o DMA, -1 se o DMA está parado
+    volatile int8_t queued;     // bloco cheio esperando o DMA, -1 se nenhum
+    int dma_chan;               // -1 fora do modo contínuo
+    uint64_t stream_start_us;
+    uart_lib_stream_stats_t stream_stats;
+} uart_lib_ctx_t;
+
+static uart_lib_ctx_t ctx[2];
+
+static inline bool is_line_end(char c) {
+    return c == '\r' || c == '\n';
+}
+
+// Move bytes do buffer de transmissão para a FIFO enquanto houver espaço.
+// Retorna true se ainda restam bytes para enviar.
+static bool uart_lib_fill_tx_fifo(uart_inst_t *uart_id, uart_lib_ctx_t *c) {
+    uart_hw_t *hw = uart_get_hw(uart_id);
+    uint32_t tail = c->tx_tail;
+    while (tail != c->tx_head && uart_is_writable(uart_id)) {
+        hw->dr = c->tx_buf[tail & UART_LIB_TX_MASK];
+        tail++;
+        c->stats.tx_bytes++;
+    }
+    c->tx_tail = tail;
+    return tail != c->tx_head;
+}
+
+static void uart_lib_irq_handler(uint idx) {
+    uart_inst_t *uart_id = idx ? uart1 : uart0;
+    uart_hw_t *hw = uart_get_hw(uart_id);
+    uart_lib_ctx_t *c = &ctx[idx];
+
+    // Esvazia a FIFO de recepção; os bits 8 a 11 de DR trazem os erros do byte
+    uint32_t head = c->rx_head;
+    while (uart_is_readable(uart_id)) {
+        uint32_t dr = hw->dr;
+        if (dr & UART_UARTDR_OE_BITS) {
+            c->stats.hw_overruns++;
+        }
+        if (dr & UART_DR_ERROR_BITS) {
+            c->stats.framing_errors++;
+            continue;
+        }
+        if (head - c->rx_tail >= UART_LIB_RX_BUF_LEN) {
+            c->stats.rx_overruns++;
+            continue;
+        }
+        char ch = (char)(dr & 0xFF);
+        c->rx_buf[head & UART_LIB_RX_MASK] = ch;
+        head++;
+        c->stats.rx_bytes++;
+        if (is_line_end(ch)) {
+            c->rx_lines++;
+        }
+    }
+    c->rx_head = head;
+
+    // Alimenta a FIFO de transmissão; sem mais dados, desliga a interrupção de TX
+    if (!uart_lib_fill_tx_fifo(uart_id, c)) {
+        hw_clear_bits(&hw->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+}
+
+static void uart0_lib_irq(void) { uart_lib_irq_handler(0); }
+static void uart1_lib_irq(void) { uart_lib_irq_handler(1); }
+
+static bool dma_irq_ready;
+
+void uart_lib_init(uart_inst_t *uart_id, uint baudrate, uint tx_pin, uint rx_pin, bool hw_flow) {
+    uint idx = uart_get_index(uart_id);
+    uart_lib_ctx_t *c = &ctx[idx];
+
     // Inicializa a UART com o baudrate fornecido
     uart_init(uart_id, baudrate);
 
@@ -12,36 +111,339 @@ void uart_lib_init(uart_inst_t *uart_id, uint baudrate, uint tx_pin, uint rx_pin
     gpio_set_function(tx_pin, GPIO_FUNC_UART);
     gpio_set_function(rx_pin, GPIO_FUNC_UART);
 
-    // Desativa os controles de fluxo (geralmente não são necessários para projetos simples)
-    uart_set_hw_flow(uart_id, false, false);
+    // Controle de fluxo RTS/CTS, nos pinos seguintes a TX/RX
+    if (hw_flow) {
+        gpio_set_function(tx_pin + 2, GPIO_FUNC_UART);
+        gpio_set_function(tx_pin + 3, GPIO_FUNC_UART);
+    }
+    uart_set_hw_flow(uart_id, hw_flow, hw_flow);
+
+    c->dma_chan = -1;
+    c->rx_head = c->rx_tail = 0;
+    c->rx_lines = 0;
+    c->tx_head = c->tx_tail = 0;
+    memset(&c->stats, 0, sizeof(c->stats));
+
+    // Interrupção de RX (FIFO pela metade ou timeout de recepção); a de TX só é
+    // ligada quando há dados esperando no buffer
+    uint irq = idx ? UART1_IRQ : UART0_IRQ;
+    irq_set_exclusive_handler(irq, idx ? uart1_lib_irq : uart0_lib_irq);
+    irq_set_enabled(irq, true);
+    uart_set_irq_enables(uart_id, true, false);
+}
+
+size_t uart_lib_write(uart_inst_t *uart_id, const uint8_t *data, size_t len) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    uint32_t head = c->tx_head;
+    size_t space = UART_LIB_TX_BUF_LEN - (head - c->tx_tail);
+    if (len > space) {
+        len = space;
+    }
+    for (size_t i = 0; i < len; i++) {
+        c->tx_buf[(head + i) & UART_LIB_TX_MASK] = data[i];
+    }
+
+    // Dá a partida na transmissão; o resto é enviado pela interrupção
+    uart_hw_t *hw = uart_get_hw(uart_id);
+    uint32_t save = save_and_disable_interrupts();
+    c->tx_head = head + (uint32_t)len;
+    if (uart_lib_fill_tx_fifo(uart_id, c)) {
+        hw_set_bits(&hw->imsc, UART_UARTIMSC_TXIM_BITS);
+    }
+    restore_interrupts(save);
+
+    return len;
 }
 
 void uart_lib_send_line(uart_inst_t *uart_id, const char *str) {
-    // uart_puts envia a string, mas não a nova linha
-    uart_puts(uart_id, str);
+    // Espera apenas enquanto o buffer de transmissão estiver cheio
+    const uint8_t *data = (const uint8_t *)str;
+    size_t len = strlen(str);
+    while (len > 0) {
+        size_t sent = uart_lib_write(uart_id, data, len);
+        data += sent;
+        len -= sent;
+        if (len > 0) {
+            tight_loop_contents();
+        }
+    }
     // Enviamos a nova linha e o retorno de carro para compatibilidade
-    uart_puts(uart_id, "\r\n");
+    static const uint8_t crlf[] = { '\r', '\n' };
+    size_t sent = 0;
+    while (sent < sizeof(crlf)) {
+        sent += uart_lib_write(uart_id, crlf + sent, sizeof(crlf) - sent);
+    }
+}
+
+size_t uart_lib_read(uart_inst_t *uart_id, uint8_t *data, size_t len) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    uint32_t tail = c->rx_tail;
+    size_t avail = c->rx_head - tail;
+    if (len > avail) {
+        len = avail;
+    }
+
+    uint32_t line_ends = 0;
+    for (size_t i = 0; i < len; i++) {
+        char ch = c->rx_buf[(tail + i) & UART_LIB_RX_MASK];
+        data[i] = (uint8_t)ch;
+        if (is_line_end(ch)) {
+            line_ends++;
+        }
+    }
+
+    // Mantém a contagem de linhas coerente para quem usa as duas interfaces
+    if (line_ends) {
+        uint32_t save = save_and_disable_interrupts();
+        c->rx_lines -= line_ends;
+        restore_interrupts(save);
+    }
+    c->rx_tail = tail + (uint32_t)len;
+    return len;
+}
+
+bool uart_lib_peek_line(uart_inst_t *uart_id, uart_lib_line_t *line) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    uint32_t tail = c->rx_tail;
+    uint32_t head = c->rx_head;
+
+    // Descarta terminadores soltos (linhas vazias e o '\n' de "\r\n")
+    while (tail != head && is_line_end(c->rx_buf[tail & UART_LIB_RX_MASK])) {
+        tail++;
+        uint32_t save = save_and_disable_interrupts();
+        c->rx_lines--;
+        restore_interrupts(save);
+    }
+    c->rx_tail = tail;
+
+    size_t len;
+    bool truncated = false;
+    if (c->rx_lines > 0) {
+        len = 0;
+        while (!is_line_end(c->rx_buf[(tail + len) & UART_LIB_RX_MASK])) {
+            len++;
+        }
+    } else if (head - tail == UART_LIB_RX_BUF_LEN) {
+        // Buffer cheio sem nenhum terminador: entrega o que há, cortado
+        len = UART_LIB_RX_BUF_LEN;
+        truncated = true;
+    } else {
+        return false;
+    }
+
+    size_t start = tail & UART_LIB_RX_MASK;
+    size_t first = UART_LIB_RX_BUF_LEN - start;
+    line->part1 = &c->rx_buf[start];
+    if (len <= first) {
+        line->part1_len = len;
+        line->part2 = NULL;
+        line->part2_len = 0;
+    } else {
+        line->part1_len = first;
+        line->part2 = c->rx_buf;
+        line->part2_len = len - first;
+    }
+    line->truncated = truncated;
+    return true;
+}
+
+void uart_lib_consume_line(uart_inst_t *uart_id, const uart_lib_line_t *line) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    uint32_t tail = c->rx_tail + (uint32_t)(line->part1_len + line->part2_len);
+
+    // Consome também o terminador da linha
+    if (!line->truncated) {
+        tail++;
+        uint32_t save = save_and_disable_interrupts();
+        c->rx_lines--;
+        restore_interrupts(save);
+    }
+    c->rx_tail = tail;
 }
 
 void uart_lib_read_line(uart_inst_t *uart_id, char *buffer, size_t buffer_len) {
-    char c;
-    size_t i = 0;
+    uart_lib_line_t line;
+
+    // Espera até que uma linha completa esteja no buffer de recepção
+    while (!uart_lib_peek_line(uart_id, &line)) {
+        tight_loop_contents();
+    }
+
+    // Copia o que couber no buffer, deixando espaço para o terminador nulo
+    size_t n1 = line.part1_len < buffer_len - 1 ? line.part1_len : buffer_len - 1;
+    memcpy(buffer, line.part1, n1);
+    size_t n2 = line.part2_len < buffer_len - 1 - n1 ? line.part2_len : buffer_len - 1 - n1;
+    if (n2 > 0) {
+        memcpy(buffer + n1, line.part2, n2);
+    }
+
+    // Adiciona o terminador nulo para formar uma string C válida
+    buffer[n1 + n2] = '\0';
+
+    uart_lib_consume_line(uart_id, &line);
+}
+
+void uart_lib_get_stats(uart_inst_t *uart_id, uart_lib_stats_t *stats) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    uint32_t save = save_and_disable_interrupts();
+    *stats = c->stats;
+    restore_interrupts(save);
+}
+
+// Entrega o bloco ao DMA. Chamada com as interrupções desabilitadas ou de
+// dentro da interrupção do DMA.
+static void uart_lib_stream_send(uart_lib_ctx_t *c, int8_t b) {
+    c->sending = b;
+    dma_channel_transfer_from_buffer_now((uint)c->dma_chan, c->block[b], c->block_len[b]);
+}
+
+static void uart_lib_dma_irq_handler(void) {
+    for (uint idx = 0; idx < 2; idx++) {
+        uart_lib_ctx_t *c = &ctx[idx];
+        if (c->dma_chan < 0 || !dma_channel_get_irq0_status((uint)c->dma_chan)) {
+            continue;
+        }
+        dma_channel_acknowledge_irq0((uint)c->dma_chan);
+
+        // Bloco enviado: volta a ficar livre para preenchimento
+        int8_t done = c->sending;
+        c->stream_stats.bytes += c->block_len[done];
+        c->stream_stats.blocks++;
+        c->block_len[done] = 0;
+
+        // Encadeia o bloco que estava na fila; sem ele a linha fica ociosa
+        if (c->queued >= 0) {
+            uart_lib_stream_send(c, c->queued);
+            c->queued = -1;
+        } else {
+            c->sending = -1;
+            c->stream_stats.underruns++;
+        }
+    }
+}
+
+bool uart_lib_stream_start(uart_inst_t *uart_id) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    if (c->dma_chan >= 0) {
+        return true;
+    }
+
+    int chan = dma_claim_unused_channel(false);
+    if (chan < 0) {
+        return false;
+    }
+
+    // Espera o que ainda estava no buffer circular de transmissão
+    while (c->tx_head != c->tx_tail) {
+        tight_loop_contents();
+    }
 
-    // Zera o buffer para começar
-    memset(buffer, 0, buffer_len);
+    dma_channel_config cfg = dma_channel_get_default_config((uint)chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, uart_get_dreq(uart_id, true));
+    dma_channel_configure((uint)chan, &cfg, &uart_get_hw(uart_id)->dr, NULL, 0, false);
 
-    while (i < buffer_len - 1) {
-        // uart_getc é bloqueante, espera por um caractere
-        c = uart_getc(uart_id);
+    c->block_len[0] = c->block_len[1] = 0;
+    c->fill = 0;
+    c->sending = -1;
+    c->queued = -1;
+    memset(&c->stream_stats, 0, sizeof(c->stream_stats));
+    c->stream_start_us = time_us_64();
+    c->dma_chan = chan;
 
-        // Se for retorno de carro ou nova linha, terminamos
-        if (c == '\r' || c == '\n') {
+    // DMA_IRQ_0 pode ser usada por outras bibliotecas, por isso o handler é compartilhado
+    if (!dma_irq_ready) {
+        irq_add_shared_handler(DMA_IRQ_0, uart_lib_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        dma_irq_ready = true;
+    }
+    dma_channel_set_irq0_enabled((uint)chan, true);
+    return true;
+}
+
+// O bloco de preenchimento ainda está com o DMA ou na fila
+static inline bool uart_lib_stream_fill_busy(const uart_lib_ctx_t *c) {
+    return c->sending == (int8_t)c->fill || c->queued == (int8_t)c->fill;
+}
+
+// Entrega o bloco em preenchimento ao DMA (ou à fila) e passa para o outro
+static bool uart_lib_stream_submit(uart_lib_ctx_t *c) {
+    bool ok = true;
+    uint32_t save = save_and_disable_interrupts();
+    if (c->sending < 0) {
+        uart_lib_stream_send(c, (int8_t)c->fill);
+    } else if (c->queued < 0) {
+        c->queued = (int8_t)c->fill;
+    } else {
+        ok = false; // Os dois blocos estão ocupados
+    }
+    if (ok) {
+        c->fill ^= 1;
+    }
+    restore_interrupts(save);
+    return ok;
+}
+
+size_t uart_lib_stream_write(uart_inst_t *uart_id, const uint8_t *data, size_t len) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    size_t done = 0;
+
+    while (done < len) {
+        if (uart_lib_stream_fill_busy(c)) {
+            c->stream_stats.stalls++;
             break;
         }
 
-        buffer[i++] = c;
+        uint32_t used = c->block_len[c->fill];
+        size_t n = len - done;
+        if (n > UART_LIB_STREAM_BLOCK_LEN - used) {
+            n = UART_LIB_STREAM_BLOCK_LEN - used;
+        }
+        memcpy(&c->block[c->fill][used], data + done, n);
+        c->block_len[c->fill] = used + (uint32_t)n;
+        done += n;
+
+        // Bloco cheio vai imediatamente, sem esperar a próxima escrita
+        if (c->block_len[c->fill] == UART_LIB_STREAM_BLOCK_LEN && !uart_lib_stream_submit(c)) {
+            c->stream_stats.stalls++;
+            break;
+        }
     }
+    return done;
+}
 
-    // Adiciona o terminador nulo para formar uma string C válida
-    buffer[i] = '\0';
-}
\ No newline at end of file
+bool uart_lib_stream_flush(uart_inst_t *uart_id) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    if (uart_lib_stream_fill_busy(c) || c->block_len[c->fill] == 0) {
+        return true; // Nada parcialmente preenchido
+    }
+    return uart_lib_stream_submit(c);
+}
+
+void uart_lib_stream_stop(uart_inst_t *uart_id) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    if (c->dma_chan < 0) {
+        return;
+    }
+
+    while (!uart_lib_stream_flush(uart_id) || c->sending >= 0) {
+        tight_loop_contents();
+    }
+    uart_tx_wait_blocking(uart_id);
+
+    dma_channel_set_irq0_enabled((uint)c->dma_chan, false);
+    dma_channel_unclaim((uint)c->dma_chan);
+    c->dma_chan = -1;
+}
+
+void uart_lib_stream_get_stats(uart_inst_t *uart_id, uart_lib_stream_stats_t *stats) {
+    uart_lib_ctx_t *c = &ctx[uart_get_index(uart_id)];
+    uint32_t save = save_and_disable_interrupts();
+    *stats = c->stream_stats;
+    restore_interrupts(save);
+
+    uint64_t elapsed_us = time_us_64() - c->stream_start_us;
+    stats->bytes_per_s = elapsed_us ? (uint32_t)((stats->bytes * 1000000) / elapsed_us) : 0;
+}
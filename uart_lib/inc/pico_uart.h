@@ -4,19 +4,62 @@
 #define PICO_UART_H
 
 #include "hardware/uart.h"
+#include "uart_lib_line.h"
+
+// Tamanho dos buffers circulares de recepção e transmissão (potências de 2)
+#ifndef UART_LIB_RX_BUF_LEN
+#define UART_LIB_RX_BUF_LEN 512
+#endif
+#ifndef UART_LIB_TX_BUF_LEN
+#define UART_LIB_TX_BUF_LEN 512
+#endif
+
+// Tamanho de cada um dos dois blocos do modo de transmissão contínua por DMA
+#ifndef UART_LIB_STREAM_BLOCK_LEN
+#define UART_LIB_STREAM_BLOCK_LEN 1024
+#endif
+
+/**
+ * @brief Contadores de tráfego e de erros de uma UART.
+ */
+typedef struct {
+    uint32_t rx_bytes;
+    uint32_t tx_bytes;
+    uint32_t rx_overruns;       // bytes descartados porque o buffer de recepção estava cheio
+    uint32_t hw_overruns;       // bytes perdidos porque a FIFO do hardware transbordou
+    uint32_t framing_errors;    // erros de quadro, paridade ou break
+} uart_lib_stats_t;
+
+/**
+ * @brief Estatísticas do modo de transmissão contínua.
+ */
+typedef struct {
+    uint64_t bytes;         // bytes entregues à UART pelo DMA
+    uint32_t blocks;        // blocos transmitidos
+    uint32_t underruns;     // vezes em que o DMA terminou sem outro bloco pronto (linha ociosa)
+    uint32_t stalls;        // chamadas de escrita que encontraram os dois blocos ocupados
+    uint32_t bytes_per_s;   // vazão média desde uart_lib_stream_start()
+} uart_lib_stream_stats_t;
 
 /**
  * @brief Inicializa um periférico UART com os pinos e baudrate especificados.
+ * A recepção e a transmissão passam a ser feitas por interrupção, através dos
+ * buffers circulares, de modo que nenhum byte é perdido enquanto o laço
+ * principal está ocupado.
  * * @param uart_id A instância do UART a ser usada (ex: uart0, uart1).
  * @param baudrate A taxa de transmissão em bits por segundo (ex: 9600).
  * @param tx_pin O número do pino GPIO para a transmissão (TX).
  * @param rx_pin O número do pino GPIO para a recepção (RX).
+ * @param hw_flow Ativa o controle de fluxo RTS/CTS por hardware. Os pinos são
+ * os dois seguintes ao grupo de TX/RX: CTS em tx_pin + 2 e RTS em tx_pin + 3
+ * (ex: GP0/GP1 usam GP2/GP3). Recomendado a partir de 921600 bps.
  */
-void uart_lib_init(uart_inst_t *uart_id, uint baudrate, uint tx_pin, uint rx_pin);
+void uart_lib_init(uart_inst_t *uart_id, uint baudrate, uint tx_pin, uint rx_pin, bool hw_flow);
 
 /**
  * @brief Envia uma string de caracteres pela UART.
  * A função adicionará automaticamente os caracteres de nova linha e retorno de carro ('\r\n').
+ * Só espera se o buffer de transmissão estiver cheio.
  * * @param uart_id A instância do UART a ser usada.
  * @param str A string (terminada em nulo) a ser enviada.
  */
@@ -31,4 +74,79 @@ void uart_lib_send_line(uart_inst_t *uart_id, const char *str);
  */
 void uart_lib_read_line(uart_inst_t *uart_id, char *buffer, size_t buffer_len);
 
-#endif // PICO_UART_H
\ No newline at end of file
+/**
+ * @brief Coloca bytes no buffer de transmissão, sem bloquear.
+ * * @param uart_id A instância do UART a ser usada.
+ * @param data Os bytes a serem enviados.
+ * @param len A quantidade de bytes.
+ * @return Quantos bytes couberam no buffer (pode ser menor que len).
+ */
+size_t uart_lib_write(uart_inst_t *uart_id, const uint8_t *data, size_t len);
+
+/**
+ * @brief Retira bytes do buffer de recepção, sem bloquear (para protocolos binários).
+ * * @param uart_id A instância do UART a ser usada.
+ * @param data Onde os bytes serão escritos.
+ * @param len O máximo de bytes a ler.
+ * @return Quantos bytes foram lidos.
+ */
+size_t uart_lib_read(uart_inst_t *uart_id, uint8_t *data, size_t len);
+
+/**
+ * @brief Retorna a próxima linha completa recebida, sem bloquear e sem copiar.
+ * Linhas vazias (como o '\n' de um "\r\n") são descartadas.
+ * * @param uart_id A instância do UART a ser usada.
+ * @param line Onde o trecho da linha, sem o terminador, será escrito.
+ * @return false se ainda não há nenhuma linha completa.
+ */
+bool uart_lib_peek_line(uart_inst_t *uart_id, uart_lib_line_t *line);
+
+/**
+ * @brief Libera no buffer de recepção a linha retornada por uart_lib_peek_line().
+ */
+void uart_lib_consume_line(uart_inst_t *uart_id, const uart_lib_line_t *line);
+
+/**
+ * @brief Copia os contadores de tráfego e de erros da UART.
+ */
+void uart_lib_get_stats(uart_inst_t *uart_id, uart_lib_stats_t *stats);
+
+/**
+ * @brief Entra no modo de transmissão contínua por DMA.
+ * Os dados são acumulados em dois blocos alternados: enquanto o DMA envia um,
+ * o programa preenche o outro, e a interrupção do DMA encadeia o próximo bloco
+ * assim que o anterior termina, mantendo a linha ocupada sem a CPU.
+ * Enquanto o modo estiver ativo, uart_lib_write() e uart_lib_send_line() não
+ * devem ser usadas na mesma UART.
+ * * @param uart_id A instância do UART a ser usada.
+ * @return false se não há canal de DMA livre.
+ */
+bool uart_lib_stream_start(uart_inst_t *uart_id);
+
+/**
+ * @brief Copia bytes para o bloco em preenchimento, sem bloquear.
+ * Blocos cheios são enviados automaticamente.
+ * * @param uart_id A instância do UART a ser usada.
+ * @param data Os bytes a serem enviados.
+ * @param len A quantidade de bytes.
+ * @return Quantos bytes foram aceitos (menos que len se os dois blocos estão ocupados).
+ */
+size_t uart_lib_stream_write(uart_inst_t *uart_id, const uint8_t *data, size_t len);
+
+/**
+ * @brief Envia o bloco parcialmente preenchido, sem esperar ele encher.
+ * @return false se os dois blocos ainda estão ocupados; tente de novo depois.
+ */
+bool uart_lib_stream_flush(uart_inst_t *uart_id);
+
+/**
+ * @brief Espera todos os blocos serem enviados e libera o canal de DMA.
+ */
+void uart_lib_stream_stop(uart_inst_t *uart_id);
+
+/**
+ * @brief Copia as estatísticas do modo de transmissão contínua.
+ */
+void uart_lib_stream_get_stats(uart_inst_t *uart_id, uart_lib_stream_stats_t *stats);
+
+#endif // PICO_UART_H
@@ -0,0 +1,37 @@
+// uart_frame.c
+
+#include "uart_frame.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+void uart_frame_link_init(uart_frame_link_t *link, uart_inst_t *uart_id) {
+    link->uart_id = uart_id;
+    link->tx_seq = 0;
+    uart_frame_decoder_init(&link->rx);
+    memset(&link->stats, 0, sizeof(link->stats));
+}
+
+void uart_frame_send(uart_frame_link_t *link, uart_frame_t *frame) {
+    uint8_t encoded[UART_FRAME_MAX_ENCODED];
+
+    frame->seq = link->tx_seq++;
+    size_t len = uart_frame_encode(frame, encoded);
+
+    // Espera apenas enquanto o buffer de transmissão estiver cheio
+    size_t sent = 0;
+    while (sent < len) {
+        sent += uart_lib_write(link->uart_id, encoded + sent, len - sent);
+    }
+    link->stats.tx_frames++;
+}
+
+bool uart_frame_receive(uart_frame_link_t *link, uart_frame_t *frame) {
+    uint8_t b;
+
+    while (uart_lib_read(link->uart_id, &b, 1)) {
+        if (uart_frame_decode_byte(&link->rx, &link->stats, b, frame)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,41 @@
+// uart_frame.h - Protocolo binário com quadros COBS + CRC-16 sobre o pico_uart.
+//
+// O formato dos quadros e as funções de montagem e codificação estão em
+// uart_frame_codec.h; aqui fica só o enlace sobre a UART.
+
+#ifndef UART_FRAME_H
+#define UART_FRAME_H
+
+#include "pico_uart.h"
+#include "uart_frame_codec.h"
+
+/**
+ * @brief Estado de um enlace: numeração de envio e decodificador de recepção.
+ */
+typedef struct {
+    uart_inst_t *uart_id;
+    uint8_t tx_seq;
+    uart_frame_decoder_t rx;
+    uart_frame_stats_t stats;
+} uart_frame_link_t;
+
+/**
+ * @brief Inicializa um enlace sobre uma UART já inicializada com uart_lib_init().
+ */
+void uart_frame_link_init(uart_frame_link_t *link, uart_inst_t *uart_id);
+
+/**
+ * @brief Numera, codifica e envia um quadro pela UART do enlace.
+ * Só espera se o buffer de transmissão estiver cheio.
+ */
+void uart_frame_send(uart_frame_link_t *link, uart_frame_t *frame);
+
+/**
+ * @brief Processa os bytes recebidos e retorna o próximo quadro válido, sem bloquear.
+ * * @param link O enlace.
+ * @param frame Onde o quadro recebido será escrito.
+ * @return false se ainda não há nenhum quadro completo.
+ */
+bool uart_frame_receive(uart_frame_link_t *link, uart_frame_t *frame);
+
+#endif // UART_FRAME_H
@@ -0,0 +1,129 @@
+// uart_frame_codec.h - Codificação dos quadros COBS + CRC-16 do uart_frame.
+//
+// Formato de cada quadro na linha:
+//
+//   COBS( tipo | seq | dados[0..UART_FRAME_MAX_DATA] | crc16 ) 0x00
+//
+// - tipo: um byte, ver uart_frame_type_t;
+// - seq: contador de 8 bits incrementado a cada quadro enviado, para o
+//   receptor detectar quadros perdidos;
+// - dados: campos em little-endian, na ordem descrita em cada tipo;
+// - crc16: CRC-16/CCITT-FALSE (polinômio 0x1021, valor inicial 0xFFFF) de
+//   tipo, seq e dados, em little-endian.
+//
+// A codificação COBS elimina os bytes 0x00 do quadro, de modo que 0x00 marca
+// sem ambiguidade o fim de cada um; um receptor que perde bytes se
+// ressincroniza no próximo 0x00.
+//
+// Esta parte não depende do SDK do Pico: é compilada também no host, pelo
+// decodificador de Linux (tools/) e pelos testes (test/).
+
+#ifndef UART_FRAME_CODEC_H
+#define UART_FRAME_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Tamanho máximo dos dados de um quadro
+#define UART_FRAME_MAX_DATA 240
+
+// tipo + seq + dados + crc, antes da codificação
+#define UART_FRAME_MAX_RAW (UART_FRAME_MAX_DATA + 4)
+
+// COBS acrescenta no máximo um byte a cada 254, mais o delimitador
+#define UART_FRAME_MAX_ENCODED (UART_FRAME_MAX_RAW + UART_FRAME_MAX_RAW / 254 + 2)
+
+/**
+ * @brief Tipos de registro. Os campos de cada tipo vêm na ordem indicada.
+ */
+typedef enum {
+    UART_FRAME_TEXT = 0x01,         // texto livre, sem terminador
+    UART_FRAME_BMP280 = 0x10,       // i32 temperatura (0,01 °C), i32 pressão (Pa)
+    UART_FRAME_OXIMETRO = 0x11,     // u32 red, u32 ir (amostras brutas do MAX30102)
+    UART_FRAME_DISTANCIA = 0x12,    // u8 status, u32 distância (mm)
+} uart_frame_type_t;
+
+/**
+ * @brief Um quadro decodificado, ou sendo montado para envio.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t len;
+    uint8_t data[UART_FRAME_MAX_DATA];
+} uart_frame_t;
+
+/**
+ * @brief Contadores de um enlace.
+ */
+typedef struct {
+    uint32_t tx_frames;
+    uint32_t rx_frames;
+    uint32_t crc_errors;    // quadros descartados por CRC inválido ou COBS malformado
+    uint32_t oversize;      // quadros descartados por excederem o tamanho máximo
+    uint32_t seq_gaps;      // quadros perdidos, deduzidos pelos números de sequência
+} uart_frame_stats_t;
+
+/**
+ * @brief Decodificador incremental de recepção.
+ */
+typedef struct {
+    uint8_t seq;        // próximo número de sequência esperado
+    bool synced;        // já recebeu algum quadro (seq é válido)
+    bool discard;       // descartando até o próximo delimitador
+    size_t len;
+    uint8_t buf[UART_FRAME_MAX_ENCODED];
+} uart_frame_decoder_t;
+
+/**
+ * @brief Começa a montar um quadro do tipo dado, sem dados.
+ */
+void uart_frame_begin(uart_frame_t *frame, uint8_t type);
+
+/**
+ * @brief Acrescentam um campo ao quadro, em little-endian.
+ * @return false se o campo não cabe no quadro.
+ */
+bool uart_frame_put_u8(uart_frame_t *frame, uint8_t value);
+bool uart_frame_put_u16(uart_frame_t *frame, uint16_t value);
+bool uart_frame_put_u32(uart_frame_t *frame, uint32_t value);
+bool uart_frame_put_bytes(uart_frame_t *frame, const uint8_t *data, size_t len);
+
+/**
+ * @brief Lê um campo de 16 ou 32 bits do quadro, a partir de offset.
+ */
+uint16_t uart_frame_get_u16(const uart_frame_t *frame, size_t offset);
+uint32_t uart_frame_get_u32(const uart_frame_t *frame, size_t offset);
+
+/**
+ * @brief Calcula o CRC-16/CCITT-FALSE de um bloco, continuando de crc.
+ * Comece com crc = 0xFFFF.
+ */
+uint16_t uart_frame_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Codifica um quadro (COBS + CRC), incluindo o delimitador final.
+ * * @param frame O quadro, com type, seq, len e data preenchidos.
+ * @param out Buffer de saída, com pelo menos UART_FRAME_MAX_ENCODED bytes.
+ * @return O número de bytes escritos em out.
+ */
+size_t uart_frame_encode(const uart_frame_t *frame, uint8_t *out);
+
+/**
+ * @brief Prepara o decodificador para um fluxo novo.
+ */
+void uart_frame_decoder_init(uart_frame_decoder_t *dec);
+
+/**
+ * @brief Entrega um byte recebido ao decodificador.
+ * Quadros inválidos são descartados no próximo delimitador e contados em stats.
+ * * @param dec O decodificador.
+ * @param stats Contadores de recepção a atualizar.
+ * @param b O byte recebido.
+ * @param frame Onde o quadro é escrito quando b completa um quadro válido.
+ * @return true se um quadro válido foi completado.
+ */
+bool uart_frame_decode_byte(uart_frame_decoder_t *dec, uart_frame_stats_t *stats, uint8_t b, uart_frame_t *frame);
+
+#endif // UART_FRAME_CODEC_H
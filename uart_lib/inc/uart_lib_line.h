@@ -0,0 +1,24 @@
+// uart_lib_line.h - Linha recebida pelo pico_uart, sem dependência do SDK,
+// para quem só consome as linhas (como o cmd_dispatch).
+
+#ifndef UART_LIB_LINE_H
+#define UART_LIB_LINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Trecho de uma linha dentro do buffer de recepção, sem cópia.
+ * Como o buffer é circular, a linha pode estar dividida em duas partes;
+ * part2_len é 0 quando ela é contígua. Os dados não são terminados em nulo e
+ * continuam válidos até uart_lib_consume_line().
+ */
+typedef struct {
+    const char *part1;
+    size_t part1_len;
+    const char *part2;
+    size_t part2_len;
+    bool truncated;     // a linha encheu o buffer sem terminador e foi cortada
+} uart_lib_line_t;
+
+#endif // UART_LIB_LINE_H
@@ -0,0 +1,77 @@
+// bench_uart_frame.c - Custo de enviar amostras do BMP280 em quadros binários
+// (uart_frame_encode) comparado ao caminho de texto com printf.
+//
+// Mede bytes por amostra na linha e tempo de codificação por amostra no
+// host. O texto usa o formato do exemplo do BMP280; no Cortex-M0+ a
+// formatação de float é por software, então a diferença lá é bem maior.
+
+#include <stdio.h>
+
+#include "bench_timer.h"
+#include "uart_frame_codec.h"
+
+#define SAMPLES 200000
+
+// Amostras plausíveis: 20 a 30 °C, 95 a 105 kPa
+static int32_t sample_temp(uint32_t i) {
+    return 2000 + (int32_t)((i * 37u) % 1000u);
+}
+
+static int32_t sample_press(uint32_t i) {
+    return 95000 + (int32_t)((i * 7919u) % 10000u);
+}
+
+static void report(const char *name, uint64_t bytes, uint64_t ns, uint64_t cycles) {
+    printf("%-22s %6.1f bytes/amostra %8.1f ns/amostra", name, (double)bytes / SAMPLES, (double)ns / SAMPLES);
+    if (cycles) {
+        printf(" %8.0f ciclos/amostra", (double)cycles / SAMPLES);
+    }
+    printf("\n");
+}
+
+int main(void) {
+    uint8_t out[UART_FRAME_MAX_ENCODED];
+    char text[64];
+    uint64_t bytes, t0, c0;
+
+    // Quadro binário: tipo, seq, i32 temperatura, i32 pressão, CRC, COBS
+    bytes = 0;
+    t0 = bench_ns();
+    c0 = bench_cycles();
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        uart_frame_t frame;
+        uart_frame_begin(&frame, UART_FRAME_BMP280);
+        uart_frame_put_u32(&frame, (uint32_t)sample_temp(i));
+        uart_frame_put_u32(&frame, (uint32_t)sample_press(i));
+        frame.seq = (uint8_t)i;
+        size_t n = uart_frame_encode(&frame, out);
+        bytes += n;
+        bench_sink += out[n / 2];
+    }
+    report("uart_frame", bytes, bench_ns() - t0, bench_cycles() - c0);
+
+    // Texto com float, exatamente como o exemplo do BMP280 imprime
+    bytes = 0;
+    t0 = bench_ns();
+    c0 = bench_cycles();
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        int n = snprintf(text, sizeof(text), "Pressão = %.3f kPa\nTemp. = %.2f C\n",
+                         sample_press(i) / 1000.f, sample_temp(i) / 100.f);
+        bytes += (uint64_t)n;
+        bench_sink += (uint8_t)text[n / 2];
+    }
+    report("printf (float)", bytes, bench_ns() - t0, bench_cycles() - c0);
+
+    // Texto só com inteiros, o mínimo que um formato legível custa
+    bytes = 0;
+    t0 = bench_ns();
+    c0 = bench_cycles();
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        int n = snprintf(text, sizeof(text), "%ld,%ld\n", (long)sample_temp(i), (long)sample_press(i));
+        bytes += (uint64_t)n;
+        bench_sink += (uint8_t)text[n / 2];
+    }
+    report("printf (inteiros)", bytes, bench_ns() - t0, bench_cycles() - c0);
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+// hardware/dma.h - Substituto para os testes no host. Nenhum canal está
+// livre, então o modo de transmissão contínua não é exercitado aqui.
+
+#ifndef FAKE_HARDWARE_DMA_H
+#define FAKE_HARDWARE_DMA_H
+
+#include "pico/stdlib.h"
+
+typedef struct { uint32_t ctrl; } dma_channel_config;
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0 };
+
+static inline int dma_claim_unused_channel(bool required) { (void)required; return -1; }
+static inline void dma_channel_unclaim(uint chan) { (void)chan; }
+static inline dma_channel_config dma_channel_get_default_config(uint chan) { (void)chan; dma_channel_config c = { 0 }; return c; }
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size s) { (void)c; (void)s; }
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void)c; (void)dreq; }
+static inline void dma_channel_configure(uint chan, const dma_channel_config *c, volatile void *write_addr,
+                                         const volatile void *read_addr, uint transfer_count, bool trigger) {
+    (void)chan; (void)c; (void)write_addr; (void)read_addr; (void)transfer_count; (void)trigger;
+}
+static inline void dma_channel_transfer_from_buffer_now(uint chan, const volatile void *read_addr, uint32_t transfer_count) {
+    (void)chan; (void)read_addr; (void)transfer_count;
+}
+static inline bool dma_channel_get_irq0_status(uint chan) { (void)chan; return false; }
+static inline void dma_channel_acknowledge_irq0(uint chan) { (void)chan; }
+static inline void dma_channel_set_irq0_enabled(uint chan, bool enabled) { (void)chan; (void)enabled; }
+
+#endif
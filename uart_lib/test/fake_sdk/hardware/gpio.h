@@ -0,0 +1,12 @@
+// hardware/gpio.h - Substituto para os testes no host.
+
+#ifndef FAKE_HARDWARE_GPIO_H
+#define FAKE_HARDWARE_GPIO_H
+
+#include "pico/stdlib.h"
+
+enum gpio_function { GPIO_FUNC_UART = 2 };
+
+static inline void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+
+#endif
@@ -0,0 +1,17 @@
+// hardware/irq.h - Substituto para os testes no host.
+
+#ifndef FAKE_HARDWARE_IRQ_H
+#define FAKE_HARDWARE_IRQ_H
+
+#include "pico/stdlib.h"
+
+typedef void (*irq_handler_t)(void);
+
+enum { UART0_IRQ = 20, UART1_IRQ = 21, DMA_IRQ_0 = 11 };
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif
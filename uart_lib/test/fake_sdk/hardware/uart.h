@@ -0,0 +1,42 @@
+// hardware/uart.h - UART falsa para os testes no host (ver fake_uart.h).
+//
+// O registrador DR não pode interceptar leituras e escritas, então o modelo
+// faz isso nas funções que o driver sempre chama em volta dele:
+// uart_is_readable() carrega em DR o próximo byte da FIFO de recepção e
+// uart_is_writable() recolhe para a FIFO de transmissão o byte escrito em DR.
+
+#ifndef FAKE_HARDWARE_UART_H
+#define FAKE_HARDWARE_UART_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+typedef struct {
+    volatile uint32_t dr;
+    volatile uint32_t imsc;
+} uart_hw_t;
+
+typedef struct uart_inst uart_inst_t;
+
+extern uart_inst_t *const fake_uart_inst[2];
+#define uart0 (fake_uart_inst[0])
+#define uart1 (fake_uart_inst[1])
+
+#define UART_UARTDR_FE_BITS 0x00000100u
+#define UART_UARTDR_PE_BITS 0x00000200u
+#define UART_UARTDR_BE_BITS 0x00000400u
+#define UART_UARTDR_OE_BITS 0x00000800u
+#define UART_UARTIMSC_TXIM_BITS 0x00000020u
+#define UART_UARTIMSC_RXIM_BITS 0x00000010u
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart);
+uint uart_get_index(uart_inst_t *uart);
+uint uart_init(uart_inst_t *uart, uint baudrate);
+void uart_set_hw_flow(uart_inst_t *uart, bool cts, bool rts);
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data);
+bool uart_is_readable(uart_inst_t *uart);
+bool uart_is_writable(uart_inst_t *uart);
+void uart_tx_wait_blocking(uart_inst_t *uart);
+uint uart_get_dreq(uart_inst_t *uart, bool is_tx);
+
+#endif
@@ -0,0 +1,16 @@
+// pico/stdlib.h - Substituto mínimo do SDK do Pico para os testes no host.
+
+#ifndef FAKE_PICO_STDLIB_H
+#define FAKE_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+static inline void tight_loop_contents(void) {}
+
+uint64_t time_us_64(void);
+
+#endif
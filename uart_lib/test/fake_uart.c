@@ -0,0 +1,212 @@
+// fake_uart.c - Modelo de UART do RP2040 para os testes no host.
+
+#include "fake_uart.h"
+#include "hardware/irq.h"
+#include <assert.h>
+#include <string.h>
+
+// valor que nunca é um byte válido, marca DR livre para uma escrita
+#define FAKE_DR_IDLE 0xFFFFFFFFu
+
+#define FAKE_WIRE_LEN 65536
+
+struct uart_inst {
+    uint idx;
+    uart_hw_t hw;
+
+    uint32_t rx_fifo[FAKE_UART_FIFO_DEPTH];
+    size_t rx_head, rx_count;
+    bool rx_lost;       // FIFO transbordou; o próximo byte lido leva OE
+    bool rx_irq;
+
+    uint8_t tx_fifo[FAKE_UART_FIFO_DEPTH];
+    size_t tx_head, tx_count;
+    bool tx_armed;      // DR foi entregue para escrita por uart_is_writable()
+
+    uint8_t wire[FAKE_WIRE_LEN];
+    size_t wire_len;
+};
+
+static struct uart_inst insts[2] = { { .idx = 0 }, { .idx = 1 } };
+uart_inst_t *const fake_uart_inst[2] = { &insts[0], &insts[1] };
+
+static irq_handler_t handlers[32];
+
+static uint64_t now_us;
+
+// Recolhe para a FIFO de transmissão o byte escrito em DR, se houver
+static void fake_uart_take_write(uart_inst_t *u) {
+    if (u->tx_armed && u->hw.dr != FAKE_DR_IDLE) {
+        assert(u->tx_count < FAKE_UART_FIFO_DEPTH);
+        u->tx_fifo[(u->tx_head + u->tx_count) % FAKE_UART_FIFO_DEPTH] = (uint8_t)u->hw.dr;
+        u->tx_count++;
+    }
+    u->tx_armed = false;
+}
+
+void fake_uart_reset(void) {
+    for (uint i = 0; i < 2; i++) {
+        struct uart_inst *u = &insts[i];
+        memset(u, 0, sizeof(*u));
+        u->idx = i;
+        u->hw.dr = FAKE_DR_IDLE;
+    }
+    memset(handlers, 0, sizeof(handlers));
+}
+
+size_t fake_uart_rx_push(uart_inst_t *uart, const uint8_t *data, size_t len, uint32_t flags) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (uart->rx_count == FAKE_UART_FIFO_DEPTH) {
+            uart->rx_lost = true;
+            continue;
+        }
+        uart->rx_fifo[(uart->rx_head + uart->rx_count) % FAKE_UART_FIFO_DEPTH] = data[i] | flags;
+        uart->rx_count++;
+        n++;
+    }
+    return n;
+}
+
+void fake_uart_irq(uart_inst_t *uart) {
+    fake_uart_take_write(uart);
+    bool rx = uart->rx_irq && uart->rx_count > 0;
+    bool tx = (uart->hw.imsc & UART_UARTIMSC_TXIM_BITS) && uart->tx_count < FAKE_UART_FIFO_DEPTH / 2;
+    irq_handler_t handler = handlers[uart->idx ? UART1_IRQ : UART0_IRQ];
+    if ((rx || tx) && handler) {
+        handler();
+        fake_uart_take_write(uart);
+    }
+}
+
+void fake_uart_rx_stream(uart_inst_t *uart, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        size_t n = len < FAKE_UART_FIFO_DEPTH ? len : FAKE_UART_FIFO_DEPTH;
+        fake_uart_rx_push(uart, data, n, 0);
+        fake_uart_irq(uart);
+        data += n;
+        len -= n;
+    }
+}
+
+size_t fake_uart_tx_run(uart_inst_t *uart, size_t max) {
+    size_t sent = 0;
+    fake_uart_take_write(uart);
+    while (sent < max) {
+        if (uart->tx_count == 0) {
+            // FIFO vazia: a interrupção de TX é a única forma de voltar a encher
+            size_t before = uart->tx_count;
+            fake_uart_irq(uart);
+            if (uart->tx_count == before) {
+                break;
+            }
+            continue;
+        }
+        assert(uart->wire_len < FAKE_WIRE_LEN);
+        uart->wire[uart->wire_len++] = uart->tx_fifo[uart->tx_head];
+        uart->tx_head = (uart->tx_head + 1) % FAKE_UART_FIFO_DEPTH;
+        uart->tx_count--;
+        sent++;
+    }
+    return sent;
+}
+
+const uint8_t *fake_uart_tx_data(uart_inst_t *uart, size_t *len) {
+    *len = uart->wire_len;
+    return uart->wire;
+}
+
+void fake_uart_tx_clear(uart_inst_t *uart) {
+    uart->wire_len = 0;
+}
+
+size_t fake_uart_tx_fifo_level(uart_inst_t *uart) {
+    fake_uart_take_write(uart);
+    return uart->tx_count;
+}
+
+// --- SDK ---
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart) {
+    return &uart->hw;
+}
+
+uint uart_get_index(uart_inst_t *uart) {
+    return uart->idx;
+}
+
+uint uart_init(uart_inst_t *uart, uint baudrate) {
+    (void)uart;
+    return baudrate;
+}
+
+void uart_set_hw_flow(uart_inst_t *uart, bool cts, bool rts) {
+    (void)uart;
+    (void)cts;
+    (void)rts;
+}
+
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data) {
+    uart->rx_irq = rx_has_data;
+    if (tx_needs_data) {
+        uart->hw.imsc |= UART_UARTIMSC_TXIM_BITS;
+    } else {
+        uart->hw.imsc &= ~UART_UARTIMSC_TXIM_BITS;
+    }
+}
+
+bool uart_is_readable(uart_inst_t *uart) {
+    fake_uart_take_write(uart);
+    if (uart->rx_count == 0) {
+        return false;
+    }
+    uint32_t dr = uart->rx_fifo[uart->rx_head];
+    uart->rx_head = (uart->rx_head + 1) % FAKE_UART_FIFO_DEPTH;
+    uart->rx_count--;
+    if (uart->rx_lost && uart->rx_count == 0) {
+        dr |= UART_UARTDR_OE_BITS;
+        uart->rx_lost = false;
+    }
+    uart->hw.dr = dr;
+    return true;
+}
+
+bool uart_is_writable(uart_inst_t *uart) {
+    fake_uart_take_write(uart);
+    if (uart->tx_count == FAKE_UART_FIFO_DEPTH) {
+        return false;
+    }
+    uart->hw.dr = FAKE_DR_IDLE;
+    uart->tx_armed = true;
+    return true;
+}
+
+void uart_tx_wait_blocking(uart_inst_t *uart) {
+    while (fake_uart_tx_fifo_level(uart) > 0) {
+        fake_uart_tx_run(uart, FAKE_UART_FIFO_DEPTH);
+    }
+}
+
+uint uart_get_dreq(uart_inst_t *uart, bool is_tx) {
+    return uart->idx * 2 + (is_tx ? 0 : 1);
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    assert(num < 32 && !handlers[num]);
+    handlers[num] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void)order_priority;
+    assert(num < 32);
+    handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    (void)num;
+    (void)enabled;
+}
+
+uint64_t time_us_64(void) {
+    return now_us++;
+}
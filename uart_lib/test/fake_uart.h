@@ -0,0 +1,44 @@
+// fake_uart.h - Modelo de UART do RP2040 para os testes no host.
+//
+// O teste faz o papel do outro lado do fio: injeta bytes na FIFO de
+// recepção, retira os bytes da FIFO de transmissão e dispara a interrupção
+// registrada pela biblioteca, como o hardware faria.
+
+#ifndef FAKE_UART_H
+#define FAKE_UART_H
+
+#include "hardware/uart.h"
+
+// mesma profundidade das FIFOs da PL011
+#define FAKE_UART_FIFO_DEPTH 32
+
+// Zera o modelo das duas UARTs (FIFOs, handlers e o que já foi transmitido).
+void fake_uart_reset(void);
+
+// Coloca bytes na FIFO de recepção, com os bits de erro de DR (FE, PE, BE)
+// em flags. Bytes que não cabem na FIFO se perdem e marcam OE no próximo lido.
+// Retorna quantos couberam.
+size_t fake_uart_rx_push(uart_inst_t *uart, const uint8_t *data, size_t len, uint32_t flags);
+
+// Injeta os bytes em rajadas do tamanho da FIFO, disparando a interrupção
+// após cada rajada, como num fio rodando sem pausas.
+void fake_uart_rx_stream(uart_inst_t *uart, const uint8_t *data, size_t len);
+
+// Dispara a interrupção da UART se ela tem algum motivo (RX com dados ou TX
+// com a interrupção habilitada).
+void fake_uart_irq(uart_inst_t *uart);
+
+// Transmite até max bytes da FIFO de TX para o fio, disparando a interrupção
+// de TX sempre que a FIFO esvazia. Retorna quantos bytes saíram.
+size_t fake_uart_tx_run(uart_inst_t *uart, size_t max);
+
+// Bytes transmitidos até agora (o que saiu pelo fio) e quantos são.
+const uint8_t *fake_uart_tx_data(uart_inst_t *uart, size_t *len);
+
+// Esquece o que já foi transmitido.
+void fake_uart_tx_clear(uart_inst_t *uart);
+
+// Bytes esperando na FIFO de transmissão.
+size_t fake_uart_tx_fifo_level(uart_inst_t *uart);
+
+#endif
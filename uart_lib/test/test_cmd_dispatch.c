@@ -0,0 +1,199 @@
+// test_cmd_dispatch.c - Testes no host do despachante de comandos.
+//
+// Compilado só com inc/cmd_dispatch.c, sem o SDK nem a UART falsa: as
+// linhas do pico_uart são montadas à mão em uart_lib_line_t.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cmd_dispatch.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// O que o último comando recebeu
+typedef struct {
+    const char *name;
+    int calls;
+    int argc;
+    char argv[CMD_MAX_ARGS][CMD_LINE_SCRATCH_LEN + 1];
+} call_log_t;
+
+static void record(const char *name, int argc, const cmd_token_t *argv, void *ctx) {
+    call_log_t *log = ctx;
+    log->name = name;
+    log->calls++;
+    log->argc = argc;
+    for (int i = 0; i < argc; i++) {
+        memcpy(log->argv[i], argv[i].ptr, argv[i].len);
+        log->argv[i][argv[i].len] = '\0';
+    }
+}
+
+static void cmd_off(int argc, const cmd_token_t *argv, void *ctx) { record("/OFF", argc, argv, ctx); }
+static void cmd_on(int argc, const cmd_token_t *argv, void *ctx) { record("/ON", argc, argv, ctx); }
+static void cmd_set(int argc, const cmd_token_t *argv, void *ctx) { record("set", argc, argv, ctx); }
+static void cmd_status(int argc, const cmd_token_t *argv, void *ctx) { record("status", argc, argv, ctx); }
+
+static const cmd_entry_t entries[] = {
+    { "/OFF", cmd_off },
+    { "/ON", cmd_on },
+    { "set", cmd_set },
+    { "status", cmd_status },
+};
+static const cmd_table_t table = CMD_TABLE(entries);
+
+static cmd_result_t run(const char *line, call_log_t *log) {
+    memset(log, 0, sizeof(*log));
+    return cmd_dispatch(&table, line, strlen(line), log);
+}
+
+static void test_table_check(void) {
+    CHECK(cmd_table_check(&table));
+
+    static const cmd_entry_t unsorted[] = { { "b", cmd_on }, { "a", cmd_on } };
+    static const cmd_entry_t repeated[] = { { "a", cmd_on }, { "a", cmd_on } };
+    static const cmd_entry_t lower_first[] = { { "on", cmd_on }, { "ON", cmd_on } };
+    const cmd_table_t t1 = CMD_TABLE(unsorted);
+    const cmd_table_t t2 = CMD_TABLE(repeated);
+    const cmd_table_t t3 = CMD_TABLE(lower_first);
+    const cmd_table_t empty = { NULL, 0 };
+    CHECK(!cmd_table_check(&t1));
+    CHECK(!cmd_table_check(&t2));
+    CHECK(!cmd_table_check(&t3));
+    CHECK(cmd_table_check(&empty));
+    CHECK(cmd_find(&empty, "x", 1) == NULL);
+}
+
+static void test_find(void) {
+    for (size_t i = 0; i < table.count; i++) {
+        const char *name = entries[i].name;
+        CHECK(cmd_find(&table, name, strlen(name)) == &entries[i]);
+    }
+
+    // O trecho não é terminado em nulo: só len bytes contam
+    CHECK(cmd_find(&table, "/ONX", 3) == &entries[1]);
+    CHECK(cmd_find(&table, "/ONX", 4) == NULL);
+    CHECK(cmd_find(&table, "/O", 2) == NULL);
+    CHECK(cmd_find(&table, "stat", 4) == NULL);
+    CHECK(cmd_find(&table, "statusx", 7) == NULL);
+    CHECK(cmd_find(&table, "/on", 3) == NULL);
+    CHECK(cmd_find(&table, "", 0) == NULL);
+
+    // Nulo embutido (o pico_uart entrega binário): a comparação para no fim do
+    // nome. Aqui "on" vem logo depois do nulo de "led", então ler além do nome
+    // acharia "led\0on" igual ao trecho.
+    static const char names[] = "led\0on";
+    static const cmd_entry_t nul_entries[] = { { "a", cmd_on }, { names, cmd_on }, { "z", cmd_on } };
+    const cmd_table_t nul_table = CMD_TABLE(nul_entries);
+    CHECK(cmd_table_check(&nul_table));
+    CHECK(cmd_find(&nul_table, "led", 3) == &nul_entries[1]);
+    CHECK(cmd_find(&nul_table, "led\0on", 6) == NULL);
+    CHECK(cmd_find(&nul_table, "led\0", 4) == NULL);
+    CHECK(cmd_find(&table, "/ON\0", 4) == NULL);
+    CHECK(cmd_find(&table, "set\0status", 10) == NULL);
+
+    call_log_t log;
+    memset(&log, 0, sizeof(log));
+    CHECK(cmd_dispatch(&table, "/ON\0 1", 6, &log) == CMD_UNKNOWN);
+    CHECK(log.calls == 0);
+}
+
+static void test_dispatch(void) {
+    call_log_t log;
+
+    CHECK(run("/ON", &log) == CMD_OK);
+    CHECK(log.calls == 1 && strcmp(log.name, "/ON") == 0 && log.argc == 1);
+    CHECK(strcmp(log.argv[0], "/ON") == 0);
+
+    CHECK(run(" \tset  led\t1 ", &log) == CMD_OK);
+    CHECK(strcmp(log.name, "set") == 0 && log.argc == 3);
+    CHECK(strcmp(log.argv[1], "led") == 0 && strcmp(log.argv[2], "1") == 0);
+
+    CHECK(run("", &log) == CMD_EMPTY);
+    CHECK(run(" \t ", &log) == CMD_EMPTY);
+    CHECK(run("/on", &log) == CMD_UNKNOWN);
+    CHECK(run("nada 1 2", &log) == CMD_UNKNOWN);
+    CHECK(log.calls == 0);
+
+    // CMD_MAX_ARGS palavras passam; uma a mais não chama o comando
+    CHECK(run("set 1 2 3 4 5 6 7", &log) == CMD_OK);
+    CHECK(log.argc == CMD_MAX_ARGS && strcmp(log.argv[7], "7") == 0);
+    CHECK(run("set 1 2 3 4 5 6 7 8", &log) == CMD_TOO_MANY_ARGS);
+    CHECK(log.calls == 0);
+}
+
+// Monta uma linha do pico_uart com a quebra do buffer circular em split
+static uart_lib_line_t make_line(const char *text, size_t split) {
+    uart_lib_line_t line;
+    size_t len = strlen(text);
+    line.part1 = text;
+    line.part1_len = split < len ? split : len;
+    line.part2 = split < len ? text + split : NULL;
+    line.part2_len = split < len ? len - split : 0;
+    line.truncated = false;
+    return line;
+}
+
+static void test_uart_line(void) {
+    call_log_t log;
+    const char *text = "set brilho 75";
+
+    // Contígua e dividida em todos os pontos possíveis dão o mesmo resultado
+    for (size_t split = 1; split <= strlen(text); split++) {
+        uart_lib_line_t line = make_line(text, split);
+        memset(&log, 0, sizeof(log));
+        CHECK(cmd_dispatch_uart_line(&table, &line, &log) == CMD_OK);
+        CHECK(log.argc == 3);
+        CHECK(strcmp(log.argv[1], "brilho") == 0 && strcmp(log.argv[2], "75") == 0);
+    }
+
+    // Dividida e cabendo exatamente no buffer auxiliar
+    char big[CMD_LINE_SCRATCH_LEN + 2];
+    memcpy(big, "status ", 7);
+    memset(big + 7, 'a', CMD_LINE_SCRATCH_LEN - 7);
+    big[CMD_LINE_SCRATCH_LEN] = '\0';
+    uart_lib_line_t line = make_line(big, 50);
+    memset(&log, 0, sizeof(log));
+    CHECK(cmd_dispatch_uart_line(&table, &line, &log) == CMD_OK);
+    CHECK(log.argc == 2 && strlen(log.argv[1]) == CMD_LINE_SCRATCH_LEN - 7);
+
+    // Um byte a mais: recusada em vez de despachar um argumento cortado
+    big[CMD_LINE_SCRATCH_LEN] = 'a';
+    big[CMD_LINE_SCRATCH_LEN + 1] = '\0';
+    line = make_line(big, 50);
+    memset(&log, 0, sizeof(log));
+    CHECK(cmd_dispatch_uart_line(&table, &line, &log) == CMD_LINE_TOO_LONG);
+    CHECK(log.calls == 0);
+
+    // Contígua não usa o buffer auxiliar, então não tem esse limite
+    line = make_line(big, sizeof(big));
+    CHECK(cmd_dispatch_uart_line(&table, &line, &log) == CMD_OK);
+
+    // Linha cortada pelo pico_uart nunca é despachada
+    line = make_line("/OFF", 10);
+    line.truncated = true;
+    memset(&log, 0, sizeof(log));
+    CHECK(cmd_dispatch_uart_line(&table, &line, &log) == CMD_LINE_TOO_LONG);
+    CHECK(log.calls == 0);
+}
+
+int main(void) {
+    test_table_check();
+    test_find();
+    test_dispatch();
+    test_uart_line();
+
+    if (failures) {
+        printf("test_cmd_dispatch: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_cmd_dispatch: ok\n");
+    return 0;
+}
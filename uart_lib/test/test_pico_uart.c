@@ -0,0 +1,285 @@
+// test_pico_uart.c - Testes no host do enquadramento de linhas da pico_uart.
+//
+// Compila o inc/pico_uart.c de verdade sobre a UART falsa (fake_uart.c):
+// os bytes chegam pela FIFO de recepção e são levados ao buffer circular
+// pela própria interrupção da biblioteca.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fake_uart.h"
+#include "pico_uart.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static void setup(void) {
+    fake_uart_reset();
+    uart_lib_init(uart0, 115200, 0, 1, false);
+    uart_lib_init(uart1, 115200, 4, 5, false);
+}
+
+static void rx_str(uart_inst_t *uart, const char *s) {
+    fake_uart_rx_stream(uart, (const uint8_t *)s, strlen(s));
+}
+
+// Junta as duas partes da linha numa string C
+static size_t line_to_str(const uart_lib_line_t *line, char *out) {
+    memcpy(out, line->part1, line->part1_len);
+    if (line->part2_len) {
+        memcpy(out + line->part1_len, line->part2, line->part2_len);
+    }
+    size_t len = line->part1_len + line->part2_len;
+    out[len] = '\0';
+    return len;
+}
+
+// Retira a próxima linha; devolve false se não há nenhuma completa
+static bool next_line(uart_inst_t *uart, char *out, bool *truncated) {
+    uart_lib_line_t line;
+    if (!uart_lib_peek_line(uart, &line)) {
+        return false;
+    }
+    line_to_str(&line, out);
+    if (truncated) {
+        *truncated = line.truncated;
+    }
+    uart_lib_consume_line(uart, &line);
+    return true;
+}
+
+static void test_lines(void) {
+    setup();
+    char buf[UART_LIB_RX_BUF_LEN + 1];
+
+    CHECK(!next_line(uart0, buf, NULL));
+
+    rx_str(uart0, "hello\r\nworld\npar");
+    CHECK(next_line(uart0, buf, NULL) && strcmp(buf, "hello") == 0);
+    CHECK(next_line(uart0, buf, NULL) && strcmp(buf, "world") == 0);
+    CHECK(!next_line(uart0, buf, NULL));    // "par" ainda sem terminador
+
+    rx_str(uart0, "cial\r");
+    CHECK(next_line(uart0, buf, NULL) && strcmp(buf, "parcial") == 0);
+
+    // linhas vazias e "\r\n" sobrando são descartados
+    rx_str(uart0, "\n\r\n\r\n\nabc\r\n");
+    CHECK(next_line(uart0, buf, NULL) && strcmp(buf, "abc") == 0);
+    CHECK(!next_line(uart0, buf, NULL));
+
+    uart_lib_stats_t stats;
+    uart_lib_get_stats(uart0, &stats);
+    CHECK(stats.rx_bytes == 16 + 5 + 11);
+    CHECK(stats.rx_overruns == 0);
+}
+
+// Linha que atravessa o fim do buffer circular chega em duas partes
+static void test_wrap(void) {
+    setup();
+    char buf[UART_LIB_RX_BUF_LEN + 1];
+    char fill[UART_LIB_RX_BUF_LEN];
+
+    for (size_t split = 1; split < 11; split++) {
+        setup();
+        // Avança o buffer até faltarem split bytes para o fim
+        size_t n = UART_LIB_RX_BUF_LEN - split - 1;
+        memset(fill, 'x', n);
+        fill[n] = '\n';
+        fake_uart_rx_stream(uart0, (const uint8_t *)fill, n + 1);
+        CHECK(next_line(uart0, buf, NULL) && strlen(buf) == n);
+
+        rx_str(uart0, "abcdefghijk\n");
+        uart_lib_line_t line;
+        CHECK(uart_lib_peek_line(uart0, &line));
+        CHECK(line.part1_len == split);
+        CHECK(line.part2_len == 11 - split);
+        CHECK(line.part2 != NULL);
+        line_to_str(&line, buf);
+        CHECK(strcmp(buf, "abcdefghijk") == 0);
+        uart_lib_consume_line(uart0, &line);
+        CHECK(!next_line(uart0, buf, NULL));
+    }
+
+    // Terminador exatamente no último byte: a próxima linha começa no início
+    setup();
+    memset(fill, 'y', UART_LIB_RX_BUF_LEN - 1);
+    fill[UART_LIB_RX_BUF_LEN - 1] = '\n';
+    fake_uart_rx_stream(uart0, (const uint8_t *)fill, UART_LIB_RX_BUF_LEN);
+    CHECK(next_line(uart0, buf, NULL) && strlen(buf) == UART_LIB_RX_BUF_LEN - 1);
+    rx_str(uart0, "ok\n");
+    uart_lib_line_t line;
+    CHECK(uart_lib_peek_line(uart0, &line));
+    CHECK(line.part2_len == 0 && line.part1_len == 2);
+}
+
+// Buffer cheio sem terminador: a linha sai cortada e o excesso é contado
+static void test_truncated(void) {
+    setup();
+    char buf[UART_LIB_RX_BUF_LEN + 1];
+    char big[UART_LIB_RX_BUF_LEN + 8];
+
+    for (size_t i = 0; i < sizeof(big); i++) {
+        big[i] = (char)('a' + i % 26);
+    }
+    fake_uart_rx_stream(uart0, (const uint8_t *)big, sizeof(big));
+
+    uart_lib_stats_t stats;
+    uart_lib_get_stats(uart0, &stats);
+    CHECK(stats.rx_bytes == UART_LIB_RX_BUF_LEN);
+    CHECK(stats.rx_overruns == 8);
+
+    bool truncated = false;
+    CHECK(next_line(uart0, buf, &truncated));
+    CHECK(truncated);
+    CHECK(strlen(buf) == UART_LIB_RX_BUF_LEN);
+    CHECK(memcmp(buf, big, UART_LIB_RX_BUF_LEN) == 0);
+
+    // Depois do corte o buffer volta a aceitar linhas normalmente
+    rx_str(uart0, "resto\n");
+    CHECK(next_line(uart0, buf, &truncated) && strcmp(buf, "resto") == 0);
+    CHECK(!truncated);
+    CHECK(!next_line(uart0, buf, NULL));
+}
+
+static void test_read_line(void) {
+    setup();
+    char small[5];
+    char buf[32];
+
+    rx_str(uart0, "0123456789\r\nseguinte\r\n");
+    uart_lib_read_line(uart0, small, sizeof(small));
+    CHECK(strcmp(small, "0123") == 0);
+
+    // O resto da linha cortada foi consumido junto
+    uart_lib_read_line(uart0, buf, sizeof(buf));
+    CHECK(strcmp(buf, "seguinte") == 0);
+    CHECK(!next_line(uart0, buf, NULL));
+}
+
+// uart_lib_read() e as funções de linha sobre o mesmo buffer
+static void test_binary_read(void) {
+    setup();
+    char buf[32];
+    uint8_t raw[8];
+
+    rx_str(uart0, "ab\ncd\nef\n");
+    CHECK(uart_lib_read(uart0, raw, 4) == 4);
+    CHECK(memcmp(raw, "ab\nc", 4) == 0);
+    CHECK(next_line(uart0, buf, NULL) && strcmp(buf, "d") == 0);
+
+    // Ler o terminador pela interface binária não deixa linha fantasma
+    CHECK(uart_lib_read(uart0, raw, sizeof(raw)) == 3);
+    CHECK(!next_line(uart0, buf, NULL));
+    rx_str(uart0, "gh");
+    CHECK(!next_line(uart0, buf, NULL));
+    CHECK(uart_lib_read(uart0, raw, sizeof(raw)) == 2);
+    CHECK(uart_lib_read(uart0, raw, sizeof(raw)) == 0);
+}
+
+static void test_rx_errors(void) {
+    setup();
+    char buf[32];
+
+    // Bytes com erro de quadro/paridade/break são descartados e contados
+    fake_uart_rx_push(uart0, (const uint8_t *)"ok", 2, 0);
+    fake_uart_rx_push(uart0, (const uint8_t *)"?", 1, UART_UARTDR_FE_BITS);
+    fake_uart_rx_push(uart0, (const uint8_t *)"!", 1, UART_UARTDR_PE_BITS);
+    fake_uart_rx_push(uart0, (const uint8_t *)"\0", 1, UART_UARTDR_BE_BITS);
+    fake_uart_rx_push(uart0, (const uint8_t *)"\n", 1, 0);
+    fake_uart_irq(uart0);
+    CHECK(next_line(uart0, buf, NULL) && strcmp(buf, "ok") == 0);
+
+    // FIFO do hardware transbordou antes da interrupção
+    uint8_t burst[FAKE_UART_FIFO_DEPTH + 4];
+    memset(burst, 'z', sizeof(burst));
+    CHECK(fake_uart_rx_push(uart0, burst, sizeof(burst), 0) == FAKE_UART_FIFO_DEPTH);
+    fake_uart_irq(uart0);
+
+    uart_lib_stats_t stats;
+    uart_lib_get_stats(uart0, &stats);
+    CHECK(stats.framing_errors == 3);
+    CHECK(stats.hw_overruns == 1);
+    CHECK(stats.rx_bytes == 3 + FAKE_UART_FIFO_DEPTH);
+}
+
+static void test_tx(void) {
+    setup();
+    size_t len;
+
+    uart_lib_send_line(uart0, "hello");
+    fake_uart_tx_run(uart0, 1000);
+    const uint8_t *wire = fake_uart_tx_data(uart0, &len);
+    CHECK(len == 7 && memcmp(wire, "hello\r\n", 7) == 0);
+    CHECK((uart_get_hw(uart0)->imsc & UART_UARTIMSC_TXIM_BITS) == 0);
+
+    // Mais do que cabe no buffer: aceita só o espaço livre, e a interrupção
+    // de TX entrega tudo na ordem
+    fake_uart_tx_clear(uart0);
+    uint8_t data[UART_LIB_TX_BUF_LEN + 100];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7);
+    }
+    size_t accepted = uart_lib_write(uart0, data, sizeof(data));
+    CHECK(accepted == UART_LIB_TX_BUF_LEN);
+    CHECK(fake_uart_tx_fifo_level(uart0) == FAKE_UART_FIFO_DEPTH);
+    CHECK(uart_get_hw(uart0)->imsc & UART_UARTIMSC_TXIM_BITS);
+
+    // Espaço liberado no meio da transmissão é reaproveitado
+    fake_uart_tx_run(uart0, 200);
+    accepted += uart_lib_write(uart0, data + accepted, sizeof(data) - accepted);
+    CHECK(accepted == sizeof(data));
+    fake_uart_tx_run(uart0, 10000);
+
+    wire = fake_uart_tx_data(uart0, &len);
+    CHECK(len == sizeof(data) && memcmp(wire, data, sizeof(data)) == 0);
+    CHECK((uart_get_hw(uart0)->imsc & UART_UARTIMSC_TXIM_BITS) == 0);
+
+    uart_lib_stats_t stats;
+    uart_lib_get_stats(uart0, &stats);
+    CHECK(stats.tx_bytes == 7 + sizeof(data));
+}
+
+// As duas UARTs têm buffers independentes
+static void test_two_uarts(void) {
+    setup();
+    char buf[32];
+
+    rx_str(uart1, "um\n");
+    rx_str(uart0, "zero\n");
+    CHECK(next_line(uart1, buf, NULL) && strcmp(buf, "um") == 0);
+    CHECK(!next_line(uart1, buf, NULL));
+    CHECK(next_line(uart0, buf, NULL) && strcmp(buf, "zero") == 0);
+
+    size_t len;
+    uart_lib_send_line(uart1, "x");
+    fake_uart_tx_run(uart0, 100);
+    fake_uart_tx_data(uart0, &len);
+    CHECK(len == 0);
+    fake_uart_tx_run(uart1, 100);
+    fake_uart_tx_data(uart1, &len);
+    CHECK(len == 3);
+}
+
+int main(void) {
+    test_lines();
+    test_wrap();
+    test_truncated();
+    test_read_line();
+    test_binary_read();
+    test_rx_errors();
+    test_tx();
+    test_two_uarts();
+
+    if (failures) {
+        printf("test_pico_uart: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_pico_uart: ok\n");
+    return 0;
+}
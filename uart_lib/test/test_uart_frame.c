@@ -0,0 +1,289 @@
+// test_uart_frame.c - Testes no host do protocolo de quadros COBS + CRC-16.
+//
+// A codificação é testada direto em uart_frame_codec.c; o enlace completo
+// (uart_frame_send -> fio -> uart_frame_receive) roda sobre a UART falsa.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fake_uart.h"
+#include "uart_frame.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static uint32_t rng = 0x12345678;
+
+static uint32_t next_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Entrega um fluxo ao decodificador; devolve quantos quadros válidos saíram
+static size_t feed(uart_frame_decoder_t *dec, uart_frame_stats_t *stats, const uint8_t *data, size_t len,
+                   uart_frame_t *frames, size_t max_frames) {
+    size_t n = 0;
+    uart_frame_t frame;
+    for (size_t i = 0; i < len; i++) {
+        if (uart_frame_decode_byte(dec, stats, data[i], &frame)) {
+            if (n < max_frames) {
+                frames[n] = frame;
+            }
+            n++;
+        }
+    }
+    return n;
+}
+
+static bool same_frame(const uart_frame_t *a, const uart_frame_t *b) {
+    return a->type == b->type && a->seq == b->seq && a->len == b->len && memcmp(a->data, b->data, a->len) == 0;
+}
+
+static void test_crc(void) {
+    // Valor de verificação do CRC-16/CCITT-FALSE
+    CHECK(uart_frame_crc16(0xFFFF, (const uint8_t *)"123456789", 9) == 0x29B1);
+
+    // Pode ser calculado em partes
+    uint16_t crc = uart_frame_crc16(0xFFFF, (const uint8_t *)"1234", 4);
+    CHECK(uart_frame_crc16(crc, (const uint8_t *)"56789", 5) == 0x29B1);
+}
+
+// Quadro de referência, calculado fora do projeto
+static void test_golden(void) {
+    static const uint8_t expected[] = {
+        0x05, 0x10, 0x05, 0xCC, 0x09, 0x01, 0x04, 0x30, 0x89, 0x01, 0x03, 0x5A, 0x89, 0x00,
+    };
+    uart_frame_t frame;
+    uint8_t out[UART_FRAME_MAX_ENCODED];
+
+    uart_frame_begin(&frame, UART_FRAME_BMP280);
+    CHECK(uart_frame_put_u32(&frame, 2508));
+    CHECK(uart_frame_put_u32(&frame, 100656));
+    frame.seq = 5;
+
+    size_t len = uart_frame_encode(&frame, out);
+    CHECK(len == sizeof(expected));
+    CHECK(memcmp(out, expected, sizeof(expected)) == 0);
+
+    uart_frame_decoder_t dec;
+    uart_frame_stats_t stats = { 0 };
+    uart_frame_t got;
+    uart_frame_decoder_init(&dec);
+    CHECK(feed(&dec, &stats, out, len, &got, 1) == 1);
+    CHECK(got.type == UART_FRAME_BMP280 && got.seq == 5 && got.len == 8);
+    CHECK((int32_t)uart_frame_get_u32(&got, 0) == 2508);
+    CHECK((int32_t)uart_frame_get_u32(&got, 4) == 100656);
+}
+
+static void test_put_get(void) {
+    uart_frame_t frame;
+    uart_frame_begin(&frame, UART_FRAME_TEXT);
+    CHECK(uart_frame_put_u8(&frame, 0xAB));
+    CHECK(uart_frame_put_u16(&frame, 0x1234));
+    CHECK(uart_frame_put_u32(&frame, 0xDEADBEEF));
+    CHECK(frame.len == 7);
+    CHECK(frame.data[0] == 0xAB && frame.data[1] == 0x34 && frame.data[2] == 0x12);
+    CHECK(uart_frame_get_u16(&frame, 1) == 0x1234);
+    CHECK(uart_frame_get_u32(&frame, 3) == 0xDEADBEEF);
+
+    // Campo que não cabe é recusado sem mudar o quadro
+    uint8_t big[UART_FRAME_MAX_DATA];
+    memset(big, 1, sizeof(big));
+    CHECK(!uart_frame_put_bytes(&frame, big, UART_FRAME_MAX_DATA - 6));
+    CHECK(frame.len == 7);
+    CHECK(uart_frame_put_bytes(&frame, big, UART_FRAME_MAX_DATA - 7));
+    CHECK(frame.len == UART_FRAME_MAX_DATA);
+    CHECK(!uart_frame_put_u8(&frame, 0));
+}
+
+// Todos os tamanhos, com dados aleatórios, só zeros e sem nenhum zero
+static void test_round_trip(void) {
+    uart_frame_decoder_t dec;
+    uart_frame_stats_t stats = { 0 };
+    uart_frame_t frame, got;
+    uint8_t out[UART_FRAME_MAX_ENCODED];
+    uart_frame_decoder_init(&dec);
+
+    uint8_t seq = 0;
+    for (int pattern = 0; pattern < 3; pattern++) {
+        for (size_t len = 0; len <= UART_FRAME_MAX_DATA; len++) {
+            uart_frame_begin(&frame, (uint8_t)(pattern == 1 ? 0 : 0x80 | len));
+            for (size_t i = 0; i < len; i++) {
+                uint8_t b = pattern == 0 ? (uint8_t)next_rand() : pattern == 1 ? 0 : (uint8_t)(1 + i % 255);
+                uart_frame_put_u8(&frame, b);
+            }
+            frame.seq = seq++;
+
+            size_t n = uart_frame_encode(&frame, out);
+            CHECK(n <= UART_FRAME_MAX_ENCODED);
+            CHECK(out[n - 1] == 0x00);
+            CHECK(memchr(out, 0x00, n - 1) == NULL);
+
+            CHECK(feed(&dec, &stats, out, n, &got, 1) == 1);
+            CHECK(same_frame(&frame, &got));
+        }
+    }
+    CHECK(stats.rx_frames == 3 * (UART_FRAME_MAX_DATA + 1));
+    CHECK(stats.crc_errors == 0 && stats.oversize == 0 && stats.seq_gaps == 0);
+}
+
+// Bytes corrompidos ou perdidos descartam só o quadro afetado
+static void test_corruption(void) {
+    uart_frame_t frames[4], got[4];
+    uint8_t stream[4 * UART_FRAME_MAX_ENCODED];
+    size_t len = 0, ends[4];
+
+    for (int i = 0; i < 4; i++) {
+        uart_frame_begin(&frames[i], UART_FRAME_OXIMETRO);
+        uart_frame_put_u32(&frames[i], next_rand());
+        uart_frame_put_u32(&frames[i], next_rand());
+        frames[i].seq = (uint8_t)i;
+        len += uart_frame_encode(&frames[i], stream + len);
+        ends[i] = len;
+    }
+
+    for (size_t pos = 0; pos < ends[0] - 1; pos++) {
+        for (int bit = 0; bit < 8; bit++) {
+            uint8_t copy[sizeof(stream)];
+            memcpy(copy, stream, len);
+            copy[pos] ^= (uint8_t)(1u << bit);
+
+            uart_frame_decoder_t dec;
+            uart_frame_stats_t stats = { 0 };
+            uart_frame_decoder_init(&dec);
+            size_t n = feed(&dec, &stats, copy, len, got, 4);
+            CHECK(n == 3);
+            if (copy[pos] == 0x00 && pos > 0) {
+                // Virou delimitador: o quadro se parte em dois, ambos inválidos
+                CHECK(stats.crc_errors == 2);
+            } else {
+                CHECK(stats.crc_errors == 1);
+            }
+            CHECK(same_frame(&got[0], &frames[1]));
+            CHECK(stats.seq_gaps == 0);
+        }
+    }
+
+    // Receptor que liga no meio de um quadro se ressincroniza no próximo 0x00
+    uart_frame_decoder_t dec;
+    uart_frame_stats_t stats = { 0 };
+    uart_frame_decoder_init(&dec);
+    CHECK(feed(&dec, &stats, stream + 3, len - 3, got, 4) == 3);
+    CHECK(same_frame(&got[0], &frames[1]));
+
+    // Quadro inteiro perdido: contado pelo número de sequência
+    memset(&stats, 0, sizeof(stats));
+    uart_frame_decoder_init(&dec);
+    CHECK(feed(&dec, &stats, stream, ends[0], got, 4) == 1);
+    CHECK(feed(&dec, &stats, stream + ends[2], len - ends[2], got, 4) == 1);
+    CHECK(stats.seq_gaps == 2);
+
+    // Delimitadores repetidos não geram quadros nem erros
+    static const uint8_t zeros[4] = { 0 };
+    memset(&stats, 0, sizeof(stats));
+    CHECK(feed(&dec, &stats, zeros, sizeof(zeros), got, 4) == 0);
+    CHECK(stats.crc_errors == 0 && stats.oversize == 0);
+}
+
+static void test_seq_wrap(void) {
+    uart_frame_decoder_t dec;
+    uart_frame_stats_t stats = { 0 };
+    uart_frame_t frame, got;
+    uint8_t out[UART_FRAME_MAX_ENCODED];
+    uart_frame_decoder_init(&dec);
+
+    static const uint8_t seqs[] = { 253, 254, 255, 0, 1, 4 };
+    for (size_t i = 0; i < sizeof(seqs); i++) {
+        uart_frame_begin(&frame, UART_FRAME_TEXT);
+        uart_frame_put_u8(&frame, 'x');
+        frame.seq = seqs[i];
+        CHECK(feed(&dec, &stats, out, uart_frame_encode(&frame, out), &got, 1) == 1);
+    }
+    CHECK(stats.seq_gaps == 2);     // 2 e 3
+}
+
+static void test_oversize(void) {
+    uart_frame_decoder_t dec;
+    uart_frame_stats_t stats = { 0 };
+    uart_frame_t frame, got;
+    uint8_t junk[UART_FRAME_MAX_ENCODED + 50];
+    uint8_t out[UART_FRAME_MAX_ENCODED];
+    uart_frame_decoder_init(&dec);
+
+    memset(junk, 0x55, sizeof(junk));
+    CHECK(feed(&dec, &stats, junk, sizeof(junk), &got, 1) == 0);
+    CHECK(stats.oversize == 1);
+
+    // O quadro depois do próximo delimitador chega inteiro
+    uart_frame_begin(&frame, UART_FRAME_DISTANCIA);
+    uart_frame_put_u8(&frame, 0);
+    uart_frame_put_u32(&frame, 1234);
+    size_t n = uart_frame_encode(&frame, out);
+    CHECK(feed(&dec, &stats, (const uint8_t *)"", 1, &got, 1) == 0);
+    CHECK(feed(&dec, &stats, out, n, &got, 1) == 1);
+    CHECK(same_frame(&frame, &got));
+    CHECK(stats.oversize == 1 && stats.crc_errors == 0);
+}
+
+// Enlace completo entre as duas UARTs falsas
+static void test_link(void) {
+    fake_uart_reset();
+    uart_lib_init(uart0, 921600, 0, 1, false);
+    uart_lib_init(uart1, 921600, 4, 5, false);
+
+    uart_frame_link_t tx, rx;
+    uart_frame_link_init(&tx, uart0);
+    uart_frame_link_init(&rx, uart1);
+
+    uart_frame_t frame, got;
+    int received = 0;
+    for (int i = 0; i < 300; i++) {
+        uart_frame_begin(&frame, UART_FRAME_BMP280);
+        uart_frame_put_u32(&frame, (uint32_t)(2500 + i));
+        uart_frame_put_u32(&frame, (uint32_t)(100000 + i * 3));
+        uart_frame_send(&tx, &frame);
+
+        // Leva o que saiu pelo fio para a outra UART
+        size_t len;
+        fake_uart_tx_run(uart0, 1000);
+        const uint8_t *wire = fake_uart_tx_data(uart0, &len);
+        fake_uart_rx_stream(uart1, wire, len);
+        fake_uart_tx_clear(uart0);
+
+        while (uart_frame_receive(&rx, &got)) {
+            CHECK(got.seq == (uint8_t)received);
+            CHECK(uart_frame_get_u32(&got, 0) == (uint32_t)(2500 + received));
+            received++;
+        }
+    }
+    CHECK(received == 300);
+    CHECK(tx.stats.tx_frames == 300);
+    CHECK(rx.stats.rx_frames == 300);
+    CHECK(rx.stats.seq_gaps == 0 && rx.stats.crc_errors == 0);
+}
+
+int main(void) {
+    test_crc();
+    test_golden();
+    test_put_get();
+    test_round_trip();
+    test_corruption();
+    test_seq_wrap();
+    test_oversize();
+    test_link();
+
+    if (failures) {
+        printf("test_uart_frame: %d falha(s)\n", failures);
+        return 1;
+    }
+    printf("test_uart_frame: ok\n");
+    return 0;
+}
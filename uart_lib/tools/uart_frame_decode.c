@@ -0,0 +1,168 @@
+// uart_frame_decode.c - Decodificador de Linux dos quadros do uart_frame.
+//
+// Lê o fluxo binário de uma porta serial (ou da entrada padrão) e imprime um
+// registro por linha:
+//
+//   uart_frame_decode /dev/ttyACM0 921600
+//   uart_frame_decode < captura.bin
+//
+// Ao terminar (fim do arquivo ou Ctrl+C), imprime os contadores do enlace
+// na saída de erro.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "uart_frame_codec.h"
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static speed_t baud_to_speed(long baud) {
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    case 3000000: return B3000000;
+    default: return 0;
+    }
+}
+
+// Abre a porta em modo bruto: 8N1, sem eco e sem tradução de bytes
+static int open_serial(const char *path, long baud) {
+    speed_t speed = baud_to_speed(baud);
+    if (!speed) {
+        fprintf(stderr, "Baudrate nao suportado: %ld\n", baud);
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "Erro ao abrir %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0) {
+        fprintf(stderr, "%s nao e uma porta serial: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        fprintf(stderr, "Erro ao configurar %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIFLUSH);
+    return fd;
+}
+
+static void print_frame(const uart_frame_t *f) {
+    printf("#%03u ", f->seq);
+    switch (f->type) {
+    case UART_FRAME_TEXT:
+        printf("texto \"%.*s\"\n", f->len, (const char *)f->data);
+        return;
+    case UART_FRAME_BMP280:
+        if (f->len == 8) {
+            int32_t t = (int32_t)uart_frame_get_u32(f, 0);
+            int32_t p = (int32_t)uart_frame_get_u32(f, 4);
+            printf("bmp280 temperatura=%.2f C pressao=%.3f kPa\n", t / 100.0, p / 1000.0);
+            return;
+        }
+        break;
+    case UART_FRAME_OXIMETRO:
+        if (f->len == 8) {
+            printf("oximetro red=%u ir=%u\n", uart_frame_get_u32(f, 0), uart_frame_get_u32(f, 4));
+            return;
+        }
+        break;
+    case UART_FRAME_DISTANCIA:
+        if (f->len == 5) {
+            printf("distancia status=%u %u mm\n", f->data[0], uart_frame_get_u32(f, 1));
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+
+    // Tipo desconhecido ou tamanho inesperado: mostra os bytes
+    printf("tipo 0x%02X len=%u:", f->type, f->len);
+    for (unsigned i = 0; i < f->len; i++) {
+        printf(" %02X", f->data[i]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int fd = STDIN_FILENO;
+
+    if (argc > 1) {
+        long baud = argc > 2 ? strtol(argv[2], NULL, 10) : 115200;
+        fd = open_serial(argv[1], baud);
+        if (fd < 0) {
+            return 1;
+        }
+    }
+
+    struct sigaction sa = { 0 };
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    uart_frame_decoder_t dec;
+    uart_frame_stats_t stats = { 0 };
+    uart_frame_t frame;
+    uart_frame_decoder_init(&dec);
+
+    uint8_t buf[4096];
+    while (!stop) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Erro de leitura: %s\n", strerror(errno));
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (uart_frame_decode_byte(&dec, &stats, buf[i], &frame)) {
+                print_frame(&frame);
+            }
+        }
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "quadros: %u, erros de CRC: %u, grandes demais: %u, perdidos (seq): %u\n",
+            stats.rx_frames, stats.crc_errors, stats.oversize, stats.seq_gaps);
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return 0;
+}
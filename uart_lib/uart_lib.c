@@ -4,6 +4,7 @@
 #include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
+#include "cmd_dispatch.h"
 
 // Define o pino do LED para facilitar a modificação
 #define LED_PIN 11
@@ -16,12 +17,10 @@
  * A função é bloqueante e aguarda até que o usuário pressione Enter.
  * @param buffer O ponteiro para o buffer onde a string será armazenada.
  * @param buffer_len O tamanho do buffer.
+ * @return O tamanho da linha lida, sem o terminador.
  */
-void read_serial_line(char *buffer, size_t buffer_len) {
-    int char_index = 0;
-    
-    // Limpa o buffer antes de usar
-    memset(buffer, 0, buffer_len);
+size_t read_serial_line(char *buffer, size_t buffer_len) {
+    size_t char_index = 0;
 
     while (char_index < buffer_len - 1) {
         // getchar() aguarda até que um caractere seja recebido via USB
@@ -37,8 +36,38 @@ void read_serial_line(char *buffer, size_t buffer_len) {
     }
     // Adiciona o terminador nulo para criar uma string C válida
     buffer[char_index] = '\0';
+    return char_index;
 }
 
+// --- Comandos ---
+
+static void cmd_on(int argc, const cmd_token_t *argv, void *ctx) {
+    (void)argc; (void)argv; (void)ctx;
+    printf("=> Acao: Ligando o LED.\n");
+    gpio_put(LED_PIN, 1);
+}
+
+static void cmd_off(int argc, const cmd_token_t *argv, void *ctx) {
+    (void)argc; (void)argv; (void)ctx;
+    printf("=> Acao: Desligando o LED.\n");
+    gpio_put(LED_PIN, 0);
+}
+
+static void cmd_encerrar(int argc, const cmd_token_t *argv, void *ctx) {
+    (void)argc; (void)argv;
+    printf("=> Acao: Encerrando o programa.\n");
+    *(bool *)ctx = false; // Sai do loop while
+}
+
+// Em ordem crescente de nome (maiúsculas antes de minúsculas)
+static const cmd_entry_t commands[] = {
+    { "/OFF", cmd_off },
+    { "/ON", cmd_on },
+    { "/encerrar", cmd_encerrar },
+};
+
+static const cmd_table_t command_table = CMD_TABLE(commands);
+
 
 int main() {
     // Inicializa a E/S padrão (necessário para printf/getchar via USB)
@@ -65,32 +94,26 @@ int main() {
     printf("Aguardando comandos...\n\n");
 
     char command_buffer[CMD_BUFFER_SIZE];
-    
-    // Loop principal infinito
-    while (true) {
+    bool running = cmd_table_check(&command_table);
+    if (!running) {
+        printf("Erro: tabela de comandos fora de ordem\n");
+    }
+
+    // Loop principal
+    while (running) {
         // Chama a função para ler um comando do usuário
-        read_serial_line(command_buffer, sizeof(command_buffer));
+        size_t len = read_serial_line(command_buffer, sizeof(command_buffer));
 
         // Se a linha não estiver vazia, processa o comando
-        if (strlen(command_buffer) > 0) {
+        if (len > 0) {
             printf("Comando recebido: '%s'\n", command_buffer);
 
-            if (strcmp(command_buffer, "/ON") == 0) {
-                printf("=> Acao: Ligando o LED.\n");
-                gpio_put(LED_PIN, 1);
-            } 
-            else if (strcmp(command_buffer, "/OFF") == 0) {
-                printf("=> Acao: Desligando o LED.\n");
-                gpio_put(LED_PIN, 0);
-            } 
-            else if (strcmp(command_buffer, "/encerrar") == 0) {
-                printf("=> Acao: Encerrando o programa.\n");
-                break; // Sai do loop while(true)
-            } 
-            else {
+            if (cmd_dispatch(&command_table, command_buffer, len, &running) == CMD_UNKNOWN) {
                 printf("=> Erro: Comando desconhecido.\n");
             }
-            printf("\nAguardando comandos...\n");
+            if (running) {
+                printf("\nAguardando comandos...\n");
+            }
         }
     }
 